@@ -0,0 +1,42 @@
+#!/bin/sh
+# Compare two builds of swoole.so (e.g. the default epoll reactor and one configured with --enable-io-uring)
+# on the tcp.php and http.php workloads, swoole must not be loaded in php.ini.
+#
+# usage: ./reactor.sh /path/to/epoll/swoole.so /path/to/io_uring/swoole.so
+PHP=${PHP:-php}
+CONCURRENCY=${CONCURRENCY:-100}
+REQUESTS=${REQUESTS:-100000}
+cd "$(dirname "$0")"
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <swoole.so> <swoole.so> ..."
+    exit 1
+fi
+
+run_server()
+{
+    $PHP -d extension="$1" "$2" > /dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 2
+}
+
+stop_server()
+{
+    kill $SERVER_PID
+    wait $SERVER_PID 2> /dev/null
+}
+
+for so in "$@"; do
+    echo "==== $so"
+    $PHP -d extension="$so" --ri swoole | grep -E "^(epoll|io_uring|kqueue) "
+
+    run_server "$so" http.php
+    echo "-- http.php"
+    ab -c $CONCURRENCY -n $REQUESTS -k http://127.0.0.1:9501/ 2>&1 | grep -E "Requests per second|Time per request|Failed requests"
+    stop_server
+
+    run_server "$so" tcp.php
+    echo "-- tcp.php"
+    $PHP -d extension="$so" run.php -c $CONCURRENCY -n $REQUESTS -s tcp://127.0.0.1:9502 -f long_tcp | grep -E "req per second|one req use|lost num"
+    stop_server
+done
@@ -0,0 +1,86 @@
+<?php
+/**
+ * php task_ipc.php [task_num] [worker_num] [task_worker_num]
+ * every worker keeps WINDOW tasks in flight, until task_num tasks are finished
+ */
+define('PORT', 9508);
+define('WINDOW', 256);
+
+$task_num = isset($argv[1]) ? intval($argv[1]) : 200000;
+$worker_num = isset($argv[2]) ? intval($argv[2]) : 4;
+$task_worker_num = isset($argv[3]) ? intval($argv[3]) : 4;
+
+$modes = [
+    SWOOLE_IPC_UNSOCK => 'unixsock',
+    SWOOLE_IPC_MSGQUEUE => 'msgqueue',
+    SWOOLE_IPC_PREEMPTIVE => 'preemptive',
+    SWOOLE_IPC_SHM_QUEUE => 'shm_queue',
+];
+
+foreach ($modes as $mode => $name)
+{
+    $use = bench($mode, $task_num, $worker_num, $task_worker_num);
+    echo str_pad($name, 12) . "$task_num tasks, use: " . round($use * 1000, 2) . "ms, qps: " . round($task_num / $use) . "\n";
+}
+
+function bench($mode, $task_num, $worker_num, $task_worker_num)
+{
+    $finished = new swoole_atomic(0);
+    //microseconds
+    $start = new swoole_atomic_long(0);
+    $end = new swoole_atomic_long(0);
+
+    $serv = new swoole_server('127.0.0.1', PORT, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => $worker_num,
+        'task_worker_num' => $task_worker_num,
+        'task_ipc_mode' => $mode,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on('WorkerStart', function (swoole_server $serv, $worker_id) use ($task_num, $worker_num, $start)
+    {
+        if ($serv->taskworker)
+        {
+            return;
+        }
+        //the tasks of this worker
+        $serv->total = intval($task_num / $worker_num) + ($worker_id < $task_num % $worker_num ? 1 : 0);
+        $serv->sent = 0;
+        $start->cmpset(0, (int) (microtime(true) * 1000000));
+        while ($serv->sent < $serv->total and $serv->sent < WINDOW)
+        {
+            $serv->sent++;
+            $serv->task(str_repeat('A', 64));
+        }
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $reactor_id, $data)
+    {
+
+    });
+    $serv->on('task', function (swoole_server $serv, $task_id, $worker_id, $data)
+    {
+        return $data;
+    });
+    $serv->on('finish', function (swoole_server $serv, $task_id, $data) use ($task_num, $finished, $end)
+    {
+        if ($serv->sent < $serv->total)
+        {
+            $serv->sent++;
+            $serv->task($data);
+        }
+        if ($finished->add(1) == $task_num)
+        {
+            $end->set((int) (microtime(true) * 1000000));
+            $serv->shutdown();
+        }
+    });
+
+    $process = new swoole_process(function () use ($serv)
+    {
+        $serv->start();
+    }, false, false);
+    $process->start();
+    swoole_process::wait();
+
+    return ($end->get() - $start->get()) / 1000000;
+}
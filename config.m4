@@ -30,6 +30,9 @@ PHP_ARG_ENABLE(openssl, enable openssl support,
 PHP_ARG_ENABLE(http2, enable http2.0 support,
 [  --enable-http2            Use http2.0?], no, no)
 
+PHP_ARG_ENABLE(io-uring, enable io_uring reactor support,
+[  --enable-io-uring         Use io_uring reactor? (linux-5.13 or later)], no, no)
+
 PHP_ARG_ENABLE(swoole, swoole support,
 [  --enable-swoole           Enable swoole support], [enable_swoole="yes"])
 
@@ -346,6 +349,14 @@ if test "$PHP_SWOOLE" != "no"; then
         AC_DEFINE(SW_USE_HTTP2, 1, [enable HTTP2 support])
     fi
 
+    if test "$PHP_IO_URING" = "yes"; then
+        AC_CHECK_HEADER(linux/io_uring.h, [
+            AC_DEFINE(SW_USE_IOURING, 1, [enable io_uring reactor support])
+        ], [
+            AC_MSG_ERROR([--enable-io-uring requires linux/io_uring.h])
+        ])
+    fi
+
     if test "$PHP_MYSQLND" = "yes"; then
         PHP_ADD_EXTENSION_DEP(mysqli, mysqlnd)
         AC_DEFINE(SW_USE_MYSQLND, 1, [use mysqlnd])
@@ -391,6 +402,8 @@ if test "$PHP_SWOOLE" != "no"; then
         src/core/log.c \
         src/core/rbtree.c \
         src/core/ring_queue.c \
+        src/core/shm_queue.c \
+        src/core/shm_ring.c \
         src/core/socket.c \
         src/core/string.c \
         src/coroutine/base.cc \
@@ -411,6 +424,7 @@ if test "$PHP_SWOOLE" != "no"; then
         src/memory/fixed_pool.c \
         src/memory/global_memory.c \
         src/memory/malloc.c \
+        src/memory/page_pool.c \
         src/memory/ring_buffer.c \
         src/memory/shared_memory.c \
         src/memory/table.c \
@@ -424,6 +438,7 @@ if test "$PHP_SWOOLE" != "no"; then
         src/network/timer.c \
         src/os/base.c \
         src/os/msg_queue.c \
+        src/os/numa.c \
         src/os/sendfile.c \
         src/os/signal.c \
         src/os/timer.c \
@@ -445,10 +460,12 @@ if test "$PHP_SWOOLE" != "no"; then
         src/reactor/base.c \
         src/reactor/defer_task.cc \
         src/reactor/epoll.c \
+        src/reactor/io_uring.c \
         src/reactor/kqueue.c \
         src/reactor/poll.c \
         src/reactor/select.c \
         src/server/base.c \
+        src/server/handoff.cc \
         src/server/manager.cc \
         src/server/master.cc \
         src/server/port.c \
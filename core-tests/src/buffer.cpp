@@ -0,0 +1,100 @@
+#include "tests.h"
+
+TEST(buffer, shift_push)
+{
+    char data[] = "hello world";
+    swBuffer *buffer = swBuffer_new(0);
+    swBuffer *pending = swBuffer_new(0);
+
+    ASSERT_EQ(swBuffer_append(buffer, data, 5), SW_OK);
+    ASSERT_EQ(swBuffer_append(buffer, data + 5, 6), SW_OK);
+    ASSERT_EQ(buffer->length, 11);
+
+    swBuffer_chunk *chunk = swBuffer_shift_chunk(buffer);
+    ASSERT_EQ(chunk->length, 5);
+    ASSERT_EQ(buffer->length, 6);
+    swBuffer_push_chunk(pending, chunk);
+    ASSERT_EQ(pending->length, 5);
+    ASSERT_EQ(pending->head, chunk);
+
+    swBuffer_free(buffer);
+    swBuffer_free(pending);
+}
+
+TEST(buffer, gather_send)
+{
+    int pairs[2];
+    char buf[1024];
+    swConnection conn;
+
+    ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, pairs), 0);
+    bzero(&conn, sizeof(conn));
+    conn.fd = pairs[0];
+    conn.out_buffer = swBuffer_new(0);
+
+    for (int i = 0; i < 10; i++)
+    {
+        int n = sprintf(buf, "chunk-%d,", i);
+        swBuffer_append(conn.out_buffer, buf, n);
+    }
+    conn.out_buffer->head->offset = 2;
+
+    //the queued chunks are flushed with one call
+    ASSERT_EQ(swConnection_buffer_send(&conn), SW_OK);
+    ASSERT_TRUE(swBuffer_empty(conn.out_buffer));
+
+    ssize_t n = recv(pairs[1], buf, sizeof(buf) - 1, 0);
+    ASSERT_GT(n, 0);
+    buf[n] = 0;
+    ASSERT_STREQ(buf, "unk-0,chunk-1,chunk-2,chunk-3,chunk-4,chunk-5,chunk-6,chunk-7,chunk-8,chunk-9,");
+
+    swBuffer_free(conn.out_buffer);
+    close(pairs[0]);
+    close(pairs[1]);
+}
+
+#ifdef HAVE_ZEROCOPY
+TEST(buffer, zerocopy_chunk)
+{
+    char data[SW_ZEROCOPY_MIN_SIZE];
+    memset(data, 'x', sizeof(data));
+    swBuffer *buffer = swBuffer_new(0);
+
+    ASSERT_EQ(swBuffer_append_zerocopy(buffer, data, sizeof(data)), SW_OK);
+    ASSERT_EQ(buffer->head->type, SW_CHUNK_ZEROCOPY);
+    ASSERT_EQ(memcmp(buffer->head->store.ptr, data, sizeof(data)), 0);
+
+    swBuffer_pop_chunk(buffer, buffer->head);
+    ASSERT_TRUE(swBuffer_empty(buffer));
+    swBuffer_free(buffer);
+}
+#endif
+
+TEST(buffer, slab)
+{
+    char data[SW_BUFFER_SIZE_STD];
+    swBuffer_slab slab;
+    swBuffer_slab_init(&slab);
+    SwooleTG.buffer_slab = &slab;
+
+    swBuffer *buffer = swBuffer_new(0);
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(swBuffer_append(buffer, data, sizeof(data) - 100), SW_OK);
+        ASSERT_EQ(buffer->tail->size, SW_BUFFER_SIZE_STD);
+        swBuffer_pop_chunk(buffer, buffer->head);
+    }
+    //small data is not recycled
+    ASSERT_EQ(swBuffer_append(buffer, data, 100), SW_OK);
+    ASSERT_EQ(buffer->tail->size, 100);
+    swBuffer_free(buffer);
+
+    //4 data blocks and 5 chunk headers, the first of each class is a miss
+    ASSERT_EQ(slab.alloc_count, 9);
+    ASSERT_EQ(slab.hit_count, 7);
+    ASSERT_EQ(slab.retained_bytes, SW_BUFFER_SIZE_STD + sizeof(swBuffer_chunk));
+
+    SwooleTG.buffer_slab = NULL;
+    swBuffer_slab_free(&slab);
+    ASSERT_EQ(slab.retained_bytes, 0);
+}
@@ -0,0 +1,32 @@
+#include "tests.h"
+#include "hash.h"
+
+TEST(hash, jump_hash)
+{
+    int i;
+    int moved = 0;
+    int counter[10] = {0};
+    for (i = 0; i < 100000; i++)
+    {
+        int32_t a = swoole_jump_hash(i, 9);
+        int32_t b = swoole_jump_hash(i, 10);
+        ASSERT_GE(a, 0);
+        ASSERT_LT(a, 9);
+        //a key only moves to the new bucket
+        if (a != b)
+        {
+            ASSERT_EQ(b, 9);
+            moved++;
+        }
+        counter[b]++;
+    }
+    //about 1/10 of the keys move
+    ASSERT_GT(moved, 9000);
+    ASSERT_LT(moved, 11000);
+    for (i = 0; i < 10; i++)
+    {
+        ASSERT_GT(counter[i], 9000);
+        ASSERT_LT(counter[i], 11000);
+    }
+    ASSERT_EQ(swoole_jump_hash(12345, 1), 0);
+}
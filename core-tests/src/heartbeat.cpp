@@ -0,0 +1,71 @@
+#include "tests.h"
+
+static int closed_fd = -1;
+
+static int heartbeat_reactor_set(swReactor *reactor, int fd, int fdtype)
+{
+    closed_fd = fd;
+    return SW_OK;
+}
+
+TEST(heartbeat, idle_wheel_odd_interval)
+{
+    swServer serv;
+    swServerGS gs;
+    swReactorThread thread;
+    swReactor reactor;
+    swConnection connection_list[16];
+
+    bzero(&serv, sizeof(serv));
+    bzero(&gs, sizeof(gs));
+    bzero(&thread, sizeof(thread));
+    bzero(&reactor, sizeof(reactor));
+    bzero(connection_list, sizeof(connection_list));
+
+    //idle_time is not a multiple of the interval, the wheel has 3 slots
+    serv.factory_mode = SW_MODE_PROCESS;
+    serv.heartbeat_check_interval = 3;
+    serv.heartbeat_idle_time = 5;
+    serv.max_connection = 15;
+    serv.connection_list = connection_list;
+    serv.reactor_threads = &thread;
+    serv.gs = &gs;
+    reactor.ptr = &serv;
+    reactor.id = 0;
+    reactor.set = heartbeat_reactor_set;
+
+    gs.now = 3001;
+    ASSERT_EQ(swReactorThread_idle_init(&serv, &thread), SW_OK);
+    ASSERT_EQ(thread.idle_wheel_size, 3);
+
+    swConnection *conn = &connection_list[5];
+    conn->fd = 5;
+    conn->active = 1;
+    conn->fdtype = SW_FD_TCP;
+    conn->session_id = 1;
+    conn->last_time = gs.now;
+    swReactorThread_idle_enroll(&reactor, conn);
+
+    //the connection is active, its new deadline is in the slot being visited
+    gs.now = 3010;
+    conn->last_time = gs.now;
+    swReactorThread_idle_check(&reactor);
+    ASSERT_EQ(closed_fd, -1);
+    ASSERT_EQ(conn->close_force, 0);
+
+    //still in the wheel, it is closed once idle_time has passed
+    gs.now = 3018;
+    swReactorThread_idle_check(&reactor);
+    ASSERT_EQ(closed_fd, 5);
+    ASSERT_EQ(conn->close_force, 1);
+
+    for (uint32_t i = 0; i < thread.idle_wheel_size; i++)
+    {
+        if (thread.idle_wheel[i])
+        {
+            swString_free(thread.idle_wheel[i]);
+        }
+    }
+    sw_free(thread.idle_wheel);
+    swString_free(thread.idle_requeue);
+}
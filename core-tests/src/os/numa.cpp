@@ -0,0 +1,42 @@
+#include "tests.h"
+#ifdef HAVE_NUMA
+TEST(os_numa, parse_cpulist)
+{
+    cpu_set_t set;
+
+    ASSERT_EQ(swoole_parse_cpulist("0-3,8-11\n", &set), 8);
+    ASSERT_TRUE(CPU_ISSET(3, &set));
+    ASSERT_FALSE(CPU_ISSET(4, &set));
+    ASSERT_TRUE(CPU_ISSET(11, &set));
+
+    ASSERT_EQ(swoole_parse_cpulist("5", &set), 1);
+    ASSERT_TRUE(CPU_ISSET(5, &set));
+    //memory-only node
+    ASSERT_EQ(swoole_parse_cpulist("\n", &set), 0);
+
+    ASSERT_EQ(swoole_parse_cpulist("3-1", &set), SW_ERR);
+    ASSERT_EQ(swoole_parse_cpulist("a", &set), SW_ERR);
+}
+
+TEST(os_numa, bind)
+{
+    int nodes[8];
+    cpu_set_t set;
+
+    int n = swoole_numa_get_nodes(nodes, 8);
+    if (n <= 0)
+    {
+        GTEST_SKIP() << "NUMA topology is not available";
+    }
+    ASSERT_GE(swoole_numa_get_cpus(nodes[0], &set), 0);
+
+    size_t size = 1024 * 1024;
+    char *mem = (char *) sw_shm_malloc(size);
+    ASSERT_NE(mem, nullptr);
+    memset(mem, 'A', size);
+    ASSERT_EQ(sw_shm_numa_bind(mem, nodes[0]), SW_OK);
+    ASSERT_EQ(sw_shm_numa_bind(mem, -1), SW_OK);
+    ASSERT_EQ(mem[size - 1], 'A');
+    sw_shm_free(mem);
+}
+#endif
@@ -0,0 +1,86 @@
+#include "tests.h"
+
+#define PAGE_POOL_PAGE_SIZE     4096
+#define PAGE_POOL_PAGE_NUM      16
+
+TEST(page_pool, alloc_free)
+{
+    swMemoryPool *pool = swPagePool_new(PAGE_POOL_PAGE_NUM * PAGE_POOL_PAGE_SIZE, PAGE_POOL_PAGE_SIZE, 1);
+    ASSERT_NE(pool, nullptr);
+    swPagePool *object = (swPagePool *) pool->object;
+    ASSERT_EQ(object->page_num, PAGE_POOL_PAGE_NUM);
+
+    //a header is stored before the data, so it takes 2 pages
+    void *a = pool->alloc(pool, PAGE_POOL_PAGE_SIZE);
+    ASSERT_NE(a, nullptr);
+    memset(a, 'a', PAGE_POOL_PAGE_SIZE);
+    ASSERT_EQ(object->page_use, 2);
+
+    void *b = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 10);
+    ASSERT_NE(b, nullptr);
+    memset(b, 'b', PAGE_POOL_PAGE_SIZE * 10);
+    ASSERT_EQ(object->page_use, 13);
+
+    //not enough contiguous pages
+    ASSERT_EQ(pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 4), nullptr);
+    ASSERT_EQ(pool->alloc(pool, PAGE_POOL_PAGE_SIZE * PAGE_POOL_PAGE_NUM), nullptr);
+
+    //next fit takes the tail first
+    void *c = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 2);
+    ASSERT_NE(c, nullptr);
+    ASSERT_EQ(((char *) c - object->memory) / PAGE_POOL_PAGE_SIZE, 13);
+    ASSERT_EQ(pool->alloc(pool, 1), nullptr);
+
+    //out of order free, the pages of a are reused
+    pool->free(pool, a);
+    ASSERT_EQ(object->page_use, 14);
+    void *d = pool->alloc(pool, PAGE_POOL_PAGE_SIZE);
+    ASSERT_NE(d, nullptr);
+    ASSERT_EQ(d, a);
+    ASSERT_EQ(object->page_use, 16);
+
+    pool->free(pool, b);
+    pool->free(pool, c);
+    pool->free(pool, d);
+    ASSERT_EQ(object->page_use, 0);
+    ASSERT_NE(pool->alloc(pool, PAGE_POOL_PAGE_SIZE * (PAGE_POOL_PAGE_NUM - 1)), nullptr);
+
+    pool->destroy(pool);
+}
+
+TEST(page_pool, reclaim)
+{
+    swMemoryPool *pool = swPagePool_new(PAGE_POOL_PAGE_NUM * PAGE_POOL_PAGE_SIZE, PAGE_POOL_PAGE_SIZE, 1);
+    ASSERT_NE(pool, nullptr);
+    swPagePool *object = (swPagePool *) pool->object;
+
+    void *a = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 3);
+    void *b = pool->alloc(pool, PAGE_POOL_PAGE_SIZE);
+    void *c = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 2);
+    ASSERT_NE(a, nullptr);
+    ASSERT_NE(b, nullptr);
+    ASSERT_NE(c, nullptr);
+    ASSERT_EQ(object->page_use, 9);
+
+    //b is in flight, c is taken by another process
+    swPagePool_set_owner(pool, b, 0);
+    swPagePool_set_owner(pool, c, SwooleG.pid + 1);
+    ASSERT_EQ(swPagePool_reclaim(pool, SwooleG.pid + 1), 3);
+    ASSERT_EQ(object->page_use, 6);
+    ASSERT_EQ(swPagePool_reclaim(pool, SwooleG.pid), 4);
+    ASSERT_EQ(object->page_use, 2);
+
+    //next fit goes on after c, then wraps around to the pages of a
+    void *d = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 4);
+    ASSERT_NE(d, nullptr);
+    ASSERT_EQ(((char *) d - object->memory) / PAGE_POOL_PAGE_SIZE, 9);
+    void *e = pool->alloc(pool, PAGE_POOL_PAGE_SIZE * 3);
+    ASSERT_EQ(e, a);
+
+    pool->free(pool, b);
+    pool->free(pool, d);
+    pool->free(pool, e);
+    ASSERT_EQ(object->page_use, 0);
+
+    pool->destroy(pool);
+}
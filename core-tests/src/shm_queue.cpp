@@ -0,0 +1,162 @@
+#include "tests.h"
+
+#include <thread>
+
+#define SHM_QUEUE_THREAD_N    4
+#define SHM_QUEUE_WRITE_N     100000
+
+TEST(shm_queue, push_pop)
+{
+    swShmQueue *q = swShmQueue_new(4, sizeof(uint64_t) * 2);
+    ASSERT_NE(q, nullptr);
+    ASSERT_EQ(q->size, 4);
+
+    uint64_t buf[2];
+    uint64_t i;
+    for (i = 0; i < 4; i++)
+    {
+        buf[0] = i;
+        ASSERT_EQ(swShmQueue_push(q, buf, sizeof(uint64_t), 0), sizeof(uint64_t));
+    }
+    //full
+    ASSERT_EQ(swShmQueue_push(q, buf, sizeof(uint64_t), 0), SW_ERR);
+    ASSERT_EQ(errno, EAGAIN);
+    //too large
+    ASSERT_EQ(swShmQueue_push(q, buf, sizeof(buf) + 1, 0), SW_ERR);
+    ASSERT_EQ(swShmQueue_count(q), 4);
+    //full, but not stuck
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+
+    for (i = 0; i < 4; i++)
+    {
+        ASSERT_EQ(swShmQueue_pop(q, buf, sizeof(buf), 0), sizeof(uint64_t));
+        ASSERT_EQ(buf[0], i);
+    }
+    //empty
+    ASSERT_EQ(swShmQueue_pop(q, buf, sizeof(buf), 0), SW_ERR);
+    ASSERT_EQ(errno, EAGAIN);
+
+    swShmQueue_free(q);
+}
+
+TEST(shm_queue, thread)
+{
+    swShmQueue *q = swShmQueue_new(64, sizeof(uint64_t));
+    ASSERT_NE(q, nullptr);
+
+    sw_atomic_long_t sum = 0;
+    std::thread *consumers[SHM_QUEUE_THREAD_N];
+    std::thread *producers[SHM_QUEUE_THREAD_N];
+    int i;
+
+    //the consumers sleep on the futex when the queue is empty
+    for (i = 0; i < SHM_QUEUE_THREAD_N; i++)
+    {
+        consumers[i] = new std::thread([q, &sum]()
+        {
+            uint64_t value;
+            while (1)
+            {
+                ASSERT_EQ(swShmQueue_pop(q, &value, sizeof(value), 1), sizeof(value));
+                if (value == 0)
+                {
+                    break;
+                }
+                sw_atomic_fetch_add(&sum, value);
+            }
+        });
+    }
+
+    for (i = 0; i < SHM_QUEUE_THREAD_N; i++)
+    {
+        producers[i] = new std::thread([q]()
+        {
+            uint64_t value;
+            for (value = 1; value <= SHM_QUEUE_WRITE_N; value++)
+            {
+                ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 1), sizeof(value));
+            }
+        });
+    }
+
+    for (i = 0; i < SHM_QUEUE_THREAD_N; i++)
+    {
+        producers[i]->join();
+        delete producers[i];
+    }
+    uint64_t end = 0;
+    for (i = 0; i < SHM_QUEUE_THREAD_N; i++)
+    {
+        ASSERT_EQ(swShmQueue_push(q, &end, sizeof(end), 1), sizeof(end));
+    }
+    for (i = 0; i < SHM_QUEUE_THREAD_N; i++)
+    {
+        consumers[i]->join();
+        delete consumers[i];
+    }
+
+    ASSERT_EQ(sum, (long) SHM_QUEUE_THREAD_N * SHM_QUEUE_WRITE_N * (SHM_QUEUE_WRITE_N + 1) / 2);
+    ASSERT_EQ(swShmQueue_count(q), 0);
+    swShmQueue_free(q);
+}
+
+TEST(shm_queue, repair)
+{
+    swShmQueue *q = swShmQueue_new(4, sizeof(uint64_t));
+    ASSERT_NE(q, nullptr);
+
+    uint64_t value;
+    int status;
+    int i;
+
+    //the producer is killed by SIGSEGV after taking the slot, the consumers stall at it
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        SwooleG.pid = getpid();
+        swShmQueue_push(q, nullptr, sizeof(value), 0);
+        exit(0);
+    }
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    value = 1;
+    ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 0), sizeof(value));
+    ASSERT_EQ(swShmQueue_pop(q, &value, sizeof(value), 0), SW_ERR);
+    //reported once, at the second check
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+    ASSERT_EQ(swShmQueue_stalled(q), 1);
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+
+    //the data of the producer is discarded
+    ASSERT_EQ(swShmQueue_repair(q, pid), 1);
+    ASSERT_EQ(swShmQueue_pop(q, &value, sizeof(value), 0), sizeof(value));
+    ASSERT_EQ(value, 1);
+
+    //the consumer is killed after taking the slot, the producers stall at it once the ring wraps
+    value = 2;
+    ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 0), sizeof(value));
+    pid = fork();
+    if (pid == 0)
+    {
+        SwooleG.pid = getpid();
+        swShmQueue_pop(q, nullptr, sizeof(value), 0);
+        exit(0);
+    }
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    for (i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 0), sizeof(value));
+    }
+    ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 0), SW_ERR);
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+    ASSERT_EQ(swShmQueue_stalled(q), 1);
+
+    ASSERT_EQ(swShmQueue_repair(q, pid), 1);
+    ASSERT_EQ(swShmQueue_push(q, &value, sizeof(value), 0), sizeof(value));
+    ASSERT_EQ(swShmQueue_count(q), 4);
+    ASSERT_EQ(swShmQueue_stalled(q), 0);
+
+    swShmQueue_free(q);
+}
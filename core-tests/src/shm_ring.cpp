@@ -0,0 +1,86 @@
+#include "tests.h"
+
+#include <thread>
+
+#define SHM_RING_WRITE_N    100000
+
+TEST(shm_ring, wrap)
+{
+    swShmRing *ring = swShmRing_new(SW_IPC_RING_MIN_SIZE);
+    ASSERT_NE(ring, nullptr);
+    ASSERT_EQ(ring->size, SW_IPC_RING_MIN_SIZE);
+
+    char buf[20000];
+    uint32_t length;
+    int i;
+
+    for (i = 0; i < 10; i++)
+    {
+        memset(buf, 'a' + i, sizeof(buf));
+        void *ptr = swShmRing_alloc(ring, sizeof(buf));
+        ASSERT_NE(ptr, nullptr);
+        memcpy(ptr, buf, sizeof(buf));
+        swShmRing_commit(ring);
+
+        //full
+        if (i % 3 == 2)
+        {
+            ASSERT_EQ(swShmRing_alloc(ring, ring->size), nullptr);
+        }
+
+        char *data = (char *) swShmRing_peek(ring, &length);
+        ASSERT_NE(data, nullptr);
+        ASSERT_EQ(length, sizeof(buf));
+        ASSERT_EQ(memcmp(data, buf, length), 0);
+        swShmRing_release(ring);
+        ASSERT_TRUE(swShmRing_empty(ring));
+        ASSERT_EQ(swShmRing_peek(ring, &length), nullptr);
+    }
+
+    swShmRing_free(ring);
+}
+
+TEST(shm_ring, thread)
+{
+    swShmRing *ring = swShmRing_new(SW_IPC_RING_MIN_SIZE);
+    ASSERT_NE(ring, nullptr);
+
+    std::thread consumer([ring]()
+    {
+        uint32_t i = 0, length;
+        while (i < SHM_RING_WRITE_N)
+        {
+            uint32_t *data = (uint32_t *) swShmRing_peek(ring, &length);
+            if (data == nullptr)
+            {
+                sw_atomic_cpu_pause();
+                continue;
+            }
+            ASSERT_EQ(length, sizeof(uint32_t) * (1 + i % 64));
+            ASSERT_EQ(data[0], i);
+            ASSERT_EQ(data[length / sizeof(uint32_t) - 1], i);
+            swShmRing_release(ring);
+            i++;
+        }
+    });
+
+    uint32_t i = 0;
+    while (i < SHM_RING_WRITE_N)
+    {
+        uint32_t length = sizeof(uint32_t) * (1 + i % 64);
+        uint32_t *data = (uint32_t *) swShmRing_alloc(ring, length);
+        if (data == nullptr)
+        {
+            sw_atomic_cpu_pause();
+            continue;
+        }
+        data[0] = i;
+        data[length / sizeof(uint32_t) - 1] = i;
+        swShmRing_commit(ring);
+        i++;
+    }
+
+    consumer.join();
+    ASSERT_TRUE(swShmRing_empty(ring));
+    swShmRing_free(ring);
+}
@@ -0,0 +1,147 @@
+#include "tests.h"
+
+#ifdef SW_USE_OPENSSL
+
+#include <sys/wait.h>
+
+#define SSL_TEST_CERT_DIR "../tests/include/api/ssl-ca/"
+
+static SSL_CTX* ssl_session_server_context(swSSL_config *cfg)
+{
+    swSSL_option option;
+    bzero(&option, sizeof(option));
+    option.cert_file = (char *) SSL_TEST_CERT_DIR "server-cert.pem";
+    option.key_file = (char *) SSL_TEST_CERT_DIR "server-key.pem";
+
+    SSL_CTX *ctx = swSSL_get_context(&option);
+    if (ctx && swSSL_server_set_session_cache(ctx, cfg) < 0)
+    {
+        swSSL_free_context(ctx);
+        return NULL;
+    }
+    return ctx;
+}
+
+/**
+ * a worker process forked after the context is created, it serves one connection and exits
+ */
+static pid_t ssl_session_worker(SSL_CTX *ctx, int sock)
+{
+    pid_t pid = fork();
+    if (pid != 0)
+    {
+        return pid;
+    }
+    int fd = accept(sock, NULL, NULL);
+    SSL *ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, fd);
+    int ret = SSL_accept(ssl) == 1 && SSL_write(ssl, "x", 1) == 1;
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(fd);
+    _exit(ret ? 0 : 1);
+}
+
+/**
+ * connect with the session of the previous connection, return whether it was resumed
+ */
+static int ssl_session_connect(SSL_CTX *client_ctx, int port, SSL_SESSION **session)
+{
+    int fd = swSocket_create(SW_SOCK_TCP);
+    struct sockaddr_in addr;
+    bzero(&addr, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    if (connect(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    SSL *ssl = SSL_new(client_ctx);
+    SSL_set_fd(ssl, fd);
+    if (*session)
+    {
+        SSL_set_session(ssl, *session);
+    }
+    int reused = -1;
+    char buf[8];
+    //the ticket of TLS 1.3 is sent after the handshake, it is read with the data
+    if (SSL_connect(ssl) == 1 && SSL_read(ssl, buf, sizeof(buf)) == 1)
+    {
+        while (SSL_read(ssl, buf, sizeof(buf)) > 0);
+        reused = SSL_session_reused(ssl);
+        if (*session)
+        {
+            SSL_SESSION_free(*session);
+        }
+        *session = SSL_get1_session(ssl);
+    }
+    SSL_shutdown(ssl);
+    SSL_free(ssl);
+    close(fd);
+    return reused;
+}
+
+static void ssl_session_resume(swSSL_config *cfg, SSL_CTX *client_ctx)
+{
+    SSL_CTX *ctx = ssl_session_server_context(cfg);
+    ASSERT_NE(ctx, nullptr);
+
+    int sock = swSocket_create(SW_SOCK_TCP);
+    ASSERT_GT(sock, 0);
+    int port = 0;
+    ASSERT_EQ(swSocket_bind(sock, SW_SOCK_TCP, (char *) "127.0.0.1", &port), SW_OK);
+    ASSERT_EQ(listen(sock, 8), 0);
+
+    SSL_SESSION *session = NULL;
+    int status;
+    int i;
+    for (i = 0; i < 3; i++)
+    {
+        //each connection is served by a new process, the session comes from the previous one
+        pid_t pid = ssl_session_worker(ctx, sock);
+        ASSERT_GT(pid, 0);
+        int reused = ssl_session_connect(client_ctx, port, &session);
+        ASSERT_EQ(waitpid(pid, &status, 0), pid);
+        ASSERT_EQ(WEXITSTATUS(status), 0);
+        ASSERT_EQ(reused, i == 0 ? 0 : 1);
+    }
+
+    SSL_SESSION_free(session);
+    close(sock);
+    swSSL_free_context(ctx);
+}
+
+TEST(ssl_session, resume_session_id)
+{
+    swSSL_config cfg;
+    bzero(&cfg, sizeof(cfg));
+    cfg.session_cache_size = 64;
+    cfg.session_timeout = 60;
+
+    //the session id is only looked up by the server with TLS 1.2
+    SSL_CTX *client_ctx = SSL_CTX_new(SSLv23_client_method());
+    SSL_CTX_set_options(client_ctx, SSL_OP_NO_TICKET | SSL_OP_NO_TLSv1_3);
+    ssl_session_resume(&cfg, client_ctx);
+    SSL_CTX_free(client_ctx);
+}
+
+TEST(ssl_session, resume_ticket)
+{
+    swSSL_config cfg;
+    bzero(&cfg, sizeof(cfg));
+    cfg.session_tickets = 1;
+    cfg.session_timeout = 60;
+    cfg.ticket_key_rotate = 3600;
+
+    //without the shared cache, only the ticket can be resumed by another process
+    SSL_CTX *client_ctx = SSL_CTX_new(SSLv23_client_method());
+    ssl_session_resume(&cfg, client_ctx);
+    SSL_CTX_set_options(client_ctx, SSL_OP_NO_TLSv1_3);
+    ssl_session_resume(&cfg, client_ctx);
+    SSL_CTX_free(client_ctx);
+}
+
+#endif
@@ -57,6 +57,8 @@ typedef sw_atomic_uint32_t                sw_atomic_t;
 #define sw_atomic_memory_barrier()        __sync_synchronize()
 #define sw_atomic_add_fetch(value, add)   __sync_add_and_fetch(value, add)
 #define sw_atomic_sub_fetch(value, sub)   __sync_sub_and_fetch(value, sub)
+//no ordering, for the counters read by other threads where a stale value is fine
+#define sw_atomic_load_relaxed(ptr)       __atomic_load_n(ptr, __ATOMIC_RELAXED)
 
 #ifdef __arm__
 #define sw_atomic_cpu_pause()             __asm__ __volatile__ ("NOP");
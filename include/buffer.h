@@ -27,6 +27,10 @@ enum swBufferChunk
     SW_CHUNK_DATA,
     SW_CHUNK_SENDFILE,
     SW_CHUNK_CLOSE,
+    /**
+     * data chunk in its own anonymous mapping, sent with MSG_ZEROCOPY
+     */
+    SW_CHUNK_ZEROCOPY,
 };
 
 typedef struct _swBuffer_chunk
@@ -34,6 +38,10 @@ typedef struct _swBuffer_chunk
     uint32_t type;
     uint32_t length;
     uint32_t offset;
+    /**
+     * [zerocopy] id of the last send which referenced the chunk
+     */
+    uint32_t seq;
     union
     {
         void *ptr;
@@ -58,13 +66,51 @@ typedef struct _swBuffer
     swBuffer_chunk *tail;
 } swBuffer;
 
+enum swBufferSlabClass
+{
+    SW_BUFFER_SLAB_CHUNK,
+    SW_BUFFER_SLAB_STD,
+    SW_BUFFER_SLAB_BIG,
+    SW_BUFFER_SLAB_CLASS_NUM,
+};
+
+/**
+ * recycled chunk headers and data blocks of one thread, a block in the free list is a normal sw_malloc block,
+ * so the chunks can still be freed by the other threads.
+ */
+typedef struct _swBuffer_slab
+{
+    struct
+    {
+        void *free_list;
+        uint32_t free_num;
+        uint32_t max_free_num;
+        uint32_t size;
+    } classes[SW_BUFFER_SLAB_CLASS_NUM];
+    /**
+     * the counters are written by the owner thread only
+     */
+    uint64_t alloc_count;
+    uint64_t hit_count;
+    size_t retained_bytes;
+} swBuffer_slab;
+
 #define swBuffer_get_chunk(buffer)   (buffer->head)
 #define swBuffer_empty(buffer)       (buffer == NULL || buffer->head == NULL)
 
 swBuffer* swBuffer_new(int chunk_size);
 swBuffer_chunk *swBuffer_new_chunk(swBuffer *buffer, uint32_t type, uint32_t size);
 void swBuffer_pop_chunk(swBuffer *buffer, swBuffer_chunk *chunk);
+swBuffer_chunk *swBuffer_shift_chunk(swBuffer *buffer);
+void swBuffer_push_chunk(swBuffer *buffer, swBuffer_chunk *chunk);
+void swBuffer_free_chunk(swBuffer_chunk *chunk);
 int swBuffer_append(swBuffer *buffer, void *data, uint32_t size);
+#ifdef HAVE_ZEROCOPY
+int swBuffer_append_zerocopy(swBuffer *buffer, void *data, uint32_t size);
+#endif
+
+void swBuffer_slab_init(swBuffer_slab *slab);
+void swBuffer_slab_free(swBuffer_slab *slab);
 
 void swBuffer_debug(swBuffer *buffer, int print_data);
 int swBuffer_free(swBuffer *buffer);
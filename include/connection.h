@@ -34,6 +34,13 @@ extern "C" {
 #define SW_SSL_BUFFER      1
 #define SW_SSL_CLIENT      2
 
+/**
+ * OpenSSL 3.0 installs the negotiated keys into the kernel (TCP_ULP "tls") with SSL_OP_ENABLE_KTLS
+ */
+#if defined(__linux__) && defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+#define SW_SSL_HAVE_KTLS
+#endif
+
 typedef struct _swSSL_option
 {
     char *cert_file;
@@ -50,11 +57,15 @@ typedef struct _swSSL_option
     uint8_t disable_compress :1;
     uint8_t verify_peer :1;
     uint8_t allow_self_signed :1;
+    uint8_t ktls :1;
 } swSSL_option;
 
 #endif
 
 int swConnection_buffer_send(swConnection *conn);
+#ifdef HAVE_ZEROCOPY
+int swConnection_zerocopy_complete(swConnection *conn);
+#endif
 
 swString* swConnection_get_string_buffer(swConnection *conn);
 void swConnection_clear_string_buffer(swConnection *conn);
@@ -112,12 +123,23 @@ typedef struct
     char *ecdh_curve;
     char *session_cache;
     char *dhparam;
+    /**
+     * sessions in the cache shared by all workers and reactor threads, 0 to keep the cache of OpenSSL
+     */
+    uint32_t session_cache_size;
+    uint32_t session_timeout;
+    /**
+     * [session_tickets] the shared ticket keys are replaced every ticket_key_rotate seconds
+     */
+    uint32_t ticket_key_rotate;
 } swSSL_config;
 
 void swSSL_init(void);
 void swSSL_init_thread_safety();
 int swSSL_server_set_cipher(SSL_CTX* ssl_context, swSSL_config *cfg);
+int swSSL_server_set_session_cache(SSL_CTX* ssl_context, swSSL_config *cfg);
 void swSSL_server_http_advise(SSL_CTX* ssl_context, swSSL_config *cfg);
+void swSSL_server_defer_full_handshake(SSL_CTX* ssl_context);
 SSL_CTX* swSSL_get_context(swSSL_option *option);
 void swSSL_free_context(SSL_CTX* ssl_context);
 int swSSL_create(swConnection *conn, SSL_CTX* ssl_context, int flags);
@@ -132,8 +154,16 @@ void swSSL_close(swConnection *conn);
 ssize_t swSSL_recv(swConnection *conn, void *__buf, size_t __n);
 ssize_t swSSL_send(swConnection *conn, void *__buf, size_t __n);
 int swSSL_sendfile(swConnection *conn, int fd, off_t *offset, size_t size);
+#define swConnection_ssl_handshaking(conn)     ((conn)->ssl_handshaking)
+#else
+#define swConnection_ssl_handshaking(conn)     0
 #endif
 
+/**
+ * reading is paused by pause() or by the ipc watermark, EPOLLIN is armed again only when neither is set
+ */
+#define swConnection_recv_paused(conn)         ((conn)->pause_recv || (conn)->ipc_wait)
+
 /**
  * Receive data from connection
  */
@@ -211,6 +211,21 @@ static inline uint64_t swoole_hash_php(char *key, uint32_t len)
     return hash;
 }
 
+/**
+ * jump consistent hash, only 1/n of the keys move when the number of buckets changes to n
+ */
+static inline int32_t swoole_jump_hash(uint64_t key, int32_t num_buckets)
+{
+    int64_t b = -1, j = 0;
+    while (j < num_buckets)
+    {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (b + 1) * ((double) (1LL << 31) / (double) ((key >> 33) + 1));
+    }
+    return (int32_t) b;
+}
+
 #define CRC_STRING_MAXLEN      256
 
 uint32_t swoole_crc32(char *data, uint32_t size);
@@ -20,6 +20,7 @@
 #include "swoole.h"
 #include "buffer.h"
 #include "connection.h"
+#include "hash.h"
 
 #if defined(__sun) && !defined(s6_addr32)
 #define s6_addr32                  _S6_un._S6_u32
@@ -72,6 +73,7 @@ enum swIPCType
     SW_IPC_UNIXSOCK = 1,
     SW_IPC_MSGQUEUE = 2,
     SW_IPC_SOCKET   = 3,
+    SW_IPC_SHM_QUEUE = 4,
 };
 
 enum swTaskIPCMode
@@ -80,6 +82,7 @@ enum swTaskIPCMode
     SW_TASK_IPC_MSGQUEUE    = 2,
     SW_TASK_IPC_PREEMPTIVE  = 3,
     SW_TASK_IPC_STREAM      = 4,
+    SW_TASK_IPC_SHM_QUEUE   = 5,
 };
 
 enum swResponseType
@@ -88,6 +91,9 @@ enum swResponseType
     SW_RESPONSE_SHM = 1,
     SW_RESPONSE_TMPFILE,
     SW_RESPONSE_EXIT,
+    SW_RESPONSE_RING_RESUME,
+    SW_RESPONSE_RING_NOTIFY,
+    SW_RESPONSE_SSL_HANDSHAKE,
 };
 
 enum swWorkerPipeType
@@ -117,8 +123,97 @@ typedef struct _swReactorThread
     pthread_t thread_id;
     swReactor reactor;
     int notify_pipe;
+    /**
+     * requests waiting for space in the shared memory ring of each worker
+     */
+    swBuffer **ipc_ring_buffers;
+    /**
+     * events coalesced in the current loop iteration for each worker
+     */
+    swString **pipe_batch;
+    /**
+     * connections owned by this thread
+     */
+    sw_atomic_t connection_num;
+    /**
+     * read events handled by this thread, event_rate is the recent number per second
+     */
+    sw_atomic_long_t event_count;
+    sw_atomic_long_t last_event_count;
+    uint32_t event_rate;
+    /**
+     * [heartbeat] timing wheel of the connections, one slot for each heartbeat_check_interval,
+     * a connection is only visited in the slot of its deadline
+     */
+    swString **idle_wheel;
+    uint32_t idle_wheel_size;
+    time_t idle_wheel_tick;
+    /**
+     * the live connections of the slot being visited, added back once the slot is emptied
+     */
+    swString *idle_requeue;
+    /**
+     * recycled chunks of the connection and pipe buffers
+     */
+    swBuffer_slab buffer_slab;
+    /**
+     * [ipc_high_watermark] connections paused for each worker, the number of paused workers and since when
+     */
+    swString **ipc_paused;
+    int64_t *ipc_paused_since;
+    uint32_t ipc_paused_num;
+    uint64_t ipc_pause_count;
+    uint64_t ipc_pause_time;
 } swReactorThread;
 
+#ifdef SW_USE_OPENSSL
+/**
+ * [ssl_handshake_threads] the connections are moved from their reactor thread for the TLS handshake,
+ * and handed back with SW_RESPONSE_SSL_HANDSHAKE through the notify_pipe of the reactor thread
+ */
+typedef struct _swSSLHandshakeThread
+{
+    pthread_t thread_id;
+    swReactor reactor;
+    swPipe pipe;
+    sw_atomic_long_t handshake_count;
+    /**
+     * [heartbeat] the connections handed over, a handshake not finished within heartbeat_idle_time is aborted
+     */
+    swString *pending;
+    time_t pending_check_time;
+    /**
+     * set at shutdown, the reactor threads stop handing over the connections
+     */
+    uint8_t exited;
+} swSSLHandshakeThread;
+#endif
+
+#ifdef HAVE_RECVMMSG
+typedef struct _swDgramBatch
+{
+    struct mmsghdr msgs[SW_UDP_BATCH_NUM];
+    struct iovec iov[SW_UDP_BATCH_NUM];
+    char control[SW_UDP_BATCH_NUM][CMSG_SPACE(sizeof(int))];
+    swDgramPacket *packets[SW_UDP_BATCH_NUM];
+} swDgramBatch;
+
+typedef struct _swDgramQueue
+{
+    struct
+    {
+        int fd;
+        uint32_t offset;
+        uint32_t length;
+        swSocketAddress addr;
+    } list[SW_UDP_BATCH_NUM];
+    int num;
+    uint8_t flush_deferred;
+    uint8_t gso_disabled;
+    swString *data;
+} swDgramQueue;
+#endif
+
 typedef struct _swListenPort
 {
     struct _swListenPort *next, *prev;
@@ -150,6 +245,15 @@ typedef struct _swListenPort
     uint8_t ssl;
     int port;
     int sock;
+    /**
+     * [SO_REUSEPORT] listening socket of each reactor thread, ls->sock is the first one
+     */
+    int *thread_socks;
+    /**
+     * [handoff_socket] taken over from the previous master, or handed over to the next one
+     */
+    uint8_t handoff_received;
+    uint8_t handoff_sent;
     pthread_t thread_id;
     char host[SW_HOST_MAXSIZE];
 
@@ -193,6 +297,14 @@ typedef struct _swListenPort
      * open tcp nopush option(for sendfile)
      */
     uint32_t open_tcp_nopush :1;
+    /**
+     * send the big output buffer chunks with MSG_ZEROCOPY
+     */
+    uint32_t open_tcp_zerocopy :1;
+    /**
+     * [UDP_GRO] receive the datagrams of a flow coalesced, they are split again before dispatch
+     */
+    uint32_t open_udp_gro :1;
     /**
      * open tcp keepalive
      */
@@ -244,10 +356,24 @@ typedef struct
     uint16_t num;
 } swUserWorker;
 
+enum swWorkerMessage_type
+{
+    SW_WORKER_MESSAGE_STOP,
+    /**
+     * [standby_worker_num] sent by a standby worker when onWorkerStart has returned
+     */
+    SW_WORKER_MESSAGE_STANDBY_READY,
+    /**
+     * [reload_batch_num] sent by a worker when it has served its first request
+     */
+    SW_WORKER_MESSAGE_READY,
+};
+
 typedef struct
 {
     pid_t pid;
     uint16_t worker_id;
+    uint8_t type;
 } swWorkerStopMessage;
 
 //-----------------------------------Factory--------------------------------------------
@@ -316,6 +442,10 @@ enum swServer_hook_type
     SW_SERVER_HOOK_MANAGER_START,
     SW_SERVER_HOOK_MANAGER_TIMER,
     SW_SERVER_HOOK_PROCESS_TIMER,
+    /**
+     * [standby_worker_num] a standby worker has taken over its slot
+     */
+    SW_SERVER_HOOK_WORKER_ACTIVATE,
 };
 
 typedef struct
@@ -326,6 +456,19 @@ typedef struct
     sw_atomic_long_t accept_count;
     sw_atomic_long_t close_count;
     sw_atomic_long_t request_count;
+    /**
+     * [standby_worker_num] the standby workers that have run onWorkerStart,
+     * and the workers replaced by a standby worker
+     */
+    sw_atomic_t standby_worker_num;
+    sw_atomic_long_t standby_activate_count;
+    /**
+     * progress of the running reload, and the finished reloads
+     */
+    sw_atomic_t reloading;
+    sw_atomic_t reload_worker_num;
+    sw_atomic_t reload_ready_num;
+    sw_atomic_long_t reload_count;
 } swServerStats;
 
 typedef struct
@@ -333,13 +476,18 @@ typedef struct
     pid_t master_pid;
     pid_t manager_pid;
 
-    uint32_t session_round :24;
+    uint32_t session_round;
     sw_atomic_t start;  //after swServer_start will set start=1
 
     time_t now;
 
     sw_atomic_t spinlock;
 
+    /**
+     * [SW_DISPATCH_IPHASH/SW_DISPATCH_UIDHASH] number of workers the keys are hashed to
+     */
+    sw_atomic_t dispatch_hash_num;
+
     swProcessPool task_workers;
     swProcessPool event_workers;
 
@@ -368,6 +516,16 @@ struct _swServer
      * package dispatch mode
      */
     uint8_t dispatch_mode;
+    /**
+     * assign accepted connections to reactor threads
+     */
+    uint8_t reactor_dispatch_mode;
+
+    /**
+     * consistent hash dispatch starts with this number of workers,
+     * one more worker is added for each event worker restarted by reload
+     */
+    uint16_t dispatch_hash_num;
 
     /**
      * No idle work process is available.
@@ -392,6 +550,49 @@ struct _swServer
 
     uint32_t max_wait_time;
 
+    /**
+     * pre-forked workers that take over the slot of an exiting worker
+     */
+    uint16_t standby_worker_num;
+
+    /**
+     * rolling reload, at most reload_batch_num workers (or reload_batch_ratio of them) are restarted
+     * at a time, the next ones are stopped when the replacements have served their first request,
+     * or after reload_ready_timeout seconds (0 waits for the request)
+     */
+    uint16_t reload_batch_num;
+    float reload_batch_ratio;
+    double reload_ready_timeout;
+
+    /**
+     * the listening sockets are handed over to the next master through this unix socket,
+     * the next master connects to the path in the SWOOLE_HANDOFF_SOCKET environment variable
+     */
+    char *handoff_socket;
+    int handoff_sock;
+    /**
+     * the connection to the previous or to the next master, -1 if there is none
+     */
+    int handoff_conn;
+    /**
+     * [next master] receiving the sockets of the previous master has failed, the ports bind by themselves
+     */
+    uint8_t handoff_failed;
+    /**
+     * [previous master] the listening sockets and the pid_file belong to the next master
+     */
+    uint8_t handoff_sent;
+    /**
+     * [next master] the sockets received from the previous master, -1 once taken by a port
+     */
+    int *handoff_fds;
+    uint16_t handoff_fd_num;
+    /**
+     * [previous master] waiting for the connections to close
+     */
+    uint8_t handoff_draining;
+    time_t handoff_drain_time;
+
     /*----------------------------Reactor schedule--------------------------------*/
     uint16_t reactor_round_i;
     uint16_t reactor_next_i;
@@ -415,6 +616,22 @@ struct _swServer
      * open cpu affinity setting
      */
     uint32_t open_cpu_affinity :1;
+    /**
+     * [SO_REUSEPORT] steer the new connection to the reactor thread of the CPU that received it
+     */
+    uint32_t reuse_port_cbpf :1;
+    /**
+     * place each reactor thread with its workers and their shared memory on one NUMA node
+     */
+    uint32_t open_numa_affinity :1;
+    /**
+     * the datagrams sent by a worker in one loop iteration are flushed with sendmmsg()
+     */
+    uint32_t udp_send_batch :1;
+    /**
+     * [udp_send_batch] the datagrams of the same size to the same address are sent with UDP_SEGMENT
+     */
+    uint32_t udp_gso :1;
     /**
      * disable notice when use SW_DISPATCH_ROUND and SW_DISPATCH_QUEUE
      */
@@ -476,6 +693,15 @@ struct _swServer
     int *cpu_affinity_available;
     int cpu_affinity_available_num;
 
+#ifdef HAVE_NUMA
+    /**
+     * [open_numa_affinity] the nodes with CPUs, reactor thread i and worker i are placed on node i % numa_node_num
+     */
+    int numa_node_num;
+    int *numa_nodes;
+    cpu_set_t *numa_cpus;
+#endif
+
     double send_timeout;
 
     uint16_t listen_port_num;
@@ -486,6 +712,32 @@ struct _swServer
     uint32_t buffer_output_size;
     uint32_t buffer_input_size;
 
+    /**
+     * shared memory rings from reactor threads to workers, [reactor_id * worker_num + worker_id]
+     */
+    uint32_t ipc_ring_size;
+    swShmRing **ipc_rings;
+    /**
+     * shared memory rings from workers to reactor threads, [worker_id * reactor_num + reactor_id]
+     */
+    swShmRing **ipc_response_rings;
+    /**
+     * events to a worker are coalesced into one pipe message of at most ipc_batch_size bytes,
+     * [swDataHead, flags = SW_EVENT_DATA_BATCH][uint64_t length][event]...
+     */
+    uint32_t ipc_batch_size;
+    /**
+     * stop reading the connections dispatched to a worker while its queued ipc bytes are above the high watermark,
+     * resume them below the low watermark
+     */
+    uint32_t ipc_high_watermark;
+    uint32_t ipc_low_watermark;
+
+#ifdef SW_USE_OPENSSL
+    uint16_t ssl_handshake_thread_num;
+    swSSLHandshakeThread *ssl_handshake_threads;
+#endif
+
     void *ptr2;
     void *private_data_3;
 
@@ -501,6 +753,11 @@ struct _swServer
     uint16_t task_max_request;
     swPipe *task_notify;
     swEventData *task_result;
+    /**
+     * shared arena for the large task packages, tmpfiles are used when it is full
+     */
+    size_t task_shm_size;
+    swMemoryPool *task_shm;
 
     /**
      * user process
@@ -523,7 +780,11 @@ struct _swServer
 #endif
 
     swConnection *connection_list;
+    /**
+     * slot of session_id is session_id & session_list_mask, the higher bits tag the generation of the slot
+     */
     swSession *session_list;
+    uint32_t session_list_mask;
 
     /**
      * temporary directory for HTTP uploaded file.
@@ -612,6 +873,10 @@ struct _swServer
 typedef struct
 {
     size_t length;
+    /**
+     * the data in serv->task_shm, or NULL when it is written to the tmpfile
+     */
+    void *shm_data;
     char tmpfile[SW_TASK_TMPDIR_SIZE + sizeof(SW_TASK_TMP_FILE)];
 } swPackage_task;
 
@@ -635,6 +900,11 @@ swListenPort* swServer_add_port(swServer *serv, int type, const char *host, int
 void swServer_close_port(swServer *serv, enum swBool_type only_stream_port);
 int swServer_add_worker(swServer *serv, swWorker *worker);
 int swServer_add_systemd_socket(swServer *serv);
+int swServer_handoff_adopt(swServer *serv, swListenPort *ls);
+void swServer_handoff_init(swServer *serv);
+int swServer_handoff_start(swServer *serv, swReactor *reactor);
+void swServer_handoff_check(swServer *serv);
+void swServer_handoff_free(swServer *serv);
 int swServer_add_hook(swServer *serv, enum swServer_hook_type type, swCallback func, int push_back);
 void swServer_call_hook(swServer *serv, enum swServer_hook_type type, void *arg);
 
@@ -676,7 +946,7 @@ static sw_inline swListenPort* swServer_get_port(swServer *serv, int fd)
 
 int swServer_udp_send(swServer *serv, swSendData *resp);
 
-#define SW_MAX_SESSION_ID             0x1000000
+#define SW_MAX_SESSION_ID             0x7fffffff
 
 static sw_inline int swEventData_is_dgram(uint8_t type)
 {
@@ -718,6 +988,10 @@ int swServer_get_socket(swServer *serv, int port);
 int swServer_worker_create(swServer *serv, swWorker *worker);
 int swServer_worker_init(swServer *serv, swWorker *worker);
 void swServer_worker_start(swServer *serv, swWorker *worker);
+#ifdef HAVE_NUMA
+void swServer_get_numa_cpus(swServer *serv, int id, cpu_set_t *cpu_set);
+void swServer_numa_bind_memory(swServer *serv);
+#endif
 
 swString** swServer_create_worker_buffer(swServer *serv);
 int swServer_create_task_worker(swServer *serv);
@@ -730,24 +1004,49 @@ int swTaskWorker_onFinish(swReactor *reactor, swEvent *event);
 void swTaskWorker_onStart(swProcessPool *pool, int worker_id);
 void swTaskWorker_onStop(swProcessPool *pool, int worker_id);
 int swTaskWorker_large_pack(swEventData *task, void *data, int data_len);
+void swTaskWorker_reclaim(swServer *serv, pid_t pid);
+void swTaskWorker_large_free(swEventData *task);
+void swTaskWorker_reset_result(swServer *serv, int worker_id);
+void swTaskWorker_reclaim_result(swServer *serv, int worker_id);
+void swTaskWorker_take_result(swServer *serv, swEventData *task);
+void swTaskWorker_check_queue(swServer *serv);
 int swTaskWorker_finish(swServer *serv, char *data, int data_len, int flags, swEventData *current_task);
 
 #define swTask_type(task)                  ((task)->info.from_fd)
+//owner of the task_shm block of a result in serv->task_result[worker_id]
+#define SW_TASK_RESULT_OWNER(worker_id)    (-1 - (pid_t) (worker_id))
 
 static sw_inline swString* swTaskWorker_large_unpack(swEventData *task_result)
 {
     swPackage_task _pkg;
     memcpy(&_pkg, task_result->data, sizeof(_pkg));
 
-    int tmp_file_fd = open(_pkg.tmpfile, O_RDONLY);
-    if (tmp_file_fd < 0)
+    if (SwooleTG.buffer_stack->size < _pkg.length && swString_extend_align(SwooleTG.buffer_stack, _pkg.length) < 0)
     {
-        swSysError("open(%s) failed.", _pkg.tmpfile);
         return NULL;
     }
-    if (SwooleTG.buffer_stack->size < _pkg.length && swString_extend_align(SwooleTG.buffer_stack, _pkg.length) < 0)
+    if (_pkg.shm_data)
     {
-        close(tmp_file_fd);
+        swMemoryPool *pool = SwooleG.serv->task_shm;
+        if (!(swTask_type(task_result) & SW_TASK_PEEK))
+        {
+            //taken by this process, the manager reclaims it if we die before freeing
+            swPagePool_set_owner(pool, _pkg.shm_data, SwooleG.pid);
+            memcpy(SwooleTG.buffer_stack->str, _pkg.shm_data, _pkg.length);
+            pool->free(pool, _pkg.shm_data);
+        }
+        else
+        {
+            memcpy(SwooleTG.buffer_stack->str, _pkg.shm_data, _pkg.length);
+        }
+        SwooleTG.buffer_stack->length = _pkg.length;
+        return SwooleTG.buffer_stack;
+    }
+
+    int tmp_file_fd = open(_pkg.tmpfile, O_RDONLY);
+    if (tmp_file_fd < 0)
+    {
+        swSysError("open(%s) failed.", _pkg.tmpfile);
         return NULL;
     }
     if (swoole_sync_readfile(tmp_file_fd, SwooleTG.buffer_stack->str, _pkg.length) != _pkg.length)
@@ -779,6 +1078,17 @@ static sw_inline swString* swTaskWorker_large_unpack(swEventData *task_result)
 #define swServer_get_minfd(serv) (serv->connection_list[SW_SERVER_MIN_FD_INDEX].fd)
 
 #define swServer_get_thread(serv, reactor_id)    (&(serv->reactor_threads[reactor_id]))
+#ifdef HAVE_NUMA
+#define swServer_get_numa_index(serv, id)    ((id) % serv->numa_node_num)
+#define swServer_numa_enabled(serv)          (serv->numa_node_num > 0)
+#else
+#define swServer_numa_enabled(serv)          0
+#endif
+#define swServer_get_ipc_ring(serv, reactor_id, worker_id)    (serv->ipc_rings[(reactor_id) * serv->worker_num + (worker_id)])
+#define SW_IPC_BATCH_HEAD_SIZE             SW_MEM_ALIGNED_SIZE(sizeof(swDataHead))
+#define SW_IPC_BATCH_ITEM_SIZE(length)     (sizeof(uint64_t) + SW_MEM_ALIGNED_SIZE(length))
+
+#define swServer_get_response_ring(serv, worker_id, reactor_id)    (serv->ipc_response_rings[(worker_id) * serv->reactor_num + (reactor_id)])
 
 static sw_inline swConnection* swServer_connection_get(swServer *serv, int fd)
 {
@@ -794,12 +1104,19 @@ static sw_inline swConnection* swServer_connection_get(swServer *serv, int fd)
 
 static sw_inline swSession* swServer_get_session(swServer *serv, uint32_t session_id)
 {
-    return &serv->session_list[session_id % SW_SESSION_LIST_SIZE];
+    return &serv->session_list[session_id & serv->session_list_mask];
+}
+
+static sw_inline void swServer_load_session(swServer *serv, uint32_t session_id, swSession *session)
+{
+    session->value = __atomic_load_n(&swServer_get_session(serv, session_id)->value, __ATOMIC_ACQUIRE);
 }
 
 static sw_inline int swServer_get_fd(swServer *serv, uint32_t session_id)
 {
-    return serv->session_list[session_id % SW_SESSION_LIST_SIZE].fd;
+    swSession session;
+    swServer_load_session(serv, session_id, &session);
+    return session.fd;
 }
 
 static sw_inline swWorker* swServer_get_worker(swServer *serv, uint16_t worker_id)
@@ -827,6 +1144,62 @@ static sw_inline swWorker* swServer_get_worker(swServer *serv, uint16_t worker_i
     return NULL;
 }
 
+static sw_inline uint64_t swServer_worker_load(swWorker *worker)
+{
+    int32_t inflight = worker->inflight;
+    return (uint64_t) (inflight > 0 ? inflight + 1 : 1) * (worker->service_time + 1);
+}
+
+/**
+ * power of two choices, the load is the in-flight requests weighted by the service time
+ */
+static sw_inline int swServer_worker_schedule_least_load(swServer *serv)
+{
+    uint32_t n = serv->worker_num;
+    if (n == 1)
+    {
+        return 0;
+    }
+    uint32_t round = sw_atomic_fetch_add(&serv->worker_round_id, 1);
+    uint32_t a = round % n;
+    uint32_t b = (a + 1 + ((round * 2654435761u) >> 16) % (n - 1)) % n;
+    if (swServer_worker_load(&serv->workers[b]) < swServer_worker_load(&serv->workers[a]))
+    {
+        return b;
+    }
+    return a;
+}
+
+/**
+ * [Master] choose the reactor thread for the accepted connection
+ */
+static sw_inline int swServer_reactor_schedule(swServer *serv, int fd)
+{
+    if (serv->reactor_dispatch_mode == SW_REACTOR_DISPATCH_FDMOD)
+    {
+        return fd % serv->reactor_num;
+    }
+
+    int i, reactor_id = 0;
+    uint64_t load, min_load = UINT64_MAX;
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        swReactorThread *thread = swServer_get_thread(serv, i);
+        load = thread->connection_num;
+        //a new connection counts as one event per second until the rate is sampled
+        if (serv->reactor_dispatch_mode == SW_REACTOR_DISPATCH_LEAST_EVENT)
+        {
+            load += thread->event_rate;
+        }
+        if (load < min_load)
+        {
+            min_load = load;
+            reactor_id = i;
+        }
+    }
+    return reactor_id;
+}
+
 static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData *data)
 {
     uint32_t key;
@@ -842,7 +1215,7 @@ static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData
         key = fd;
     }
     //Using the IP touch access to hash
-    else if (serv->dispatch_mode == SW_DISPATCH_IPMOD)
+    else if (serv->dispatch_mode == SW_DISPATCH_IPMOD || serv->dispatch_mode == SW_DISPATCH_IPHASH)
     {
         swConnection *conn = swServer_connection_get(serv, fd);
         //UDP
@@ -867,7 +1240,7 @@ static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData
 #endif
         }
     }
-    else if (serv->dispatch_mode == SW_DISPATCH_UIDMOD)
+    else if (serv->dispatch_mode == SW_DISPATCH_UIDMOD || serv->dispatch_mode == SW_DISPATCH_UIDHASH)
     {
         swConnection *conn = swServer_connection_get(serv, fd);
         if (conn == NULL || conn->uid == 0)
@@ -879,6 +1252,11 @@ static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData
             key = conn->uid;
         }
     }
+    //the less loaded of two workers
+    else if (serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD)
+    {
+        return swServer_worker_schedule_least_load(serv);
+    }
     //schedule by dispatch function
     else if (serv->dispatch_mode == SW_DISPATCH_USERFUNC)
     {
@@ -905,6 +1283,11 @@ static sw_inline int swServer_worker_schedule(swServer *serv, int fd, swSendData
         swTraceLog(SW_TRACE_SERVER, "schedule=%d, round=%d", key, serv->worker_round_id);
         return key;
     }
+    //consistent hash
+    if (serv->dispatch_mode == SW_DISPATCH_IPHASH || serv->dispatch_mode == SW_DISPATCH_UIDHASH)
+    {
+        return swoole_jump_hash(key, serv->gs->dispatch_hash_num);
+    }
     return key % serv->worker_num;
 }
 
@@ -958,14 +1341,16 @@ static sw_inline size_t swWorker_get_data(swEventData *req, char **data_ptr)
 
 static sw_inline swConnection *swServer_connection_verify_no_ssl(swServer *serv, uint32_t session_id)
 {
-    swSession *session = swServer_get_session(serv, session_id);
-    int fd = session->fd;
+    //one load, the slot is written as a whole by swServer_connection_new
+    swSession session;
+    swServer_load_session(serv, session_id, &session);
+    int fd = session.fd;
     swConnection *conn = swServer_connection_get(serv, fd);
     if (!conn || conn->active == 0)
     {
         return NULL;
     }
-    if (session->id != session_id || conn->session_id != session_id)
+    if (session.id != session_id || conn->session_id != session_id)
     {
         return NULL;
     }
@@ -1002,8 +1387,14 @@ void swWorker_free(swWorker *worker);
 void swWorker_onStart(swServer *serv);
 void swWorker_onStop(swServer *serv);
 void swWorker_try_to_exit();
+void swWorker_ready(swServer *serv);
 int swWorker_loop(swFactory *factory, int worker_pti);
 int swWorker_send2reactor(swServer *serv, swEventData *ev_data, size_t sendn, int fd);
+#ifdef HAVE_RECVMMSG
+int swWorker_dgram_send(swServer *serv, int fd, swSocketAddress *addr, char *data, uint32_t length);
+void swWorker_dgram_flush(void *data);
+#endif
+int swWorker_send2ring(swServer *serv, swDataHead *info, char *data, uint32_t length);
 int swWorker_send2worker(swWorker *dst_worker, void *buf, int n, int flag);
 void swWorker_signal_handler(int signo);
 void swWorker_signal_init(void);
@@ -1030,6 +1421,11 @@ void swReactorThread_free(swServer *serv);
 int swReactorThread_close(swReactor *reactor, int fd);
 int swReactorThread_dispatch(swConnection *conn, char *data, uint32_t length);
 int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, int len);
+int swReactorThread_send2ring(swServer *serv, swWorker *worker, swDataHead *info, char *data, uint32_t length);
+int swReactorThread_ipc_pause(swServer *serv, swConnection *conn, int worker_id);
+int swReactorThread_idle_init(swServer *serv, swReactorThread *thread);
+void swReactorThread_idle_enroll(swReactor *reactor, swConnection *conn);
+void swReactorThread_idle_check(swReactor *reactor);
 
 int swReactorProcess_create(swServer *serv);
 int swReactorProcess_start(swServer *serv);
@@ -65,6 +65,19 @@ typedef cpuset_t cpu_set_t;
 #endif
 #endif
 
+#if defined(HAVE_CPU_AFFINITY) && defined(__linux__)
+#define HAVE_NUMA
+#endif
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#define HAVE_ZEROCOPY
+#endif
+
+#ifdef __linux__
+#define HAVE_RECVMMSG
+#include <netinet/udp.h>
+#endif
+
 #ifdef __MACH__
 #include <mach/clock.h>
 #include <mach/mach_time.h>
@@ -196,6 +209,11 @@ typedef unsigned long ulong_t;
 #else
 #define SW_ASSERT(e)
 #endif
+#ifdef __cplusplus
+#define SW_STATIC_ASSERT(e, msg)    static_assert(e, msg)
+#else
+#define SW_STATIC_ASSERT(e, msg)    _Static_assert(e, msg)
+#endif
 #define SW_START_SLEEP         usleep(100000)  //sleep 1s,wait fork and pthread_create
 
 /*-----------------------------------Memory------------------------------------*/
@@ -302,6 +320,10 @@ enum swFd_type
      * c-ares
      */
     SW_FD_ARES,
+    /**
+     * [handoff_socket] unix socket between the old and the new master
+     */
+    SW_FD_HANDOFF,
     /**
      * SW_FD_USER or SW_FD_USER+n: for custom event
      */
@@ -379,6 +401,16 @@ enum swFactory_dispatch_mode
     SW_DISPATCH_UIDMOD   = 5,
     SW_DISPATCH_USERFUNC = 6,
     SW_DISPATCH_STREAM   = 7,
+    SW_DISPATCH_LEAST_LOAD = 8,
+    SW_DISPATCH_IPHASH   = 9,
+    SW_DISPATCH_UIDHASH  = 10,
+};
+
+enum swReactor_dispatch_mode
+{
+    SW_REACTOR_DISPATCH_FDMOD       = 1,
+    SW_REACTOR_DISPATCH_LEAST_CONN  = 2,
+    SW_REACTOR_DISPATCH_LEAST_EVENT = 3,
 };
 
 enum swWorker_status
@@ -495,12 +527,20 @@ typedef unsigned char uchar;
 typedef void (*swDestructor)(void *data);
 typedef void (*swCallback)(void *data);
 
-typedef struct
+/**
+ * the slot is read by the workers without lock, it is always loaded and stored as one 64 bits value
+ */
+typedef union
 {
-    uint32_t id;
-    uint32_t fd :24;
-    uint32_t reactor_id :8;
-} swSession;
+    struct
+    {
+        uint32_t id;
+        uint32_t fd :24;
+        uint32_t reactor_id :8;
+    };
+    uint64_t value;
+} __attribute__((aligned(8))) swSession;
+SW_STATIC_ASSERT(sizeof(swSession) == sizeof(uint64_t), "swSession must fit in one 64 bits store");
 
 typedef struct _swString
 {
@@ -542,6 +582,21 @@ typedef struct
     socklen_t len;
 } swSocketAddress;
 
+/**
+ * tail padding of swConnection on LP64, the entries of connection_list start on a cache line
+ */
+#if __SIZEOF_POINTER__ == 8
+#if defined(SW_USE_OPENSSL) && defined(SW_DEBUG)
+#define SW_CONNECTION_PAD    56
+#elif defined(SW_USE_OPENSSL)
+#define SW_CONNECTION_PAD    8
+#elif defined(SW_DEBUG)
+#define SW_CONNECTION_PAD    40
+#else
+#define SW_CONNECTION_PAD    56
+#endif
+#endif
+
 typedef struct _swConnection
 {
     /**
@@ -577,6 +632,8 @@ typedef struct _swConnection
     uint8_t ssl_send;
     //--------------------------------------------------------------
     uint8_t listen_wait;
+    uint8_t ipc_wait;
+    uint8_t pause_recv;
     uint8_t recv_wait;
     uint8_t send_wait;
     uint8_t close_wait;
@@ -606,6 +663,10 @@ typedef struct _swConnection
      */
     uint8_t protect;
     uint8_t nonblock;
+    /**
+     * SOCK_DGRAM socket, the buffered chunks are sent one by one
+     */
+    uint8_t dgram;
     //--------------------------------------------------------------
     uint8_t close_notify;
     uint8_t close_force;
@@ -625,10 +686,7 @@ typedef struct _swConnection
      */
     sw_atomic_t from_fd;
 
-    /**
-     * socket address
-     */
-    swSocketAddress info;
+    sw_atomic_t lock;
 
     /**
      * link any thing, for kernel, do not use with application.
@@ -651,14 +709,39 @@ typedef struct _swConnection
     swString *recv_buffer;
 
     /**
-     * connect time(seconds)
+     * received time with last data
      */
-    time_t connect_time;
+    time_t last_time;
 
+#ifdef SW_USE_OPENSSL
+    SSL *ssl;
+    uint32_t ssl_state;
     /**
-     * received time with last data
+     * the records are encrypted or decrypted by kernel TLS
+     */
+    uint8_t ssl_ktls_send;
+    uint8_t ssl_ktls_recv;
+    /**
+     * owned by a handshake thread, not in the reactor of from_id, 2 once it is handed back
+     */
+    uint8_t ssl_handshaking;
+#endif
+
+    //--------------------------------------------------------------
+    /**
+     * [cold] the fields above fit in the first two cache lines and are used on every event,
+     * the fields below are only used when the connection is accepted, closed or inspected.
      */
-    time_t last_time;
+
+    /**
+     * socket address
+     */
+    swSocketAddress info;
+
+    /**
+     * connect time(seconds)
+     */
+    time_t connect_time;
 
 #ifdef SW_BUFFER_RECV_TIME
     /**
@@ -682,25 +765,50 @@ typedef struct _swConnection
      */
     uint8_t websocket_status;
 
+    /**
+     * send the big chunks with MSG_ZEROCOPY
+     */
+    uint8_t zerocopy;
+
+    /**
+     * id of the next MSG_ZEROCOPY send, the kernel counts them from 0 on each socket
+     */
+    uint32_t zerocopy_seq;
+
+    /**
+     * the chunks which are sent with MSG_ZEROCOPY, released when the kernel reports the completion
+     */
+    struct _swBuffer *zerocopy_buffer;
+
     /**
      * unfinished data frame
      */
     swString *websocket_buffer;
 
 #ifdef SW_USE_OPENSSL
-    SSL *ssl;
-    uint32_t ssl_state;
     swString ssl_client_cert;
 #endif
-    sw_atomic_t lock;
 
 #ifdef SW_DEBUG
     size_t total_recv_bytes;
     size_t total_send_bytes;
 #endif
 
+#ifdef SW_CONNECTION_PAD
+    char _pad[SW_CONNECTION_PAD];
+#endif
+
 } swConnection;
 
+/**
+ * swConnection is also allocated by malloc for the clients and the reactor sockets, so the type is not aligned,
+ * the padding makes every entry of the page aligned connection_list start on a cache line
+ */
+#ifdef SW_CONNECTION_PAD
+SW_STATIC_ASSERT(sizeof(swConnection) % SW_CACHELINE_SIZE == 0, "swConnection is not padded to a cache line, update SW_CONNECTION_PAD");
+#endif
+SW_STATIC_ASSERT(offsetof(swConnection, info) <= 2 * SW_CACHELINE_SIZE, "the hot fields of swConnection exceed two cache lines");
+
 typedef struct _swProtocol
 {
     /* one package: eof check */
@@ -818,12 +926,14 @@ enum _swEventData_flag
     SW_EVENT_DATA_PTR = 1u << 1,
     SW_EVENT_DATA_CHUNK = 1u << 2,
     SW_EVENT_DATA_END = 1u << 3,
+    SW_EVENT_DATA_RING = 1u << 4,
+    SW_EVENT_DATA_BATCH = 1u << 5,
 };
 
 typedef struct _swDataHead
 {
     int fd;
-    uint16_t len;
+    uint32_t len;
     int16_t from_id;
     uint8_t type;
     uint8_t flags;
@@ -1122,6 +1232,25 @@ typedef struct _swFixedPool
     uint8_t shared;
 
 } swFixedPool;
+
+typedef struct _swPagePool
+{
+    sw_atomic_t lock;
+    uint8_t shared;
+    /**
+     * one byte for each page, 0 means the page is free, the first page of a block is marked apart from the others
+     */
+    uint8_t *map;
+    char *memory;
+    uint32_t page_num;
+    uint32_t page_size;
+    uint32_t page_use;
+    /**
+     * the page after the last allocated block
+     */
+    uint32_t offset;
+} swPagePool;
+
 /**
  * FixedPool, random alloc/free fixed size memory
  */
@@ -1134,6 +1263,16 @@ swMemoryPool* swMalloc_new();
  */
 swMemoryPool *swRingBuffer_new(uint32_t size, uint8_t shared);
 
+/**
+ * PagePool, random alloc/free variable size memory made of contiguous pages
+ */
+swMemoryPool* swPagePool_new(size_t size, uint32_t page_size, uint8_t shared);
+/**
+ * a block is owned by the process which allocated it, owner 0 is never reclaimed, a negative owner is defined by the user
+ */
+void swPagePool_set_owner(swMemoryPool *pool, void *ptr, pid_t owner);
+uint32_t swPagePool_reclaim(swMemoryPool *pool, pid_t owner);
+
 /**
  * Global memory, the program life cycle only malloc / free one time
  */
@@ -1149,6 +1288,9 @@ void sw_shm_free(void *ptr);
 void* sw_shm_calloc(size_t num, size_t _size);
 int sw_shm_protect(void *addr, int flags);
 void* sw_shm_realloc(void *ptr, size_t new_size);
+#ifdef HAVE_NUMA
+int sw_shm_numa_bind(void *ptr, int node);
+#endif
 
 #ifndef _WIN32
 #ifdef HAVE_RWLOCK
@@ -1366,6 +1508,12 @@ void swoole_fcntl_set_option(int sock, int nonblock, int cloexec);
 int swoole_gethostbyname(int type, char *name, char *addr);
 int swoole_getaddrinfo(swRequest_getaddrinfo *req);
 char* swoole_string_format(size_t n, const char *format, ...);
+#ifdef HAVE_NUMA
+int swoole_parse_cpulist(const char *str, cpu_set_t *set);
+int swoole_numa_get_nodes(int *nodes, int size);
+int swoole_numa_get_cpus(int node, cpu_set_t *set);
+int swoole_numa_bind(void *addr, size_t len, int node);
+#endif
 //----------------------core function---------------------
 int swSocket_set_timeout(int sock, double timeout);
 int swSocket_create_server(int type, char *address, int port, int backlog);
@@ -1444,6 +1592,7 @@ ssize_t swSocket_sendto_blocking(int, void *, size_t, int, struct sockaddr *, so
 int swSocket_set_buffer_size(int fd, uint32_t buffer_size);
 ssize_t swSocket_udp_sendto(int server_sock, char *dst_ip, int dst_port, char *data, uint32_t len);
 ssize_t swSocket_udp_sendto6(int server_sock, char *dst_ip, int dst_port, char *data, uint32_t len);
+int swSocket_udp_address(char *dst_ip, int dst_port, int ipv6, swSocketAddress *sa);
 ssize_t swSocket_unix_sendto(int server_sock, char *dst_path, char *data, uint32_t len);
 int swSocket_sendfile_sync(int sock, char *filename, off_t offset, size_t length, double timeout);
 int swSocket_write_blocking(int __fd, void *__data, int __len);
@@ -1477,6 +1626,14 @@ static sw_inline int swSocket_tcp_nopush(int sock, int nopush)
 #define swSocket_tcp_nopush(sock, nopush)
 #endif
 
+#ifdef HAVE_ZEROCOPY
+static sw_inline int swSocket_set_zerocopy(int sock)
+{
+    int value = 1;
+    return setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, (const void *) &value, sizeof(int));
+}
+#endif
+
 swSignalHandler swSignal_set(int sig, swSignalHandler func, int restart, int mask);
 void swSignal_add(int signo, swSignalHandler func);
 void swSignal_callback(int signo);
@@ -1647,6 +1804,13 @@ struct _swWorker
     long dispatch_count;
     long request_count;
 
+    /**
+     * [SW_DISPATCH_LEAST_LOAD] requests dispatched but not finished,
+     * and the moving average of the service time in microseconds
+     */
+    sw_atomic_int32_t inflight;
+    uint32_t service_time;
+
 	/**
 	 * worker id
 	 */
@@ -1708,6 +1872,11 @@ struct _swProcessPool
      */
     uint8_t use_socket;
 
+    /**
+     * use shared memory queue IPC, any idle worker takes the next task
+     */
+    uint8_t use_shm_queue;
+
     char *packet_buffer;
     uint32_t max_packet_size;
 
@@ -1728,6 +1897,10 @@ struct _swProcessPool
 
     int (*main_loop)(struct _swProcessPool *pool, swWorker *worker);
     int (*onWorkerNotFound)(struct _swProcessPool *pool, pid_t pid, int status);
+    /**
+     * called in the manager when a worker of the pool exited, before it is respawned
+     */
+    void (*onWorkerReap)(struct _swProcessPool *pool, swWorker *worker, int status);
 
     sw_atomic_t round_id;
 
@@ -1739,6 +1912,7 @@ struct _swProcessPool
     swMsgQueue *queue;
 #endif
     swStreamInfo *stream;
+    struct _swShmQueue *shm_queue;
 
     void *ptr;
     void *ptr2;
@@ -1937,6 +2111,7 @@ static sw_inline swReactor_handle swReactor_getHandle(swReactor *reactor, int ev
 }
 
 int swReactorEpoll_create(swReactor *reactor, int max_event_num);
+int swReactorUring_create(swReactor *reactor, int max_event_num);
 int swReactorPoll_create(swReactor *reactor, int max_event_num);
 int swReactorKqueue_create(swReactor *reactor, int max_event_num);
 int swReactorSelect_create(swReactor *reactor);
@@ -2026,6 +2201,98 @@ int swChannel_notify(swChannel *object);
 void swChannel_free(swChannel *object);
 void swChannel_print(swChannel *);
 
+//-----------------------------ShmRing---------------------------
+/**
+ * single producer, single consumer ring of variable length items in shared memory,
+ * items are always contiguous, so the consumer can use them in place
+ */
+typedef struct _swShmRing
+{
+    uint32_t size;
+    uint32_t mask;
+    /**
+     * set by the consumer before it goes to sleep, the producer must wake it up
+     */
+    sw_atomic_t consumer_wait;
+    /**
+     * set by the producer when the ring is full, the consumer must notify it after releasing items
+     */
+    sw_atomic_t producer_wait;
+    /**
+     * set by the consumer while the oldest item is being used in place
+     */
+    sw_atomic_t consumer_busy;
+    char _pad0[SW_CACHELINE_SIZE - 5 * sizeof(uint32_t)];
+    /**
+     * consumer position
+     */
+    sw_atomic_uint64_t head;
+    char _pad1[SW_CACHELINE_SIZE - sizeof(uint64_t)];
+    /**
+     * producer position, reserve_* are only used by the producer
+     */
+    sw_atomic_uint64_t tail;
+    uint32_t reserve_skip;
+    uint32_t reserve_size;
+    char _pad2[SW_CACHELINE_SIZE - sizeof(uint64_t) - 2 * sizeof(uint32_t)];
+    char data[0];
+} swShmRing;
+
+swShmRing* swShmRing_new(uint32_t size);
+void* swShmRing_alloc(swShmRing *ring, uint32_t length);
+void swShmRing_commit(swShmRing *ring);
+void* swShmRing_peek(swShmRing *ring, uint32_t *length);
+void swShmRing_release(swShmRing *ring);
+void swShmRing_free(swShmRing *ring);
+#define swShmRing_empty(ring)  ((ring)->head == (ring)->tail)
+
+//-----------------------------ShmQueue---------------------------
+/**
+ * multiple producers, multiple consumers bounded queue of fixed size slots in shared memory.
+ * push and pop take no lock and make no syscall unless they have to sleep on a futex.
+ */
+typedef struct _swShmQueue
+{
+    uint32_t size;
+    uint32_t mask;
+    /**
+     * max length of the data in a slot, and the distance between slots
+     */
+    uint32_t slot_size;
+    uint32_t stride;
+    /**
+     * number of consumers or producers sleeping on the futex words
+     */
+    sw_atomic_t pop_wait;
+    sw_atomic_t push_wait;
+    /**
+     * futex words, increased before waking up the sleepers
+     */
+    sw_atomic_t pop_futex;
+    sw_atomic_t push_futex;
+    char _pad0[SW_CACHELINE_SIZE - 8 * sizeof(uint32_t)];
+    sw_atomic_uint64_t head;
+    char _pad1[SW_CACHELINE_SIZE - sizeof(uint64_t)];
+    sw_atomic_uint64_t tail;
+    char _pad2[SW_CACHELINE_SIZE - sizeof(uint64_t)];
+    /**
+     * [manager] head and tail seen by the last swShmQueue_stalled()
+     */
+    uint64_t check_head;
+    uint64_t check_tail;
+    uint8_t check_stalled;
+    char _pad3[SW_CACHELINE_SIZE - 2 * sizeof(uint64_t) - sizeof(uint8_t)];
+    char slots[0];
+} swShmQueue;
+
+swShmQueue* swShmQueue_new(uint32_t size, uint32_t slot_size);
+int swShmQueue_push(swShmQueue *q, void *data, uint32_t length, int blocking);
+int swShmQueue_pop(swShmQueue *q, void *out, uint32_t buffer_length, int blocking);
+int swShmQueue_repair(swShmQueue *q, pid_t pid);
+int swShmQueue_stalled(swShmQueue *q);
+void swShmQueue_free(swShmQueue *q);
+#define swShmQueue_count(q)  ((q)->tail - (q)->head)
+
 /*----------------------------LinkedList-------------------------------*/
 swLinkedList* swLinkedList_new(uint8_t type, swDestructor dtor);
 int swLinkedList_append(swLinkedList *ll, void *data);
@@ -2045,6 +2312,7 @@ enum swThread_type
     SW_THREAD_UDP = 4,
     SW_THREAD_UNIX_DGRAM = 5,
     SW_THREAD_HEARTBEAT = 6,
+    SW_THREAD_SSL_HANDSHAKE = 7,
 };
 
 typedef struct _swThreadPool
@@ -2194,14 +2462,38 @@ typedef struct
     uint32_t in_client :1;
     uint32_t shutdown :1;
     uint32_t wait_exit :1;
+    /**
+     * [reload_batch_num] the manager has been told that the worker takes requests
+     */
+    uint32_t ready :1;
+    /**
+     * [standby_worker_num] forked for a slot still used by another worker, runs onWorkerStart but no event loop
+     */
+    uint32_t standby :1;
+    /**
+     * [ipc_ring_size] requests are left in the rings, the worker takes them again in a defer task
+     */
+    uint32_t ring_deferred :1;
 
     int max_request;
 
     swString **buffer_input;
     swString **buffer_output;
+    /**
+     * responses waiting for space in the shared memory ring of each reactor thread
+     */
+    struct _swBuffer **ring_buffers;
     swWorker *worker;
     time_t exit_time;
     swTimer_node *exit_timer;
+    /**
+     * [udp_send_batch] datagrams waiting for the end of the loop iteration
+     */
+    struct _swDgramQueue *dgram_queue;
+    /**
+     * [standby_worker_num] the manager writes to this pipe to hand the slot over
+     */
+    int standby_fd;
 
 } swWorkerG;
 
@@ -2212,6 +2504,18 @@ typedef struct
     uint8_t update_time;
     swString *buffer_stack;
     swReactor *reactor;
+    /**
+     * recycle the chunks of swBuffer, NULL if the thread does not use it
+     */
+    struct _swBuffer_slab *buffer_slab;
+    /**
+     * [recvmmsg] receive buffers of the UDP sockets
+     */
+    struct _swDgramBatch *dgram_batch;
+    /**
+     * [ssl_handshake_thread_num] the reactor thread does the full handshake itself
+     */
+    uint8_t ssl_handshake_inline;
 } swThreadG;
 
 typedef struct
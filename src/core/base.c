@@ -109,7 +109,7 @@ void swoole_init(void)
     else
     {
         SwooleG.max_sockets = MAX((uint32_t) rlmt.rlim_cur, 1024);
-        SwooleG.max_sockets = MIN((uint32_t) rlmt.rlim_cur, SW_SESSION_LIST_SIZE);
+        SwooleG.max_sockets = MIN((uint32_t) rlmt.rlim_cur, SW_SESSION_MAX_NUM);
     }
 #endif
 
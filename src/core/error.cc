@@ -101,6 +101,8 @@ const char* swoole_strerror(enum swErrorCode code)
         return "Task package too big";
     case SW_ERROR_TASK_DISPATCH_FAIL:
         return "Task dispatch fail";
+    case SW_ERROR_TASK_QUEUE_STALLED:
+        return "Task queue stalled";
     case SW_ERROR_HTTP2_STREAM_ID_TOO_BIG:
         return "Http2 stream id too big";
     case SW_ERROR_HTTP2_STREAM_NO_HEADER:
@@ -0,0 +1,335 @@
+/*
+  +----------------------------------------------------------------------+
+  | Swoole                                                               |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 2.0 of the Apache license,    |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+  | If you did not receive a copy of the Apache2.0 license and are unable|
+  | to obtain it through the world-wide-web, please send a note to       |
+  | license@swoole.com so we can mail you a copy immediately.            |
+  +----------------------------------------------------------------------+
+  | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+  +----------------------------------------------------------------------+
+*/
+
+#include "swoole.h"
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+/**
+ * seq == pos: the slot is free for the producer which takes pos,
+ * seq == pos + 1: the slot is ready for the consumer which takes pos.
+ *
+ * a slot is taken by a CAS on tail or head and handed on by the store to seq after the copy,
+ * the ring stalls at it if the process is killed in between, see swShmQueue_repair() and swShmQueue_stalled()
+ */
+typedef struct _swShmQueue_slot
+{
+    sw_atomic_uint64_t seq;
+    uint32_t length;
+    /**
+     * the process which has taken the slot and not handed it on yet, or 0
+     */
+    pid_t pid;
+    char data[0];
+} swShmQueue_slot;
+
+//the slot of a producer which died before publishing it, skipped by the consumer
+#define SW_SHM_QUEUE_DISCARDED  ((uint32_t) -1)
+
+#define swShmQueue_get_slot(q, pos)  ((swShmQueue_slot *) ((q)->slots + ((pos) & (q)->mask) * (size_t) (q)->stride))
+
+static sw_inline int swShmQueue_futex_wait(sw_atomic_t *futex, uint32_t value)
+{
+#ifdef __linux__
+    //EAGAIN means the value has been changed, try again at once
+    if (syscall(SYS_futex, futex, FUTEX_WAIT, value, NULL, NULL, 0) < 0 && errno == EINTR)
+#else
+    if (usleep(1000) < 0 && errno == EINTR)
+#endif
+    {
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+/**
+ * the other side stores its counter and then checks the queue, so a full barrier is needed here
+ */
+static sw_inline void swShmQueue_wakeup(sw_atomic_t *wait, sw_atomic_t *futex)
+{
+    __sync_synchronize();
+    if (*wait > 0)
+    {
+        sw_atomic_fetch_add(futex, 1);
+#ifdef __linux__
+        syscall(SYS_futex, futex, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+    }
+}
+
+swShmQueue* swShmQueue_new(uint32_t size, uint32_t slot_size)
+{
+    uint32_t n = 2;
+    while (n < size)
+    {
+        n <<= 1;
+    }
+
+    uint32_t stride = SW_MEM_ALIGNED_SIZE_EX(sizeof(swShmQueue_slot) + slot_size, SW_CACHELINE_SIZE);
+    swShmQueue *q = sw_shm_malloc(sizeof(swShmQueue) + (size_t) stride * n);
+    if (q == NULL)
+    {
+        swWarn("sw_shm_malloc(%ld) failed.", (long) (sizeof(swShmQueue) + (size_t) stride * n));
+        return NULL;
+    }
+    bzero(q, sizeof(swShmQueue));
+    q->size = n;
+    q->mask = n - 1;
+    q->slot_size = slot_size;
+    q->stride = stride;
+
+    uint32_t i;
+    for (i = 0; i < n; i++)
+    {
+        swShmQueue_get_slot(q, i)->seq = i;
+    }
+    return q;
+}
+
+static int swShmQueue_try_push(swShmQueue *q, void *data, uint32_t length)
+{
+    uint64_t pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    swShmQueue_slot *slot;
+
+    while (1)
+    {
+        slot = swShmQueue_get_slot(q, pos);
+        int64_t diff = (int64_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - pos);
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return SW_ERR;
+        }
+        else
+        {
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->pid = SwooleG.pid;
+    slot->length = length;
+    memcpy(slot->data, data, length);
+    slot->pid = 0;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+    return SW_OK;
+}
+
+static int swShmQueue_try_pop(swShmQueue *q, void *out, uint32_t buffer_length)
+{
+    uint64_t pos;
+    swShmQueue_slot *slot;
+
+    _pop:
+    pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    while (1)
+    {
+        slot = swShmQueue_get_slot(q, pos);
+        int64_t diff = (int64_t) (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) - (pos + 1));
+        if (diff == 0)
+        {
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            return SW_ERR;
+        }
+        else
+        {
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (slot->length == SW_SHM_QUEUE_DISCARDED)
+    {
+        __atomic_store_n(&slot->seq, pos + q->size, __ATOMIC_RELEASE);
+        goto _pop;
+    }
+
+    slot->pid = SwooleG.pid;
+    uint32_t length = SW_MIN(slot->length, buffer_length);
+    memcpy(out, slot->data, length);
+    slot->pid = 0;
+    __atomic_store_n(&slot->seq, pos + q->size, __ATOMIC_RELEASE);
+    return length;
+}
+
+/**
+ * [producer] copy the data to a slot, wait for a free slot if the queue is full and blocking is set
+ */
+int swShmQueue_push(swShmQueue *q, void *data, uint32_t length, int blocking)
+{
+    if (length > q->slot_size)
+    {
+        swWarn("data is too large, length=%d, slot_size=%d.", length, q->slot_size);
+        return SW_ERR;
+    }
+
+    while (1)
+    {
+        if (swShmQueue_try_push(q, data, length) == SW_OK)
+        {
+            swShmQueue_wakeup(&q->pop_wait, &q->pop_futex);
+            return length;
+        }
+        if (!blocking)
+        {
+            errno = EAGAIN;
+            return SW_ERR;
+        }
+
+        uint32_t value = q->push_futex;
+        sw_atomic_fetch_add(&q->push_wait, 1);
+        //check again after the counter is visible to the consumers
+        uint64_t pos = q->tail;
+        if ((int64_t) (swShmQueue_get_slot(q, pos)->seq - pos) < 0)
+        {
+            //the producer is not interrupted by signals, like msgsnd
+            swShmQueue_futex_wait(&q->push_futex, value);
+        }
+        sw_atomic_fetch_sub(&q->push_wait, 1);
+    }
+}
+
+/**
+ * [consumer] copy the oldest data out, return the length of it.
+ * wait for data if the queue is empty and blocking is set, return SW_ERR with EINTR when interrupted by a signal
+ */
+int swShmQueue_pop(swShmQueue *q, void *out, uint32_t buffer_length, int blocking)
+{
+    int n;
+
+    while (1)
+    {
+        if ((n = swShmQueue_try_pop(q, out, buffer_length)) >= 0)
+        {
+            swShmQueue_wakeup(&q->push_wait, &q->push_futex);
+            return n;
+        }
+        if (!blocking)
+        {
+            errno = EAGAIN;
+            return SW_ERR;
+        }
+
+        uint32_t value = q->pop_futex;
+        sw_atomic_fetch_add(&q->pop_wait, 1);
+        uint64_t pos = q->head;
+        if ((int64_t) (swShmQueue_get_slot(q, pos)->seq - (pos + 1)) < 0
+                && swShmQueue_futex_wait(&q->pop_futex, value) < 0)
+        {
+            sw_atomic_fetch_sub(&q->pop_wait, 1);
+            errno = EINTR;
+            return SW_ERR;
+        }
+        sw_atomic_fetch_sub(&q->pop_wait, 1);
+    }
+}
+
+/**
+ * [manager] hand on the slots which an exited process has taken and never handed on,
+ * the data of a producer is discarded. return the number of repaired slots.
+ * a process killed between the CAS and storing its pid still stalls the ring
+ */
+int swShmQueue_repair(swShmQueue *q, pid_t pid)
+{
+    uint64_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    swShmQueue_slot *slot;
+    uint64_t seq;
+    uint32_t i;
+    int n = 0;
+
+    for (i = 0; i < q->size; i++)
+    {
+        slot = swShmQueue_get_slot(q, i);
+        if (slot->pid != pid)
+        {
+            continue;
+        }
+        slot->pid = 0;
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        //taken by a producer, seq is still its pos
+        if ((seq & q->mask) == i && seq < tail)
+        {
+            slot->length = SW_SHM_QUEUE_DISCARDED;
+            __atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELEASE);
+            n++;
+        }
+        //taken by a consumer, seq is still its pos + 1
+        else if (((seq - 1) & q->mask) == i && seq - 1 < head)
+        {
+            __atomic_store_n(&slot->seq, seq - 1 + q->size, __ATOMIC_RELEASE);
+            n++;
+        }
+    }
+
+    if (n > 0)
+    {
+        swShmQueue_wakeup(&q->pop_wait, &q->pop_futex);
+        swShmQueue_wakeup(&q->push_wait, &q->push_futex);
+    }
+    return n;
+}
+
+/**
+ * [manager] called periodically, returns 1 the first time the ring is found stuck at the same slot as the last call:
+ * the head slot is taken by a producer, or the slot the producers need next is taken by a consumer.
+ * it happens when a process is killed before swShmQueue_repair() can know it holds the slot
+ */
+int swShmQueue_stalled(swShmQueue *q)
+{
+    uint64_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    uint64_t head_seq = __atomic_load_n(&swShmQueue_get_slot(q, head)->seq, __ATOMIC_ACQUIRE);
+    uint64_t tail_seq = __atomic_load_n(&swShmQueue_get_slot(q, tail)->seq, __ATOMIC_ACQUIRE);
+    int stalled = 0;
+
+    if (head == q->check_head && tail == q->check_tail)
+    {
+        stalled = (tail != head && head_seq == head) || (tail - head < q->size && tail_seq + q->size - 1 == tail);
+    }
+    q->check_head = head;
+    q->check_tail = tail;
+
+    if (!stalled)
+    {
+        q->check_stalled = 0;
+        return 0;
+    }
+    if (q->check_stalled)
+    {
+        return 0;
+    }
+    q->check_stalled = 1;
+    return 1;
+}
+
+void swShmQueue_free(swShmQueue *q)
+{
+    sw_shm_free(q);
+}
@@ -0,0 +1,125 @@
+/*
+  +----------------------------------------------------------------------+
+  | Swoole                                                               |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 2.0 of the Apache license,    |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+  | If you did not receive a copy of the Apache2.0 license and are unable|
+  | to obtain it through the world-wide-web, please send a note to       |
+  | license@swoole.com so we can mail you a copy immediately.            |
+  +----------------------------------------------------------------------+
+  | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+  +----------------------------------------------------------------------+
+*/
+
+#include "swoole.h"
+
+/**
+ * length == SW_SHM_RING_WRAP: the rest of the ring is unused, continue from the beginning
+ */
+#define SW_SHM_RING_WRAP     UINT32_MAX
+
+typedef struct _swShmRing_item
+{
+    uint32_t length;
+    uint32_t reserved;
+    char data[0];
+} swShmRing_item;
+
+swShmRing* swShmRing_new(uint32_t size)
+{
+    uint32_t n = SW_IPC_RING_MIN_SIZE;
+    while (n < size)
+    {
+        n <<= 1;
+    }
+
+    swShmRing *ring = sw_shm_malloc(sizeof(swShmRing) + n);
+    if (ring == NULL)
+    {
+        swWarn("sw_shm_malloc(%ld) failed.", (long) (sizeof(swShmRing) + n));
+        return NULL;
+    }
+    bzero(ring, sizeof(swShmRing));
+    ring->size = n;
+    ring->mask = n - 1;
+    return ring;
+}
+
+/**
+ * [producer] reserve a contiguous space, return NULL if the ring is full
+ */
+void* swShmRing_alloc(swShmRing *ring, uint32_t length)
+{
+    uint32_t size = SW_MEM_ALIGNED_SIZE(sizeof(swShmRing_item) + length);
+    uint64_t tail = ring->tail;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint32_t offset = tail & ring->mask;
+    uint32_t skip = 0;
+
+    if (offset + size > ring->size)
+    {
+        skip = ring->size - offset;
+    }
+    if (tail + skip + size - head > ring->size)
+    {
+        return NULL;
+    }
+    if (skip > 0)
+    {
+        ((swShmRing_item *) (ring->data + offset))->length = SW_SHM_RING_WRAP;
+    }
+
+    swShmRing_item *item = (swShmRing_item *) (ring->data + ((tail + skip) & ring->mask));
+    item->length = length;
+    ring->reserve_skip = skip;
+    ring->reserve_size = size;
+    return item->data;
+}
+
+/**
+ * [producer] publish the space returned by the last swShmRing_alloc
+ */
+void swShmRing_commit(swShmRing *ring)
+{
+    __atomic_store_n(&ring->tail, ring->tail + ring->reserve_skip + ring->reserve_size, __ATOMIC_RELEASE);
+}
+
+/**
+ * [consumer] get the oldest item without removing it
+ */
+void* swShmRing_peek(swShmRing *ring, uint32_t *length)
+{
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail)
+    {
+        return NULL;
+    }
+    swShmRing_item *item = (swShmRing_item *) (ring->data + (head & ring->mask));
+    if (item->length == SW_SHM_RING_WRAP)
+    {
+        head += ring->size - (head & ring->mask);
+        __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+        item = (swShmRing_item *) ring->data;
+    }
+    *length = item->length;
+    return item->data;
+}
+
+/**
+ * [consumer] remove the item returned by swShmRing_peek, its memory may be reused by the producer at once
+ */
+void swShmRing_release(swShmRing *ring)
+{
+    swShmRing_item *item = (swShmRing_item *) (ring->data + (ring->head & ring->mask));
+    __atomic_store_n(&ring->head, ring->head + SW_MEM_ALIGNED_SIZE(sizeof(swShmRing_item) + item->length), __ATOMIC_RELEASE);
+}
+
+void swShmRing_free(swShmRing *ring)
+{
+    sw_shm_free(ring);
+}
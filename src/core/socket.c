@@ -239,31 +239,52 @@ int swSocket_accept(int fd, swSocketAddress *sa)
     return conn;
 }
 
+int swSocket_udp_address(char *dst_ip, int dst_port, int ipv6, swSocketAddress *sa)
+{
+    bzero(sa, sizeof(*sa));
+    if (ipv6)
+    {
+        if (inet_pton(AF_INET6, dst_ip, &sa->addr.inet_v6.sin6_addr) <= 0)
+        {
+            swWarn("ip[%s] is invalid.", dst_ip);
+            return SW_ERR;
+        }
+        sa->addr.inet_v6.sin6_port = (uint16_t) htons(dst_port);
+        sa->addr.inet_v6.sin6_family = AF_INET6;
+        sa->len = sizeof(sa->addr.inet_v6);
+    }
+    else
+    {
+        if (inet_aton(dst_ip, &sa->addr.inet_v4.sin_addr) == 0)
+        {
+            swWarn("ip[%s] is invalid.", dst_ip);
+            return SW_ERR;
+        }
+        sa->addr.inet_v4.sin_family = AF_INET;
+        sa->addr.inet_v4.sin_port = htons(dst_port);
+        sa->len = sizeof(sa->addr.inet_v4);
+    }
+    return SW_OK;
+}
+
 ssize_t swSocket_udp_sendto(int server_sock, char *dst_ip, int dst_port, char *data, uint32_t len)
 {
-    struct sockaddr_in addr;
-    if (inet_aton(dst_ip, &addr.sin_addr) == 0)
+    swSocketAddress sa;
+    if (swSocket_udp_address(dst_ip, dst_port, 0, &sa) < 0)
     {
-        swWarn("ip[%s] is invalid.", dst_ip);
         return SW_ERR;
     }
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(dst_port);
-    return swSocket_sendto_blocking(server_sock, data, len, 0, (struct sockaddr *) &addr, sizeof(addr));
+    return swSocket_sendto_blocking(server_sock, data, len, 0, (struct sockaddr *) &sa.addr, sa.len);
 }
 
 ssize_t swSocket_udp_sendto6(int server_sock, char *dst_ip, int dst_port, char *data, uint32_t len)
 {
-    struct sockaddr_in6 addr;
-    bzero(&addr, sizeof(addr));
-    if (inet_pton(AF_INET6, dst_ip, &addr.sin6_addr) < 0)
+    swSocketAddress sa;
+    if (swSocket_udp_address(dst_ip, dst_port, 1, &sa) < 0)
     {
-        swWarn("ip[%s] is invalid.", dst_ip);
         return SW_ERR;
     }
-    addr.sin6_port = (uint16_t) htons(dst_port);
-    addr.sin6_family = AF_INET6;
-    return swSocket_sendto_blocking(server_sock, data, len, 0, (struct sockaddr *) &addr, sizeof(addr));
+    return swSocket_sendto_blocking(server_sock, data, len, 0, (struct sockaddr *) &sa.addr, sa.len);
 }
 
 #ifndef _WIN32
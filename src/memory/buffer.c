@@ -35,12 +35,96 @@ swBuffer* swBuffer_new(int chunk_size)
     return buffer;
 }
 
+void swBuffer_slab_init(swBuffer_slab *slab)
+{
+    bzero(slab, sizeof(swBuffer_slab));
+    slab->classes[SW_BUFFER_SLAB_CHUNK].size = sizeof(swBuffer_chunk);
+    slab->classes[SW_BUFFER_SLAB_CHUNK].max_free_num = SW_BUFFER_SLAB_CHUNK_NUM;
+    slab->classes[SW_BUFFER_SLAB_STD].size = SW_BUFFER_SIZE_STD;
+    slab->classes[SW_BUFFER_SLAB_STD].max_free_num = SW_BUFFER_SLAB_STD_NUM;
+    slab->classes[SW_BUFFER_SLAB_BIG].size = SW_BUFFER_SIZE_BIG;
+    slab->classes[SW_BUFFER_SLAB_BIG].max_free_num = SW_BUFFER_SLAB_BIG_NUM;
+}
+
+void swBuffer_slab_free(swBuffer_slab *slab)
+{
+    int i;
+    void *block;
+    for (i = 0; i < SW_BUFFER_SLAB_CLASS_NUM; i++)
+    {
+        while (slab->classes[i].free_list)
+        {
+            block = slab->classes[i].free_list;
+            slab->classes[i].free_list = *(void **) block;
+            sw_free(block);
+        }
+        slab->classes[i].free_num = 0;
+    }
+    slab->retained_bytes = 0;
+}
+
+/**
+ * the data class of the size, -1 if it is not recycled.
+ * a block is at most twice the size, the smaller data is left to malloc.
+ */
+static sw_inline int swBuffer_slab_get_class(uint32_t size)
+{
+    if (size > SW_BUFFER_SIZE_STD / 2 && size <= SW_BUFFER_SIZE_STD)
+    {
+        return SW_BUFFER_SLAB_STD;
+    }
+    else if (size > SW_BUFFER_SIZE_BIG / 2 && size <= SW_BUFFER_SIZE_BIG)
+    {
+        return SW_BUFFER_SLAB_BIG;
+    }
+    return -1;
+}
+
+static void* swBuffer_slab_alloc(swBuffer_slab *slab, int class_id)
+{
+    void *block = slab->classes[class_id].free_list;
+    slab->alloc_count++;
+    if (block)
+    {
+        slab->classes[class_id].free_list = *(void **) block;
+        slab->classes[class_id].free_num--;
+        slab->retained_bytes -= slab->classes[class_id].size;
+        slab->hit_count++;
+        return block;
+    }
+    return sw_malloc(slab->classes[class_id].size);
+}
+
+static void swBuffer_slab_release(swBuffer_slab *slab, int class_id, void *block)
+{
+    if (slab->classes[class_id].free_num >= slab->classes[class_id].max_free_num)
+    {
+        sw_free(block);
+        return;
+    }
+    *(void **) block = slab->classes[class_id].free_list;
+    slab->classes[class_id].free_list = block;
+    slab->classes[class_id].free_num++;
+    slab->retained_bytes += slab->classes[class_id].size;
+}
+
 /**
  * create new chunk
  */
 swBuffer_chunk *swBuffer_new_chunk(swBuffer *buffer, uint32_t type, uint32_t size)
 {
-    swBuffer_chunk *chunk = sw_malloc(sizeof(swBuffer_chunk));
+    swBuffer_slab *slab = SwooleTG.buffer_slab;
+    swBuffer_chunk *chunk;
+    int class_id;
+
+    if (slab)
+    {
+        chunk = swBuffer_slab_alloc(slab, SW_BUFFER_SLAB_CHUNK);
+    }
+    else
+    {
+        chunk = sw_malloc(sizeof(swBuffer_chunk));
+    }
     if (chunk == NULL)
     {
         swWarn("malloc for chunk failed. Error: %s[%d]", strerror(errno), errno);
@@ -50,13 +134,41 @@ swBuffer_chunk *swBuffer_new_chunk(swBuffer *buffer, uint32_t type, uint32_t siz
     bzero(chunk, sizeof(swBuffer_chunk));
 
     //require alloc memory
+#ifdef HAVE_ZEROCOPY
+    if (type == SW_CHUNK_ZEROCOPY)
+    {
+        /**
+         * the kernel holds the pages until the data is acked,
+         * unmapping them early is safe while free() could hand them to other data.
+         */
+        void *buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buf == MAP_FAILED)
+        {
+            swWarn("mmap(%d) for data failed. Error: %s[%d]", size, strerror(errno), errno);
+            swBuffer_free_chunk(chunk);
+            return NULL;
+        }
+        chunk->size = size;
+        chunk->store.ptr = buf;
+    }
+    else
+#endif
     if (type == SW_CHUNK_DATA && size > 0)
     {
-        void *buf = sw_malloc(size);
+        void *buf;
+        if (slab && (class_id = swBuffer_slab_get_class(size)) >= 0)
+        {
+            buf = swBuffer_slab_alloc(slab, class_id);
+            size = slab->classes[class_id].size;
+        }
+        else
+        {
+            buf = sw_malloc(size);
+        }
         if (buf == NULL)
         {
             swWarn("malloc(%d) for data failed. Error: %s[%d]", size, strerror(errno), errno);
-            sw_free(chunk);
+            swBuffer_free_chunk(chunk);
             return NULL;
         }
         chunk->size = size;
@@ -84,6 +196,16 @@ swBuffer_chunk *swBuffer_new_chunk(swBuffer *buffer, uint32_t type, uint32_t siz
  */
 void swBuffer_pop_chunk(swBuffer *buffer, swBuffer_chunk *chunk)
 {
+    swBuffer_shift_chunk(buffer);
+    swBuffer_free_chunk(chunk);
+}
+
+/**
+ * unlink the head chunk without releasing it
+ */
+swBuffer_chunk *swBuffer_shift_chunk(swBuffer *buffer)
+{
+    swBuffer_chunk *chunk = buffer->head;
     if (chunk->next == NULL)
     {
         buffer->head = NULL;
@@ -97,15 +219,64 @@ void swBuffer_pop_chunk(swBuffer *buffer, swBuffer_chunk *chunk)
         buffer->length -= chunk->length;
         buffer->chunk_num--;
     }
-    if (chunk->type == SW_CHUNK_DATA)
+    chunk->next = NULL;
+    return chunk;
+}
+
+/**
+ * link the chunk to the tail
+ */
+void swBuffer_push_chunk(swBuffer *buffer, swBuffer_chunk *chunk)
+{
+    chunk->next = NULL;
+    if (buffer->head == NULL)
+    {
+        buffer->tail = buffer->head = chunk;
+    }
+    else
+    {
+        buffer->tail->next = chunk;
+        buffer->tail = chunk;
+    }
+    buffer->length += chunk->length;
+    buffer->chunk_num++;
+}
+
+void swBuffer_free_chunk(swBuffer_chunk *chunk)
+{
+    swBuffer_slab *slab = SwooleTG.buffer_slab;
+    int class_id;
+
+    if (chunk->type == SW_CHUNK_DATA && chunk->store.ptr)
+    {
+        //the block may be allocated by a thread without slab
+        if (slab && (class_id = swBuffer_slab_get_class(chunk->size)) >= 0 && slab->classes[class_id].size == chunk->size)
+        {
+            swBuffer_slab_release(slab, class_id, chunk->store.ptr);
+        }
+        else
+        {
+            sw_free(chunk->store.ptr);
+        }
+    }
+#ifdef HAVE_ZEROCOPY
+    else if (chunk->type == SW_CHUNK_ZEROCOPY)
     {
-        sw_free(chunk->store.ptr);
+        munmap(chunk->store.ptr, chunk->size);
     }
+#endif
     if (chunk->destroy)
     {
         chunk->destroy(chunk);
     }
-    sw_free(chunk);
+    if (slab)
+    {
+        swBuffer_slab_release(slab, SW_BUFFER_SLAB_CHUNK, chunk);
+    }
+    else
+    {
+        sw_free(chunk);
+    }
 }
 
 /**
@@ -117,28 +288,17 @@ int swBuffer_free(swBuffer *buffer)
     swBuffer_chunk *will_free_chunk;  //free the point
     while (chunk != NULL)
     {
-        if (chunk->type == SW_CHUNK_DATA)
-        {
-            sw_free(chunk->store.ptr);
-        }
-        if (chunk->destroy)
-        {
-            chunk->destroy(chunk);
-        }
         will_free_chunk = chunk;
         chunk = chunk->next;
-        sw_free((void *) will_free_chunk);
+        swBuffer_free_chunk(will_free_chunk);
     }
     sw_free(buffer);
     return SW_OK;
 }
 
-/**
- * append to buffer queue
- */
-int swBuffer_append(swBuffer *buffer, void *data, uint32_t size)
+static int swBuffer_append_chunk(swBuffer *buffer, uint32_t type, void *data, uint32_t size)
 {
-    swBuffer_chunk *chunk = swBuffer_new_chunk(buffer, SW_CHUNK_DATA, size);
+    swBuffer_chunk *chunk = swBuffer_new_chunk(buffer, type, size);
     if (chunk == NULL)
     {
         return SW_ERR;
@@ -155,6 +315,24 @@ int swBuffer_append(swBuffer *buffer, void *data, uint32_t size)
     return SW_OK;
 }
 
+/**
+ * append to buffer queue
+ */
+int swBuffer_append(swBuffer *buffer, void *data, uint32_t size)
+{
+    return swBuffer_append_chunk(buffer, SW_CHUNK_DATA, data, size);
+}
+
+#ifdef HAVE_ZEROCOPY
+/**
+ * append to buffer queue, the chunk will be sent with MSG_ZEROCOPY
+ */
+int swBuffer_append_zerocopy(swBuffer *buffer, void *data, uint32_t size)
+{
+    return swBuffer_append_chunk(buffer, SW_CHUNK_ZEROCOPY, data, size);
+}
+#endif
+
 /**
  * print buffer
  */
@@ -0,0 +1,207 @@
+/*
+  +----------------------------------------------------------------------+
+  | Swoole                                                               |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 2.0 of the Apache license,    |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+  | If you did not receive a copy of the Apache2.0 license and are unable|
+  | to obtain it through the world-wide-web, please send a note to       |
+  | license@swoole.com so we can mail you a copy immediately.            |
+  +----------------------------------------------------------------------+
+  | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+  +----------------------------------------------------------------------+
+*/
+
+#include "swoole.h"
+
+//the map value of the first page of a block, the other pages are SW_PAGEPOOL_USED
+#define SW_PAGEPOOL_USED    1
+#define SW_PAGEPOOL_HEAD    2
+
+typedef struct
+{
+    uint32_t page_num;
+    uint32_t length;
+    /**
+     * the process holding the block, 0 while it is passed to another process
+     */
+    pid_t owner;
+} __attribute__((aligned(8))) swPagePool_item;
+
+#define swPagePool_get_item(object, i)  ((swPagePool_item *) ((object)->memory + (size_t) (i) * (object)->page_size))
+
+static void* swPagePool_alloc(swMemoryPool *pool, uint32_t size);
+static void swPagePool_free(swMemoryPool *pool, void *ptr);
+static void swPagePool_destroy(swMemoryPool *pool);
+
+/**
+ * create new PagePool, random alloc/free variable size memory made of contiguous pages.
+ * a block which is never freed only holds its own pages, unlike RingBuffer.
+ */
+swMemoryPool* swPagePool_new(size_t size, uint32_t page_size, uint8_t shared)
+{
+    uint32_t page_num = size / page_size;
+    if (page_num == 0)
+    {
+        swWarn("size(%ld) is less than page_size(%d).", (long) size, page_size);
+        return NULL;
+    }
+
+    size_t header_size = SW_MEM_ALIGNED_SIZE(sizeof(swPagePool) + sizeof(swMemoryPool) + page_num);
+    size_t alloc_size = header_size + (size_t) page_num * page_size;
+    void *memory = (shared == 1) ? sw_shm_malloc(alloc_size) : sw_malloc(alloc_size);
+    if (memory == NULL)
+    {
+        swWarn("malloc(%ld) failed.", (long) alloc_size);
+        return NULL;
+    }
+
+    swPagePool *object = memory;
+    bzero(object, header_size);
+    object->shared = shared;
+    object->page_num = page_num;
+    object->page_size = page_size;
+    object->map = (uint8_t *) memory + sizeof(swPagePool) + sizeof(swMemoryPool);
+    object->memory = (char *) memory + header_size;
+
+    swMemoryPool *pool = (swMemoryPool *) ((char *) memory + sizeof(swPagePool));
+    pool->object = object;
+    pool->alloc = swPagePool_alloc;
+    pool->free = swPagePool_free;
+    pool->destroy = swPagePool_destroy;
+
+    return pool;
+}
+
+/**
+ * find n free pages in [from, to), a used block is skipped as a whole
+ */
+static int swPagePool_find(swPagePool *object, uint32_t from, uint32_t to, uint32_t n)
+{
+    uint32_t i = from, count = 0;
+
+    while (i < to)
+    {
+        if (object->map[i] == 0)
+        {
+            i++;
+            if (++count == n)
+            {
+                return i - n;
+            }
+            continue;
+        }
+        count = 0;
+        //only a scan starting inside a block steps over its pages one by one
+        i += object->map[i] == SW_PAGEPOOL_HEAD ? swPagePool_get_item(object, i)->page_num : 1;
+    }
+    return -1;
+}
+
+static void* swPagePool_alloc(swMemoryPool *pool, uint32_t size)
+{
+    swPagePool *object = pool->object;
+    uint32_t n = (size + sizeof(swPagePool_item) + object->page_size - 1) / object->page_size;
+    uint32_t start;
+    int i;
+
+    if (size == 0 || n > object->page_num)
+    {
+        return NULL;
+    }
+
+    sw_spinlock(&object->lock);
+    /**
+     * next fit, start from the end of the last block
+     */
+    start = object->offset < object->page_num ? object->offset : 0;
+    i = swPagePool_find(object, start, object->page_num, n);
+    if (i < 0 && start > 0)
+    {
+        i = swPagePool_find(object, 0, SW_MIN(start + n - 1, object->page_num), n);
+    }
+    if (i < 0)
+    {
+        sw_spinlock_release(&object->lock);
+        return NULL;
+    }
+
+    object->map[i] = SW_PAGEPOOL_HEAD;
+    memset(&object->map[i + 1], SW_PAGEPOOL_USED, n - 1);
+    object->offset = i + n;
+    object->page_use += n;
+
+    swPagePool_item *item = swPagePool_get_item(object, i);
+    item->page_num = n;
+    item->length = size;
+    item->owner = SwooleG.pid;
+    sw_spinlock_release(&object->lock);
+
+    return (char *) item + sizeof(swPagePool_item);
+}
+
+static void swPagePool_free(swMemoryPool *pool, void *ptr)
+{
+    swPagePool *object = pool->object;
+    swPagePool_item *item = (swPagePool_item *) ((char *) ptr - sizeof(swPagePool_item));
+    uint32_t i = ((char *) item - object->memory) / object->page_size;
+
+    assert((char * ) ptr > object->memory && i + item->page_num <= object->page_num);
+
+    sw_spinlock(&object->lock);
+    memset(&object->map[i], 0, item->page_num);
+    object->page_use -= item->page_num;
+    sw_spinlock_release(&object->lock);
+}
+
+void swPagePool_set_owner(swMemoryPool *pool, void *ptr, pid_t owner)
+{
+    swPagePool_item *item = (swPagePool_item *) ((char *) ptr - sizeof(swPagePool_item));
+    item->owner = owner;
+}
+
+/**
+ * free the blocks still held by an exited process, return the number of pages
+ */
+uint32_t swPagePool_reclaim(swMemoryPool *pool, pid_t owner)
+{
+    swPagePool *object = pool->object;
+    swPagePool_item *item;
+    uint32_t i = 0, n = 0;
+
+    sw_spinlock(&object->lock);
+    while (i < object->page_num)
+    {
+        if (object->map[i] != SW_PAGEPOOL_HEAD)
+        {
+            i++;
+            continue;
+        }
+        item = swPagePool_get_item(object, i);
+        if (item->owner == owner)
+        {
+            memset(&object->map[i], 0, item->page_num);
+            object->page_use -= item->page_num;
+            n += item->page_num;
+        }
+        i += item->page_num;
+    }
+    sw_spinlock_release(&object->lock);
+
+    return n;
+}
+
+static void swPagePool_destroy(swMemoryPool *pool)
+{
+    swPagePool *object = pool->object;
+    if (object->shared)
+    {
+        sw_shm_free(object);
+    }
+    else
+    {
+        sw_free(object);
+    }
+}
@@ -19,11 +19,16 @@
 #include <sys/shm.h>
 #endif
 
+/**
+ * the header is padded, so that the memory returned to the caller starts at a cache line
+ */
+#define SW_SHM_HEADER_SIZE    SW_MEM_ALIGNED_SIZE_EX(sizeof(swShareMemory), SW_CACHELINE_SIZE)
+
 void* sw_shm_malloc(size_t size)
 {
     swShareMemory object;
     void *mem;
-    size += sizeof(swShareMemory);
+    size += SW_SHM_HEADER_SIZE;
     mem = swShareMemory_mmap_create(&object, size, NULL);
     if (mem == NULL)
     {
@@ -32,16 +37,19 @@ void* sw_shm_malloc(size_t size)
     else
     {
         memcpy(mem, &object, sizeof(swShareMemory));
-        return (char *) mem + sizeof(swShareMemory);
+        return (char *) mem + SW_SHM_HEADER_SIZE;
     }
 }
 
+/**
+ * the new mapping is already zero filled, do not touch it,
+ * so the pages are only committed when they are used for the first time
+ */
 void* sw_shm_calloc(size_t num, size_t _size)
 {
     swShareMemory object;
     void *mem;
-    void *ret_mem;
-    int size = sizeof(swShareMemory) + (num * _size);
+    size_t size = SW_SHM_HEADER_SIZE + (num * _size);
     mem = swShareMemory_mmap_create(&object, size, NULL);
     if (mem == NULL)
     {
@@ -50,27 +58,36 @@ void* sw_shm_calloc(size_t num, size_t _size)
     else
     {
         memcpy(mem, &object, sizeof(swShareMemory));
-        ret_mem = (char *) mem + sizeof(swShareMemory);
-        bzero(ret_mem, size - sizeof(swShareMemory));
-        return ret_mem;
+        return (char *) mem + SW_SHM_HEADER_SIZE;
     }
 }
 
+#ifdef HAVE_NUMA
+/**
+ * bind the shared memory to the NUMA node, interleave it on all nodes when node < 0
+ */
+int sw_shm_numa_bind(void *ptr, int node)
+{
+    swShareMemory *object = (swShareMemory *) ((char *) ptr - SW_SHM_HEADER_SIZE);
+    return swoole_numa_bind(object->mem, object->size, node);
+}
+#endif
+
 int sw_shm_protect(void *addr, int flags)
 {
-    swShareMemory *object = (swShareMemory *) ((char *) addr - sizeof(swShareMemory));
+    swShareMemory *object = (swShareMemory *) ((char *) addr - SW_SHM_HEADER_SIZE);
     return mprotect(object, object->size, flags);
 }
 
 void sw_shm_free(void *ptr)
 {
-    swShareMemory *object = (swShareMemory *) ((char *) ptr - sizeof(swShareMemory));
+    swShareMemory *object = (swShareMemory *) ((char *) ptr - SW_SHM_HEADER_SIZE);
     swShareMemory_mmap_free(object);
 }
 
 void* sw_shm_realloc(void *ptr, size_t new_size)
 {
-    swShareMemory *object = (swShareMemory *) ((char *) ptr - sizeof(swShareMemory));
+    swShareMemory *object = (swShareMemory *) ((char *) ptr - SW_SHM_HEADER_SIZE);
     void *new_ptr;
     new_ptr = sw_shm_malloc(new_size);
     if (new_ptr == NULL)
@@ -20,11 +20,20 @@
 #include "server.h"
 
 #include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifdef HAVE_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
 
 #ifndef MSG_NOSIGNAL
 #define MSG_NOSIGNAL        0
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX             16
+#endif
+
 int swConnection_onSendfile(swConnection *conn, swBuffer_chunk *chunk)
 {
     int ret;
@@ -120,10 +129,30 @@ int swConnection_onSendfile(swConnection *conn, swBuffer_chunk *chunk)
     return SW_OK;
 }
 
+static int swConnection_buffer_send_error(swConnection *conn)
+{
+    switch (swConnection_error(errno))
+    {
+    case SW_ERROR:
+        swWarn("send to fd[%d] failed. Error: %s[%d]", conn->fd, strerror(errno), errno);
+        break;
+    case SW_CLOSE:
+        conn->close_errno = errno;
+        conn->close_wait = 1;
+        return SW_ERR;
+    case SW_WAIT:
+        conn->send_wait = 1;
+        return SW_ERR;
+    default:
+        break;
+    }
+    return SW_OK;
+}
+
 /**
- * send buffer to client
+ * SSL_write() can not gather and a datagram must keep its boundary, send the head chunk only
  */
-int swConnection_buffer_send(swConnection *conn)
+static int swConnection_buffer_send_chunk(swConnection *conn)
 {
     int ret, sendn;
 
@@ -140,25 +169,10 @@ int swConnection_buffer_send(swConnection *conn)
     ret = swConnection_send(conn, (char*) chunk->store.ptr + chunk->offset, sendn, 0);
     if (ret < 0)
     {
-        switch (swConnection_error(errno))
-        {
-        case SW_ERROR:
-            swWarn("send to fd[%d] failed. Error: %s[%d]", conn->fd, strerror(errno), errno);
-            break;
-        case SW_CLOSE:
-            conn->close_errno = errno;
-            conn->close_wait = 1;
-            return SW_ERR;
-        case SW_WAIT:
-            conn->send_wait = 1;
-            return SW_ERR;
-        default:
-            break;
-        }
-        return SW_OK;
+        return swConnection_buffer_send_error(conn);
     }
     //chunk full send
-    else if (ret == sendn || sendn == 0)
+    else if (ret == sendn)
     {
         swBuffer_pop_chunk(buffer, chunk);
     }
@@ -169,6 +183,204 @@ int swConnection_buffer_send(swConnection *conn)
     return SW_OK;
 }
 
+#ifdef HAVE_ZEROCOPY
+/**
+ * release the chunks of the sends which are completed, the ids are compared with wrap around
+ */
+static void swConnection_zerocopy_release(swConnection *conn, uint32_t seq)
+{
+    swBuffer *buffer = conn->zerocopy_buffer;
+    while (!swBuffer_empty(buffer) && (int32_t) (buffer->head->seq - seq) <= 0)
+    {
+        swBuffer_pop_chunk(buffer, buffer->head);
+    }
+}
+
+/**
+ * read the MSG_ZEROCOPY completions from the error queue, each one covers the sends [ee_info, ee_data]
+ */
+int swConnection_zerocopy_complete(swConnection *conn)
+{
+    char control[128];
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    struct sock_extended_err *serr;
+
+    while (1)
+    {
+        bzero(&msg, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(conn->fd, &msg, MSG_ERRQUEUE) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno == EAGAIN ? SW_OK : SW_ERR;
+        }
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR)
+                    || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+            {
+                continue;
+            }
+            serr = (struct sock_extended_err *) CMSG_DATA(cmsg);
+            if (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY || serr->ee_errno != 0)
+            {
+                continue;
+            }
+            /**
+             * the kernel copied the data (loopback or the device can not gather),
+             * pinning the pages costs more than the copy, so stop using MSG_ZEROCOPY.
+             */
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+            {
+                conn->zerocopy = 0;
+            }
+            swTraceLog(SW_TRACE_SOCKET, "fd=%d, zerocopy completed [%u, %u]", conn->fd, serr->ee_info, serr->ee_data);
+            swConnection_zerocopy_release(conn, serr->ee_data);
+        }
+    }
+    return SW_OK;
+}
+#endif
+
+/**
+ * send buffer to client, the data chunks at the head are gathered into one sendmsg
+ */
+int swConnection_buffer_send(swConnection *conn)
+{
+    struct iovec iov[IOV_MAX];
+    struct msghdr msg;
+    int iovcnt = 0;
+    int flags = MSG_NOSIGNAL;
+    ssize_t ret;
+    uint32_t n;
+
+    swBuffer *buffer = conn->out_buffer;
+    swBuffer_chunk *chunk = swBuffer_get_chunk(buffer);
+    uint32_t type = chunk->type;
+
+    //the messages of unix dgram pipes can not be merged into one
+    if (conn->dgram)
+    {
+        return swConnection_buffer_send_chunk(conn);
+    }
+#ifdef SW_USE_OPENSSL
+    //with kernel TLS the plain writes are sent as application data records
+    if (conn->ssl && !conn->ssl_ktls_send)
+    {
+        return swConnection_buffer_send_chunk(conn);
+    }
+#endif
+
+    /**
+     * the chunks sent with MSG_ZEROCOPY must stay mapped until the completion,
+     * so they are never mixed with the data chunks in one send.
+     */
+    for (; chunk != NULL && chunk->type == type && iovcnt < IOV_MAX; chunk = chunk->next)
+    {
+        n = chunk->length - chunk->offset;
+        if (n == 0)
+        {
+            continue;
+        }
+        iov[iovcnt].iov_base = (char*) chunk->store.ptr + chunk->offset;
+        iov[iovcnt].iov_len = n;
+        iovcnt++;
+    }
+
+    if (iovcnt == 0)
+    {
+        swBuffer_pop_chunk(buffer, swBuffer_get_chunk(buffer));
+        return SW_OK;
+    }
+
+#ifdef HAVE_ZEROCOPY
+    if (type == SW_CHUNK_ZEROCOPY)
+    {
+        if (conn->zerocopy_buffer == NULL)
+        {
+            conn->zerocopy_buffer = swBuffer_new(0);
+            if (conn->zerocopy_buffer == NULL)
+            {
+                return SW_ERR;
+            }
+        }
+        flags |= MSG_ZEROCOPY;
+    }
+#endif
+
+    bzero(&msg, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
+
+    do
+    {
+        ret = sendmsg(conn->fd, &msg, flags);
+#ifdef HAVE_ZEROCOPY
+        //the pending completions are over the optmem limit, copy this time
+        if (ret < 0 && errno == ENOBUFS && (flags & MSG_ZEROCOPY))
+        {
+            flags &= ~MSG_ZEROCOPY;
+            errno = EINTR;
+        }
+#endif
+    }
+    while (ret < 0 && errno == EINTR);
+
+    swTraceLog(SW_TRACE_SOCKET, "sendmsg %ld bytes, iovcnt=%d, errno=%d", ret, iovcnt, errno);
+
+    if (ret < 0)
+    {
+        return swConnection_buffer_send_error(conn);
+    }
+
+#ifdef SW_DEBUG
+    conn->total_send_bytes += ret;
+#endif
+
+    while (!swBuffer_empty(buffer))
+    {
+        chunk = swBuffer_get_chunk(buffer);
+        n = chunk->length - chunk->offset;
+        //partial send
+        if ((size_t) ret < n)
+        {
+            chunk->offset += ret;
+            break;
+        }
+        ret -= n;
+#ifdef HAVE_ZEROCOPY
+        if (flags & MSG_ZEROCOPY)
+        {
+            chunk = swBuffer_shift_chunk(buffer);
+            chunk->seq = conn->zerocopy_seq;
+            swBuffer_push_chunk(conn->zerocopy_buffer, chunk);
+        }
+        else
+#endif
+        {
+            swBuffer_pop_chunk(buffer, chunk);
+        }
+        if (ret == 0)
+        {
+            break;
+        }
+    }
+
+#ifdef HAVE_ZEROCOPY
+    if (flags & MSG_ZEROCOPY)
+    {
+        conn->zerocopy_seq++;
+    }
+#endif
+    return SW_OK;
+}
+
 swString* swConnection_get_string_buffer(swConnection *conn)
 {
     swString *buffer = conn->object;
@@ -121,7 +121,16 @@ int swProcessPool_create(swProcessPool *pool, int worker_num, int max_request, k
     }
 	else
 #endif
-	if (ipc_mode == SW_IPC_SOCKET)
+	if (ipc_mode == SW_IPC_SHM_QUEUE)
+	{
+		pool->use_shm_queue = 1;
+		pool->shm_queue = swShmQueue_new(SW_SHM_QUEUE_SIZE, sizeof(swEventData));
+		if (pool->shm_queue == NULL)
+		{
+			return SW_ERR;
+		}
+	}
+	else if (ipc_mode == SW_IPC_SOCKET)
 	{
 		pool->use_socket = 1;
 		pool->stream = sw_malloc(sizeof(swStreamInfo));
@@ -500,6 +509,15 @@ static int swProcessPool_worker_loop(swProcessPool *pool, swWorker *worker)
                 break;
             }
         }
+        else if (pool->use_shm_queue)
+        {
+            n = swShmQueue_pop(pool->shm_queue, &out.buf, sizeof(out.buf), 1);
+            if (n < 0 && errno != EINTR)
+            {
+                swSysError("[Worker#%d] pop from the shared memory queue failed.", worker->id);
+                break;
+            }
+        }
         else if (pool->use_socket)
         {
             int fd = accept(pool->stream->socket, NULL, NULL);
@@ -806,6 +824,10 @@ int swProcessPool_wait(swProcessPool *pool)
                     WTERMSIG(status) == SIGSEGV ? "\n" SWOOLE_BUG_REPORT : ""
                 );
             }
+            if (pool->onWorkerReap)
+            {
+                pool->onWorkerReap(pool, exit_worker, status);
+            }
             new_pid = swProcessPool_spawn(pool, exit_worker);
             if (new_pid < 0)
             {
@@ -866,6 +888,11 @@ static void swProcessPool_free(swProcessPool *pool)
         swMsgQueue_free(pool->queue);
     }
 
+    if (pool->shm_queue)
+    {
+        swShmQueue_free(pool->shm_queue);
+    }
+
     if (pool->stream)
     {
         if (pool->stream->socket)
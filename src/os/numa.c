@@ -0,0 +1,181 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | Copyright (c) 2012-2018 The Swoole Group                             |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+
+#ifdef HAVE_NUMA
+
+#include <sys/syscall.h>
+
+/**
+ * libnuma is not required, mbind() is called directly
+ */
+#ifndef MPOL_BIND
+#define MPOL_BIND              2
+#define MPOL_INTERLEAVE        3
+#endif
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE           (1 << 1)
+#endif
+
+#define SW_NUMA_SYSFS_PATH     "/sys/devices/system/node"
+
+static int swoole_numa_read_list(const char *file, cpu_set_t *set)
+{
+    char buf[4096];
+    int fd = open(file, O_RDONLY);
+    if (fd < 0)
+    {
+        return SW_ERR;
+    }
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n < 0)
+    {
+        return SW_ERR;
+    }
+    buf[n] = 0;
+    return swoole_parse_cpulist(buf, set);
+}
+
+/**
+ * parse the list format of sysfs, such as "0-3,8-11"
+ */
+int swoole_parse_cpulist(const char *str, cpu_set_t *set)
+{
+    int count = 0;
+    long start, end;
+    char *p;
+
+    CPU_ZERO(set);
+    while (*str != '\0' && *str != '\n')
+    {
+        start = strtol(str, &p, 10);
+        if (p == str || start < 0)
+        {
+            return SW_ERR;
+        }
+        end = start;
+        if (*p == '-')
+        {
+            str = p + 1;
+            end = strtol(str, &p, 10);
+            if (p == str || end < start)
+            {
+                return SW_ERR;
+            }
+        }
+        if (end >= CPU_SETSIZE)
+        {
+            return SW_ERR;
+        }
+        for (; start <= end; start++)
+        {
+            CPU_SET(start, set);
+            count++;
+        }
+        if (*p == ',')
+        {
+            p++;
+        }
+        else if (*p != '\0' && *p != '\n')
+        {
+            return SW_ERR;
+        }
+        str = p;
+    }
+    return count;
+}
+
+/**
+ * get the online NUMA nodes, returns the number of nodes
+ */
+int swoole_numa_get_nodes(int *nodes, int size)
+{
+    cpu_set_t set;
+    int i, n = 0;
+
+    if (swoole_numa_read_list(SW_NUMA_SYSFS_PATH "/online", &set) < 0)
+    {
+        return SW_ERR;
+    }
+    for (i = 0; i < CPU_SETSIZE && n < size; i++)
+    {
+        if (CPU_ISSET(i, &set))
+        {
+            nodes[n++] = i;
+        }
+    }
+    return n;
+}
+
+/**
+ * get the CPUs of the NUMA node, returns the number of CPUs
+ */
+int swoole_numa_get_cpus(int node, cpu_set_t *set)
+{
+    char file[128];
+    snprintf(file, sizeof(file), SW_NUMA_SYSFS_PATH "/node%d/cpulist", node);
+    return swoole_numa_read_list(file, set);
+}
+
+/**
+ * bind the memory to the node, or interleave it on all online nodes when node < 0.
+ * the pages already touched are moved, so call it before the memory is shared with children.
+ */
+int swoole_numa_bind(void *addr, size_t len, int node)
+{
+    unsigned long mask[CPU_SETSIZE / (8 * sizeof(unsigned long))];
+    int mode, i;
+
+    bzero(mask, sizeof(mask));
+    if (node >= 0)
+    {
+        if (node >= CPU_SETSIZE)
+        {
+            return SW_ERR;
+        }
+        mode = MPOL_BIND;
+        mask[node / (8 * sizeof(unsigned long))] |= 1UL << (node % (8 * sizeof(unsigned long)));
+    }
+    else
+    {
+        cpu_set_t set;
+        if (swoole_numa_read_list(SW_NUMA_SYSFS_PATH "/online", &set) < 0)
+        {
+            return SW_ERR;
+        }
+        mode = MPOL_INTERLEAVE;
+        for (i = 0; i < CPU_SETSIZE; i++)
+        {
+            if (CPU_ISSET(i, &set))
+            {
+                mask[i / (8 * sizeof(unsigned long))] |= 1UL << (i % (8 * sizeof(unsigned long)));
+            }
+        }
+    }
+    //the kernel reads maxnode - 1 bits
+    if (syscall(SYS_mbind, addr, len, mode, mask, (unsigned long) CPU_SETSIZE + 1, MPOL_MF_MOVE) < 0)
+    {
+        swSysError("mbind(%p, %ld, %d) failed.", addr, (long) len, node);
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+#endif
@@ -19,6 +19,21 @@
 #include "swoole.h"
 #include "connection.h"
 
+/**
+ * stop reading when the worker is backed up or the connection had its share of the read event,
+ * the reactor signals it again. the rest of an SSL record is not signaled, it is always read.
+ */
+static sw_inline int swProtocol_recv_yield(swConnection *conn, size_t recv_bytes)
+{
+#ifdef SW_USE_OPENSSL
+    if (conn->ssl && SSL_pending(conn->ssl) > 0)
+    {
+        return SW_FALSE;
+    }
+#endif
+    return swConnection_recv_paused(conn) || recv_bytes >= SW_BUFFER_RECV_MAX_SIZE;
+}
+
 /**
  * return the package total length
  */
@@ -48,6 +63,10 @@ ssize_t swProtocol_get_package_length(swProtocol *protocol, swConnection *conn,
     return protocol->package_body_offset + body_length;
 }
 
+/**
+ * the packages are consumed in place, the remaining data is moved to the front once at the end,
+ * so a buffer holding N pipelined packages costs O(bytes) instead of O(N * bytes).
+ */
 static sw_inline int swProtocol_split_package_by_eof(swProtocol *protocol, swConnection *conn, swString *buffer)
 {
 #ifdef SW_LOG_TRACE_OPEN
@@ -56,32 +75,38 @@ static sw_inline int swProtocol_split_package_by_eof(swProtocol *protocol, swCon
 #endif
 
     int eof_pos;
+    size_t start = 0;
+    //buffer->offset is where to search the EOF, relative to start
     _find_eof:
-    if (buffer->length < protocol->package_eof_len)
+    if (buffer->length - start < protocol->package_eof_len)
     {
+        swString_pop_front(buffer, start);
         return SW_CONTINUE;
     }
-    else if (buffer->length - buffer->offset < protocol->package_eof_len)
+    else if (buffer->length - start - buffer->offset < protocol->package_eof_len)
     {
         eof_pos = -1;
     }
     else
     {
-        eof_pos = swoole_strnpos(buffer->str + buffer->offset, buffer->length - buffer->offset, protocol->package_eof, protocol->package_eof_len);
+        eof_pos = swoole_strnpos(buffer->str + start + buffer->offset, buffer->length - start - buffer->offset,
+                protocol->package_eof, protocol->package_eof_len);
     }
 
-    swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[0] count=%d, length=%ld, size=%ld, offset=%ld.", count, buffer->length, buffer->size, (long)buffer->offset);
+    swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[0] count=%d, length=%ld, size=%ld, offset=%ld, start=%ld.", count,
+            buffer->length, buffer->size, (long)buffer->offset, (long)start);
 
     //waiting for more data
     if (eof_pos < 0)
     {
+        swString_pop_front(buffer, start);
         buffer->offset = buffer->length - protocol->package_eof_len;
         return SW_CONTINUE;
     }
 
     uint32_t length = buffer->offset + eof_pos + protocol->package_eof_len;
     swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[4] count=%d, length=%d", count, length);
-    if (protocol->onPackage(conn, buffer->str, length) < 0)
+    if (protocol->onPackage(conn, buffer->str + start, length) < 0)
     {
         return SW_CLOSE;
     }
@@ -90,11 +115,12 @@ static sw_inline int swProtocol_split_package_by_eof(swProtocol *protocol, swCon
         return SW_OK;
     }
 
+    start += length;
+    buffer->offset = 0;
     //there are remaining data
-    if (length < buffer->length)
+    if (start < buffer->length)
     {
-        swString_pop_front(buffer, length);
-        swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[5] count=%d, remaining_length=%zu", count, buffer->length);
+        swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[5] count=%d, remaining_length=%zu", count, buffer->length - start);
         goto _find_eof;
     }
     swTraceLog(SW_TRACE_EOF_PROTOCOL, "#[3] length=%ld, size=%ld, offset=%ld", buffer->length, buffer->size, (long)buffer->offset);
@@ -109,34 +135,36 @@ static sw_inline int swProtocol_split_package_by_eof(swProtocol *protocol, swCon
 }
 
 /**
+ * read as much as the buffer holds and dispatch all the complete packages in place,
+ * buffer->offset is the length of the package when conn->recv_wait is set.
+ *
  * @return SW_ERR: close the connection
  * @return SW_OK: continue
  */
 int swProtocol_recv_check_length(swProtocol *protocol, swConnection *conn, swString *buffer)
 {
     int package_length;
-    uint8_t package_length_size = protocol->get_package_length_size ? protocol->get_package_length_size(conn) : protocol->package_length_size;
-    uint32_t recv_size;
+    int recv_again;
+    size_t recv_size, start, recv_bytes = 0;
+    off_t wait_length;
 
     if (conn->skip_recv)
     {
         conn->skip_recv = 0;
+        recv_again = SW_TRUE;
         goto _do_get_length;
     }
 
     do_recv:
-	if (conn->active == 0)
-	{
-		return SW_OK;
-	}
-    if (buffer->offset > 0)
+    if (conn->active == 0)
     {
-        recv_size = buffer->offset - buffer->length;
+        return SW_OK;
     }
-    else
+    if (buffer->length == buffer->size && swString_extend(buffer, buffer->size * 2) < 0)
     {
-        recv_size = protocol->package_length_offset + package_length_size;
+        return SW_ERR;
     }
+    recv_size = buffer->size - buffer->length;
 
     int n = swConnection_recv(conn, buffer->str + buffer->length, recv_size, 0);
     if (n < 0)
@@ -144,7 +172,7 @@ int swProtocol_recv_check_length(swProtocol *protocol, swConnection *conn, swStr
         switch (swConnection_error(errno))
         {
         case SW_ERROR:
-            swSysError("recv(%d, %d) failed.", conn->fd, recv_size);
+            swSysError("recv(%d, %d) failed.", conn->fd, (int) recv_size);
             return SW_OK;
         case SW_CLOSE:
             conn->close_errno = errno;
@@ -157,47 +185,25 @@ int swProtocol_recv_check_length(swProtocol *protocol, swConnection *conn, swStr
     {
         return SW_ERR;
     }
-    else
-    {
-        buffer->length += n;
-
-        if (conn->recv_wait)
-        {
-            if (buffer->length >= buffer->offset)
-            {
-                do_dispatch:
-                if (protocol->onPackage(conn, buffer->str, buffer->offset) < 0)
-                {
-                    return SW_ERR;
-                }
-                if (conn->removed)
-                {
-                    return SW_OK;
-                }
-                conn->recv_wait = 0;
 
-                if (buffer->length > buffer->offset)
-                {
-                	swString_pop_front(buffer, buffer->offset);
-                    goto _do_get_length;
-                }
-                else
-                {
-                    swString_clear(buffer);
+    buffer->length += n;
+    recv_bytes += n;
+    //the buffer is full, there may be more data in the socket
+    recv_again = (size_t) n == recv_size;
 #ifdef SW_USE_OPENSSL
-                    if (conn->ssl)
-                    {
-                        goto do_recv;
-                    }
+    if (conn->ssl)
+    {
+        recv_again = SW_TRUE;
+    }
 #endif
-                }
-            }
-            return SW_OK;
-        }
-        else
+
+    _do_get_length:
+    start = 0;
+    while (1)
+    {
+        if (!conn->recv_wait)
         {
-            _do_get_length:
-            package_length = protocol->get_package_length(protocol, conn, buffer->str, buffer->length);
+            package_length = protocol->get_package_length(protocol, conn, buffer->str + start, buffer->length - start);
             //invalid package, close connection.
             if (package_length < 0)
             {
@@ -206,37 +212,50 @@ int swProtocol_recv_check_length(swProtocol *protocol, swConnection *conn, swStr
             //no length
             else if (package_length == 0)
             {
-                return SW_OK;
+                break;
             }
             else if (package_length > protocol->package_max_length)
             {
                 swWarn("package is too big, remote_addr=%s:%d, length=%d.", swConnection_get_ip(conn), swConnection_get_port(conn), package_length);
                 return SW_ERR;
             }
-            //get length success
-            else
-            {
-                if (buffer->size < package_length)
-                {
-                    if (swString_extend(buffer, package_length) < 0)
-                    {
-                        return SW_ERR;
-                    }
-                }
-                conn->recv_wait = 1;
-                buffer->offset = package_length;
+            conn->recv_wait = 1;
+            buffer->offset = package_length;
+        }
+        if (buffer->length - start < (size_t) buffer->offset)
+        {
+            break;
+        }
+        if (protocol->onPackage(conn, buffer->str + start, buffer->offset) < 0)
+        {
+            return SW_ERR;
+        }
+        if (conn->removed)
+        {
+            return SW_OK;
+        }
+        conn->recv_wait = 0;
+        start += buffer->offset;
+        buffer->offset = 0;
+    }
 
-                if (buffer->length >= package_length)
-                {
-                    goto do_dispatch;
-                }
-                else
-                {
-                    goto do_recv;
-                }
-            }
+    //move the incomplete package to the front
+    wait_length = buffer->offset;
+    swString_pop_front(buffer, start);
+    buffer->offset = wait_length;
+
+    if (conn->recv_wait && buffer->size < (size_t) wait_length)
+    {
+        if (swString_extend(buffer, wait_length) < 0)
+        {
+            return SW_ERR;
         }
     }
+
+    if (recv_again && !swProtocol_recv_yield(conn, recv_bytes))
+    {
+        goto do_recv;
+    }
     return SW_OK;
 }
 
@@ -248,6 +267,7 @@ int swProtocol_recv_check_eof(swProtocol *protocol, swConnection *conn, swString
 {
     int recv_again = SW_FALSE;
     int buf_size;
+    size_t recv_bytes = 0;
 
     recv_data: buf_size = buffer->size - buffer->length;
     char *buf_ptr = buffer->str + buffer->length;
@@ -279,6 +299,7 @@ int swProtocol_recv_check_eof(swProtocol *protocol, swConnection *conn, swString
     else
     {
         buffer->length += n;
+        recv_bytes += n;
 
         if (buffer->length < protocol->package_eof_len)
         {
@@ -346,7 +367,7 @@ int swProtocol_recv_check_eof(swProtocol *protocol, swConnection *conn, swString
             }
         }
         //no eof
-        if (recv_again)
+        if (recv_again && !swProtocol_recv_yield(conn, recv_bytes))
         {
             goto recv_data;
         }
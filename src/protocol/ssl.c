@@ -16,12 +16,18 @@
 
 #include "swoole.h"
 #include "connection.h"
+#include "table.h"
 
 #ifdef SW_USE_OPENSSL
 
 #include <openssl/crypto.h>
 #include <openssl/x509.h>
 #include <openssl/x509v3.h>
+#include <openssl/rand.h>
+#include <openssl/hmac.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#endif
 
 static int openssl_init = 0;
 static pthread_mutex_t *lock_array;
@@ -260,6 +266,364 @@ int swSSL_server_set_cipher(SSL_CTX* ssl_context, swSSL_config *cfg)
     return SW_OK;
 }
 
+/**
+ * session ticket keys in shared memory, rotated by the first handshake after the interval elapsed
+ */
+typedef struct
+{
+    sw_atomic_t lock;
+    uint32_t current;
+    time_t rotated;
+    struct
+    {
+        uchar name[16];
+        uchar aes_key[32];
+        uchar hmac_key[32];
+    } keys[SW_SSL_TICKET_KEY_NUM];
+} swSSL_ticket_keys;
+
+typedef struct
+{
+    swTable *table;
+    swTableColumn *col_data;
+    swTableColumn *col_expire;
+    swSSL_ticket_keys *ticket_keys;
+    uint32_t ticket_key_rotate;
+} swSSL_session_cache;
+
+static int swSSL_session_cache_index = -1;
+
+static sw_inline swSSL_session_cache* swSSL_get_session_cache(SSL_CTX *ssl_context)
+{
+    return (swSSL_session_cache *) SSL_CTX_get_ex_data(ssl_context, swSSL_session_cache_index);
+}
+
+/**
+ * the keys of swTable are compared as strings
+ */
+static sw_inline int swSSL_session_key(const uchar *id, uint32_t len, char *key)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint32_t i;
+    if (len > SW_TABLE_KEY_SIZE / 2)
+    {
+        len = SW_TABLE_KEY_SIZE / 2;
+    }
+    for (i = 0; i < len; i++)
+    {
+        key[i * 2] = hex[id[i] >> 4];
+        key[i * 2 + 1] = hex[id[i] & 0xf];
+    }
+    return len * 2;
+}
+
+static int swSSL_new_session(SSL *ssl, SSL_SESSION *session)
+{
+    swSSL_session_cache *cache = swSSL_get_session_cache(SSL_get_SSL_CTX(ssl));
+    uchar buf[SW_SSL_SESSION_MAX_SIZE];
+    char key[SW_TABLE_KEY_SIZE];
+    uchar *p = buf;
+    uint32_t id_len;
+    swTableRow *_rowlock = NULL;
+
+    int len = i2d_SSL_SESSION(session, NULL);
+    if (len <= 0 || len > (int) sizeof(buf))
+    {
+        return 0;
+    }
+    i2d_SSL_SESSION(session, &p);
+
+    const uchar *id = SSL_SESSION_get_id(session, &id_len);
+    int key_len = swSSL_session_key(id, id_len, key);
+    int64_t expire = (int64_t) SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session);
+
+    swTableRow *row = swTableRow_set(cache->table, key, key_len, &_rowlock);
+    if (row)
+    {
+        swTableRow_set_value(row, cache->col_data, buf, len);
+        swTableRow_set_value(row, cache->col_expire, &expire, sizeof(expire));
+    }
+    swTableRow_unlock(_rowlock);
+    //the session is not referenced by the cache
+    return 0;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+static SSL_SESSION* swSSL_get_session(SSL *ssl, const uchar *id, int id_len, int *copy)
+#else
+static SSL_SESSION* swSSL_get_session(SSL *ssl, uchar *id, int id_len, int *copy)
+#endif
+{
+    swSSL_session_cache *cache = swSSL_get_session_cache(SSL_get_SSL_CTX(ssl));
+    uchar buf[SW_SSL_SESSION_MAX_SIZE];
+    char key[SW_TABLE_KEY_SIZE];
+    swTableRow *_rowlock = NULL;
+    swTable_string_length_t len = 0;
+    int64_t expire = 0;
+
+    *copy = 0;
+    int key_len = swSSL_session_key(id, id_len, key);
+    swTableRow *row = swTableRow_get(cache->table, key, key_len, &_rowlock);
+    if (row)
+    {
+        memcpy(&expire, row->data + cache->col_expire->index, sizeof(expire));
+        memcpy(&len, row->data + cache->col_data->index, sizeof(len));
+        memcpy(buf, row->data + cache->col_data->index + sizeof(len), len);
+    }
+    swTableRow_unlock(_rowlock);
+
+    if (row == NULL)
+    {
+        return NULL;
+    }
+    if (expire < time(NULL))
+    {
+        swTableRow_del(cache->table, key, key_len);
+        return NULL;
+    }
+    const uchar *p = buf;
+    return d2i_SSL_SESSION(NULL, &p, len);
+}
+
+static void swSSL_remove_session(SSL_CTX *ssl_context, SSL_SESSION *session)
+{
+    swSSL_session_cache *cache = swSSL_get_session_cache(ssl_context);
+    char key[SW_TABLE_KEY_SIZE];
+    uint32_t id_len;
+
+    const uchar *id = SSL_SESSION_get_id(session, &id_len);
+    swTableRow_del(cache->table, key, swSSL_session_key(id, id_len, key));
+}
+
+static void swSSL_rotate_ticket_key(swSSL_ticket_keys *keys, uint32_t index, time_t now)
+{
+    if (RAND_bytes((uchar *) &keys->keys[index], sizeof(keys->keys[index])) != 1)
+    {
+        swWarn("RAND_bytes() failed.");
+        return;
+    }
+    keys->current = index;
+    keys->rotated = now;
+}
+
+/**
+ * one key is generated for each elapsed interval, so the keys older than SW_SSL_TICKET_KEY_NUM intervals are dropped
+ */
+static sw_inline void swSSL_check_ticket_keys(swSSL_ticket_keys *keys, uint32_t rotate, time_t now)
+{
+    time_t n = (now - keys->rotated) / rotate;
+    if (n > SW_SSL_TICKET_KEY_NUM)
+    {
+        n = SW_SSL_TICKET_KEY_NUM;
+    }
+    for (; n > 0; n--)
+    {
+        swSSL_rotate_ticket_key(keys, (keys->current + 1) % SW_SSL_TICKET_KEY_NUM, now);
+    }
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#define swSSL_ticket_hmac_ctx_t     EVP_MAC_CTX
+static sw_inline int swSSL_ticket_hmac_init(EVP_MAC_CTX *hctx, uchar *key)
+{
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char *) "SHA256", 0),
+        OSSL_PARAM_construct_end()
+    };
+    return EVP_MAC_init(hctx, key, 32, params);
+}
+#else
+#define swSSL_ticket_hmac_ctx_t     HMAC_CTX
+static sw_inline int swSSL_ticket_hmac_init(HMAC_CTX *hctx, uchar *key)
+{
+    return HMAC_Init_ex(hctx, key, 32, EVP_sha256(), NULL);
+}
+#endif
+
+/**
+ * RFC 5077, the keys are shared by all the processes, so any worker can decrypt the tickets of the others
+ */
+static int swSSL_ticket_key_callback(SSL *ssl, uchar *name, uchar *iv, EVP_CIPHER_CTX *ectx, swSSL_ticket_hmac_ctx_t *hctx, int enc)
+{
+    swSSL_session_cache *cache = swSSL_get_session_cache(SSL_get_SSL_CTX(ssl));
+    swSSL_ticket_keys *keys = cache->ticket_keys;
+    uchar aes_key[32], hmac_key[32];
+    uint32_t i, current;
+    time_t now = time(NULL);
+
+    if (enc)
+    {
+        if (RAND_bytes(iv, EVP_MAX_IV_LENGTH) != 1)
+        {
+            return -1;
+        }
+        sw_spinlock(&keys->lock);
+        swSSL_check_ticket_keys(keys, cache->ticket_key_rotate, now);
+        current = keys->current;
+        memcpy(name, keys->keys[current].name, 16);
+        memcpy(aes_key, keys->keys[current].aes_key, 32);
+        memcpy(hmac_key, keys->keys[current].hmac_key, 32);
+        sw_spinlock_release(&keys->lock);
+
+        if (EVP_EncryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, aes_key, iv) != 1
+                || swSSL_ticket_hmac_init(hctx, hmac_key) != 1)
+        {
+            return -1;
+        }
+        return 1;
+    }
+
+    sw_spinlock(&keys->lock);
+    swSSL_check_ticket_keys(keys, cache->ticket_key_rotate, now);
+    current = keys->current;
+    for (i = 0; i < SW_SSL_TICKET_KEY_NUM; i++)
+    {
+        if (memcmp(name, keys->keys[i].name, 16) == 0)
+        {
+            memcpy(aes_key, keys->keys[i].aes_key, 32);
+            memcpy(hmac_key, keys->keys[i].hmac_key, 32);
+            break;
+        }
+    }
+    sw_spinlock_release(&keys->lock);
+
+    if (i == SW_SSL_TICKET_KEY_NUM)
+    {
+        //unknown key, a full handshake is required
+        return 0;
+    }
+    if (swSSL_ticket_hmac_init(hctx, hmac_key) != 1
+            || EVP_DecryptInit_ex(ectx, EVP_aes_256_cbc(), NULL, aes_key, iv) != 1)
+    {
+        return -1;
+    }
+    //renew the ticket with the current key
+    return i == current ? 1 : 2;
+}
+
+/**
+ * [Master] called before the workers are forked, so the cache and the ticket keys are in shared memory
+ */
+int swSSL_server_set_session_cache(SSL_CTX* ssl_context, swSSL_config *cfg)
+{
+    int i;
+
+    if (cfg->session_cache_size == 0 && !cfg->session_tickets)
+    {
+        return SW_OK;
+    }
+    if (swSSL_session_cache_index < 0)
+    {
+        swSSL_session_cache_index = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL, NULL);
+    }
+
+    swSSL_session_cache *cache = sw_calloc(1, sizeof(swSSL_session_cache));
+    if (cache == NULL)
+    {
+        swWarn("malloc(%ld) failed.", sizeof(swSSL_session_cache));
+        return SW_ERR;
+    }
+    SSL_CTX_set_ex_data(ssl_context, swSSL_session_cache_index, cache);
+    SSL_CTX_set_timeout(ssl_context, cfg->session_timeout);
+    //the resumption must not be shared with the contexts of the other ports
+    SSL_CTX_set_session_id_context(ssl_context, (const uchar *) &ssl_context, sizeof(ssl_context));
+#ifdef SSL_OP_IGNORE_UNEXPECTED_EOF
+    //OpenSSL 3.0 removes the session from the cache when the client closes without close_notify
+    SSL_CTX_set_options(ssl_context, SSL_OP_IGNORE_UNEXPECTED_EOF);
+#endif
+
+    if (cfg->session_cache_size > 0)
+    {
+        cache->table = swTable_new(cfg->session_cache_size, 1);
+        if (cache->table == NULL)
+        {
+            return SW_ERR;
+        }
+        swTableColumn_add(cache->table, SW_STRL("data"), SW_TABLE_STRING, SW_SSL_SESSION_MAX_SIZE);
+        swTableColumn_add(cache->table, SW_STRL("expire"), SW_TABLE_INT, 8);
+        if (swTable_create(cache->table) < 0)
+        {
+            swWarn("create the session cache of %d sessions failed.", cfg->session_cache_size);
+            return SW_ERR;
+        }
+        cache->col_data = swTableColumn_get(cache->table, SW_STRL("data"));
+        cache->col_expire = swTableColumn_get(cache->table, SW_STRL("expire"));
+
+        SSL_CTX_set_session_cache_mode(ssl_context, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(ssl_context, swSSL_new_session);
+        SSL_CTX_sess_set_get_cb(ssl_context, swSSL_get_session);
+        SSL_CTX_sess_set_remove_cb(ssl_context, swSSL_remove_session);
+    }
+
+    if (cfg->session_tickets)
+    {
+        cache->ticket_keys = sw_shm_calloc(1, sizeof(swSSL_ticket_keys));
+        if (cache->ticket_keys == NULL)
+        {
+            return SW_ERR;
+        }
+        cache->ticket_key_rotate = cfg->ticket_key_rotate > 0 ? cfg->ticket_key_rotate : SW_SSL_TICKET_KEY_ROTATE;
+        //the unused slots must not hold the zeroed keys
+        for (i = 0; i < SW_SSL_TICKET_KEY_NUM; i++)
+        {
+            swSSL_rotate_ticket_key(cache->ticket_keys, i, time(NULL));
+        }
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+        SSL_CTX_set_tlsext_ticket_key_evp_cb(ssl_context, swSSL_ticket_key_callback);
+#else
+        SSL_CTX_set_tlsext_ticket_key_cb(ssl_context, swSSL_ticket_key_callback);
+#endif
+    }
+    else
+    {
+        //the tickets encrypted with the keys of one worker can not be decrypted by the others
+        SSL_CTX_set_options(ssl_context, SSL_OP_NO_TICKET);
+    }
+    return SW_OK;
+}
+
+#ifdef SSL_CLIENT_HELLO_SUCCESS
+/**
+ * a ticket, a pre-shared key, or the session id of a client without TLS 1.3,
+ * whose clients send a random session id for the middlebox compatibility
+ */
+static int swSSL_client_hello_resumption(SSL *ssl)
+{
+    const uchar *data;
+    size_t length;
+
+    if (SSL_client_hello_get0_ext(ssl, TLSEXT_TYPE_psk, &data, &length))
+    {
+        return 1;
+    }
+    if (SSL_client_hello_get0_ext(ssl, TLSEXT_TYPE_session_ticket, &data, &length) && length > 0)
+    {
+        return 1;
+    }
+    return SSL_client_hello_get0_session_id(ssl, &data) > 0
+            && !SSL_client_hello_get0_ext(ssl, TLSEXT_TYPE_supported_versions, &data, &length);
+}
+
+static int swSSL_client_hello_callback(SSL *ssl, int *al, void *arg)
+{
+    if (SwooleTG.type != SW_THREAD_REACTOR || SwooleTG.ssl_handshake_inline || swSSL_client_hello_resumption(ssl))
+    {
+        return SSL_CLIENT_HELLO_SUCCESS;
+    }
+    return SSL_CLIENT_HELLO_RETRY;
+}
+#endif
+
+/**
+ * the reactor threads stop at the ClientHello of a full handshake, swSSL_accept() returns SW_CONTINUE
+ */
+void swSSL_server_defer_full_handshake(SSL_CTX* ssl_context)
+{
+#ifdef SSL_CLIENT_HELLO_SUCCESS
+    SSL_CTX_set_client_hello_cb(ssl_context, swSSL_client_hello_callback, NULL);
+#endif
+}
+
 static int swSSL_passwd_callback(char *buf, int num, int verify, void *data)
 {
     swSSL_option *option = (swSSL_option *) data;
@@ -298,6 +662,15 @@ SSL_CTX* swSSL_get_context(swSSL_option *option)
     SSL_CTX_set_options(ssl_context, SSL_OP_DONT_INSERT_EMPTY_FRAGMENTS);
     SSL_CTX_set_options(ssl_context, SSL_OP_SINGLE_DH_USE);
 
+    if (option->ktls)
+    {
+#ifdef SW_SSL_HAVE_KTLS
+        SSL_CTX_set_options(ssl_context, SSL_OP_ENABLE_KTLS);
+#else
+        swWarn("kernel TLS is not supported by this OpenSSL build.");
+#endif
+    }
+
     if (option->passphrase)
     {
         SSL_CTX_set_default_passwd_cb_userdata(ssl_context, option);
@@ -652,6 +1025,18 @@ int swSSL_get_client_certificate(SSL *ssl, char *buffer, size_t length)
     return SW_ERR;
 }
 
+/**
+ * after the handshake, OpenSSL keeps the records in user space when the kernel module or the cipher is not supported
+ */
+static sw_inline void swSSL_check_ktls(swConnection *conn)
+{
+#ifdef SW_SSL_HAVE_KTLS
+    conn->ssl_ktls_send = BIO_get_ktls_send(SSL_get_wbio(conn->ssl)) ? 1 : 0;
+    conn->ssl_ktls_recv = BIO_get_ktls_recv(SSL_get_rbio(conn->ssl)) ? 1 : 0;
+    swTraceLog(SW_TRACE_SSL, "fd=%d, ktls_send=%d, ktls_recv=%d", conn->fd, conn->ssl_ktls_send, conn->ssl_ktls_recv);
+#endif
+}
+
 int swSSL_accept(swConnection *conn)
 {
     swSSL_clear_error(conn);
@@ -663,6 +1048,7 @@ int swSSL_accept(swConnection *conn)
     if (n == 1)
     {
         conn->ssl_state = SW_SSL_STATE_READY;
+        swSSL_check_ktls(conn);
 #if OPENSSL_VERSION_NUMBER < 0x10100000L
 #ifdef SSL3_FLAGS_NO_RENEGOTIATE_CIPHERS
         if (conn->ssl->s3)
@@ -694,14 +1080,20 @@ int swSSL_accept(swConnection *conn)
         conn->ssl_want_write = 1;
         return SW_WAIT;
     }
+#ifdef SSL_ERROR_WANT_CLIENT_HELLO_CB
+    else if (err == SSL_ERROR_WANT_CLIENT_HELLO_CB)
+    {
+        return SW_CONTINUE;
+    }
+#endif
     else if (err == SSL_ERROR_SSL)
     {
         int reason = ERR_GET_REASON(ERR_peek_error());
         swWarn("bad SSL client[%s:%d], reason=%d.", swConnection_get_ip(conn), swConnection_get_port(conn), reason);
         return SW_ERROR;
     }
-    //EOF was observed
-    else if (err == SSL_ERROR_SYSCALL && n == 0)
+    //EOF was observed, reported as SSL_ERROR_ZERO_RETURN with SSL_OP_IGNORE_UNEXPECTED_EOF
+    else if ((err == SSL_ERROR_SYSCALL && n == 0) || err == SSL_ERROR_ZERO_RETURN)
     {
         return SW_ERROR;
     }
@@ -717,6 +1109,7 @@ int swSSL_connect(swConnection *conn)
     if (n == 1)
     {
         conn->ssl_state = SW_SSL_STATE_READY;
+        swSSL_check_ktls(conn);
 
 #ifdef SW_LOG_TRACE_OPEN
         const char *ssl_version = SSL_get_version(conn->ssl);
@@ -762,6 +1155,26 @@ int swSSL_connect(swConnection *conn)
 
 int swSSL_sendfile(swConnection *conn, int fd, off_t *offset, size_t size)
 {
+#ifdef SW_SSL_HAVE_KTLS
+    //the file is encrypted in the kernel, without the copy to user space
+    if (conn->ssl_ktls_send)
+    {
+        swSSL_clear_error(conn);
+        ossl_ssize_t n = SSL_sendfile(conn->ssl, fd, *offset, size, 0);
+        if (n > 0)
+        {
+            *offset += n;
+            return n;
+        }
+        if (SSL_get_error(conn->ssl, n) == SSL_ERROR_WANT_WRITE)
+        {
+            conn->ssl_want_write = 1;
+            errno = EAGAIN;
+        }
+        return SW_ERR;
+    }
+#endif
+
     char buf[SW_BUFFER_SIZE_BIG];
     int readn = size > sizeof(buf) ? sizeof(buf) : size;
 
@@ -37,7 +37,14 @@ int swReactor_create(swReactor *reactor, int max_event)
     int ret;
     bzero(reactor, sizeof(swReactor));
 
-#ifdef HAVE_EPOLL
+#if defined(SW_USE_IOURING) && defined(HAVE_EPOLL)
+    //fallback to epoll if the running kernel does not support io_uring
+    ret = swReactorUring_create(reactor, max_event);
+    if (ret < 0)
+    {
+        ret = swReactorEpoll_create(reactor, max_event);
+    }
+#elif defined(HAVE_EPOLL)
     ret = swReactorEpoll_create(reactor, max_event);
 #elif defined(HAVE_KQUEUE)
     ret = swReactorKqueue_create(reactor, max_event);
@@ -215,6 +222,15 @@ int swReactor_close(swReactor *reactor, int fd)
     {
         swBuffer_free(socket->in_buffer);
     }
+#ifdef HAVE_ZEROCOPY
+    /**
+     * the pages of the chunks are held by the kernel until they are acked, only the mappings are removed.
+     */
+    if (socket->zerocopy_buffer)
+    {
+        swBuffer_free(socket->zerocopy_buffer);
+    }
+#endif
     if (socket->websocket_buffer)
     {
         swString_free(socket->websocket_buffer);
@@ -288,6 +304,10 @@ int swReactor_write(swReactor *reactor, int fd, void *buf, int n)
                     return SW_ERR;
                 }
                 socket->out_buffer = buffer;
+
+                int sock_type;
+                socklen_t len = sizeof(sock_type);
+                socket->dgram = getsockopt(fd, SOL_SOCKET, SO_TYPE, &sock_type, &len) == 0 && sock_type == SOCK_DGRAM;
             }
 
             socket->events |= SW_EVENT_WRITE;
@@ -0,0 +1,734 @@
+/*
+ +----------------------------------------------------------------------+
+ | Swoole                                                               |
+ +----------------------------------------------------------------------+
+ | This source file is subject to version 2.0 of the Apache license,    |
+ | that is bundled with this package in the file LICENSE, and is        |
+ | available through the world-wide-web at the following url:           |
+ | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+ | If you did not receive a copy of the Apache2.0 license and are unable|
+ | to obtain it through the world-wide-web, please send a note to       |
+ | license@swoole.com so we can mail you a copy immediately.            |
+ +----------------------------------------------------------------------+
+ | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+ +----------------------------------------------------------------------+
+ */
+
+#include "swoole.h"
+
+#ifdef SW_USE_IOURING
+#include <poll.h>
+#include <endian.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/time_types.h>
+#include <linux/io_uring.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup              425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter              426
+#endif
+
+#ifndef POLLRDHUP
+#define POLLRDHUP                        0x2000
+#endif
+
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI            (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE                (1U << 1)
+#endif
+#ifndef IORING_FEAT_RSRC_TAGS
+#define IORING_FEAT_RSRC_TAGS            (1U << 10)
+#endif
+
+/**
+ * user_data layout: [fdtype:8][generation:24][fd:32]
+ */
+#define SW_IOURING_UD_IGNORE             UINT64_MAX
+#define SW_IOURING_GEN_MASK              0xffffff
+
+typedef struct
+{
+    uint32_t generation;
+    uint8_t armed;
+    uint8_t checking;
+    uint8_t fdtype;
+} swReactorUring_fd;
+
+typedef struct
+{
+    int ring_fd;
+
+    void *sq_ring;
+    size_t sq_ring_size;
+    uint32_t *sq_head;
+    uint32_t *sq_tail;
+    uint32_t *sq_array;
+    uint32_t sq_mask;
+    uint32_t sq_entries;
+    uint32_t sq_local_tail;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+
+    void *cq_ring;
+    size_t cq_ring_size;
+    uint32_t *cq_head;
+    uint32_t *cq_tail;
+    uint32_t cq_mask;
+    struct io_uring_cqe *cqes;
+
+    swReactorUring_fd *fds;
+    uint32_t fds_size;
+
+    struct io_uring_cqe *events;
+
+    //fds handled in this round whose multishot poll is still armed, checked again with poll()
+    struct pollfd *check_fds;
+    uint64_t *check_user_data;
+    //events found by the check, dispatched in the next round before the CQ ring
+    struct io_uring_cqe *pending;
+    int pending_num;
+} swReactorUring;
+
+static int swReactorUring_add(swReactor *reactor, int fd, int fdtype);
+static int swReactorUring_set(swReactor *reactor, int fd, int fdtype);
+static int swReactorUring_del(swReactor *reactor, int fd);
+static int swReactorUring_wait(swReactor *reactor, struct timeval *timeo);
+static void swReactorUring_free(swReactor *reactor);
+
+static sw_inline int swReactorUring_setup(int entries, struct io_uring_params *p)
+{
+    return (int) syscall(__NR_io_uring_setup, entries, p);
+}
+
+static sw_inline int swReactorUring_enter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags, void *arg, size_t argsz)
+{
+    return (int) syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static sw_inline uint32_t swReactorUring_events(int fdtype)
+{
+    uint32_t flag = 0;
+    if (swReactor_event_read(fdtype))
+    {
+        flag |= POLLIN;
+    }
+    if (swReactor_event_write(fdtype))
+    {
+        flag |= POLLOUT;
+    }
+    if (swReactor_event_error(fdtype))
+    {
+        flag |= (POLLRDHUP | POLLHUP | POLLERR);
+    }
+    return flag;
+}
+
+static sw_inline uint32_t swReactorUring_event_set(int fdtype)
+{
+    uint32_t flag = swReactorUring_events(fdtype);
+#if __BYTE_ORDER == __BIG_ENDIAN
+    flag = (flag << 16) | (flag >> 16);
+#endif
+    return flag;
+}
+
+static sw_inline uint64_t swReactorUring_user_data(int fd, swReactorUring_fd *entry)
+{
+    return ((uint64_t) entry->fdtype << 56) | ((uint64_t) (entry->generation & SW_IOURING_GEN_MASK) << 32) | (uint32_t) fd;
+}
+
+static swReactorUring_fd* swReactorUring_get_fd(swReactorUring *object, int fd)
+{
+    if ((uint32_t) fd >= object->fds_size)
+    {
+        uint32_t size = object->fds_size;
+        while (size <= (uint32_t) fd)
+        {
+            size *= 2;
+        }
+        swReactorUring_fd *fds = sw_realloc(object->fds, size * sizeof(swReactorUring_fd));
+        if (fds == NULL)
+        {
+            swWarn("realloc(%ld) failed.", (long) (size * sizeof(swReactorUring_fd)));
+            return NULL;
+        }
+        bzero(fds + object->fds_size, (size - object->fds_size) * sizeof(swReactorUring_fd));
+        object->fds = fds;
+        object->fds_size = size;
+    }
+    return &object->fds[fd];
+}
+
+/**
+ * submit everything queued so far without waiting, only used when the SQ ring is full
+ */
+static int swReactorUring_flush(swReactorUring *object)
+{
+    uint32_t to_submit = object->sq_local_tail - __atomic_load_n(object->sq_head, __ATOMIC_ACQUIRE);
+    while (to_submit > 0)
+    {
+        int ret = swReactorUring_enter(object->ring_fd, to_submit, 0, 0, NULL, 0);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            swSysError("io_uring_enter(%u) failed.", to_submit);
+            return SW_ERR;
+        }
+        to_submit -= ret;
+    }
+    return SW_OK;
+}
+
+static struct io_uring_sqe* swReactorUring_get_sqe(swReactorUring *object)
+{
+    if (object->sq_local_tail - __atomic_load_n(object->sq_head, __ATOMIC_ACQUIRE) >= object->sq_entries)
+    {
+        if (swReactorUring_flush(object) < 0)
+        {
+            return NULL;
+        }
+    }
+    uint32_t index = object->sq_local_tail & object->sq_mask;
+    struct io_uring_sqe *sqe = &object->sqes[index];
+    bzero(sqe, sizeof(*sqe));
+    object->sq_array[index] = index;
+    return sqe;
+}
+
+static sw_inline void swReactorUring_commit_sqe(swReactorUring *object)
+{
+    object->sq_local_tail++;
+    __atomic_store_n(object->sq_tail, object->sq_local_tail, __ATOMIC_RELEASE);
+}
+
+/**
+ * arm a multishot poll for fd, it stays armed until a CQE arrives without IORING_CQE_F_MORE.
+ * SW_EVENT_ONCE fds get a one-shot poll, there is nothing to cancel after their event.
+ */
+static int swReactorUring_poll_add(swReactorUring *object, int fd, int fdtype)
+{
+    swReactorUring_fd *entry = swReactorUring_get_fd(object, fd);
+    if (entry == NULL)
+    {
+        return SW_ERR;
+    }
+    struct io_uring_sqe *sqe = swReactorUring_get_sqe(object);
+    if (sqe == NULL)
+    {
+        return SW_ERR;
+    }
+    entry = &object->fds[fd];
+    entry->fdtype = swReactor_fdtype(fdtype);
+    entry->armed = 1;
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = swReactorUring_event_set(fdtype);
+    sqe->len = (fdtype & SW_EVENT_ONCE) ? 0 : IORING_POLL_ADD_MULTI;
+    sqe->user_data = swReactorUring_user_data(fd, entry);
+    swReactorUring_commit_sqe(object);
+
+    return SW_OK;
+}
+
+/**
+ * cancel the armed poll of fd and bump its generation,
+ * so that the completions already sitting in the CQ ring are dropped
+ */
+static int swReactorUring_poll_remove(swReactorUring *object, int fd)
+{
+    swReactorUring_fd *entry = swReactorUring_get_fd(object, fd);
+    if (entry == NULL)
+    {
+        return SW_ERR;
+    }
+    if (entry->armed)
+    {
+        struct io_uring_sqe *sqe = swReactorUring_get_sqe(object);
+        if (sqe == NULL)
+        {
+            return SW_ERR;
+        }
+        entry = &object->fds[fd];
+        sqe->opcode = IORING_OP_POLL_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = swReactorUring_user_data(fd, entry);
+        sqe->user_data = SW_IOURING_UD_IGNORE;
+        swReactorUring_commit_sqe(object);
+        entry->armed = 0;
+    }
+    entry->generation++;
+    return SW_OK;
+}
+
+int swReactorUring_create(swReactor *reactor, int max_event_num)
+{
+    struct io_uring_params params;
+    int entries = SW_MIN(max_event_num, SW_REACTOR_IOURING_ENTRIES);
+
+    //create reactor object
+    swReactorUring *object = sw_malloc(sizeof(swReactorUring));
+    if (object == NULL)
+    {
+        swWarn("malloc[0] failed.");
+        return SW_ERR;
+    }
+    bzero(object, sizeof(swReactorUring));
+
+    bzero(&params, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = entries * 2;
+
+    object->ring_fd = swReactorUring_setup(entries, &params);
+    if (object->ring_fd < 0)
+    {
+        swTraceLog(SW_TRACE_REACTOR, "io_uring_setup(%d) failed. Error: %s[%d]", entries, strerror(errno), errno);
+        sw_free(object);
+        return SW_ERR;
+    }
+    /**
+     * EXT_ARG (linux-5.11) is required to pass the timeout to io_uring_enter,
+     * multishot poll came with linux-5.13, RSRC_TAGS is the feature flag of the same release
+     */
+    if (!(params.features & IORING_FEAT_EXT_ARG) || !(params.features & IORING_FEAT_NODROP)
+            || !(params.features & IORING_FEAT_RSRC_TAGS))
+    {
+        swTraceLog(SW_TRACE_REACTOR, "io_uring features[%u] is not supported.", params.features);
+        close(object->ring_fd);
+        sw_free(object);
+        return SW_ERR;
+    }
+
+    object->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    object->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        object->sq_ring_size = object->cq_ring_size = SW_MAX(object->sq_ring_size, object->cq_ring_size);
+    }
+    object->sq_ring = mmap(NULL, object->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+            object->ring_fd, IORING_OFF_SQ_RING);
+    if (object->sq_ring == MAP_FAILED)
+    {
+        swSysError("mmap(IORING_OFF_SQ_RING) failed.");
+        goto _fail_ring;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        object->cq_ring = object->sq_ring;
+    }
+    else
+    {
+        object->cq_ring = mmap(NULL, object->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                object->ring_fd, IORING_OFF_CQ_RING);
+        if (object->cq_ring == MAP_FAILED)
+        {
+            swSysError("mmap(IORING_OFF_CQ_RING) failed.");
+            goto _fail_sq_ring;
+        }
+    }
+    object->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    object->sqes = mmap(NULL, object->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, object->ring_fd,
+            IORING_OFF_SQES);
+    if (object->sqes == MAP_FAILED)
+    {
+        swSysError("mmap(IORING_OFF_SQES) failed.");
+        goto _fail_cq_ring;
+    }
+
+    object->sq_head = (uint32_t *) ((char *) object->sq_ring + params.sq_off.head);
+    object->sq_tail = (uint32_t *) ((char *) object->sq_ring + params.sq_off.tail);
+    object->sq_array = (uint32_t *) ((char *) object->sq_ring + params.sq_off.array);
+    object->sq_mask = *(uint32_t *) ((char *) object->sq_ring + params.sq_off.ring_mask);
+    object->sq_entries = params.sq_entries;
+    object->sq_local_tail = *object->sq_tail;
+
+    object->cq_head = (uint32_t *) ((char *) object->cq_ring + params.cq_off.head);
+    object->cq_tail = (uint32_t *) ((char *) object->cq_ring + params.cq_off.tail);
+    object->cq_mask = *(uint32_t *) ((char *) object->cq_ring + params.cq_off.ring_mask);
+    object->cqes = (struct io_uring_cqe *) ((char *) object->cq_ring + params.cq_off.cqes);
+
+    object->fds_size = 1024;
+    object->fds = sw_calloc(object->fds_size, sizeof(swReactorUring_fd));
+    object->events = sw_calloc(max_event_num, sizeof(struct io_uring_cqe));
+    object->check_fds = sw_calloc(max_event_num, sizeof(struct pollfd));
+    object->check_user_data = sw_calloc(max_event_num, sizeof(uint64_t));
+    object->pending = sw_calloc(max_event_num, sizeof(struct io_uring_cqe));
+    if (object->fds == NULL || object->events == NULL || object->check_fds == NULL || object->check_user_data == NULL
+            || object->pending == NULL)
+    {
+        swWarn("malloc[1] failed.");
+        sw_free(object->fds);
+        sw_free(object->events);
+        sw_free(object->check_fds);
+        sw_free(object->check_user_data);
+        sw_free(object->pending);
+        munmap(object->sqes, object->sqes_size);
+        goto _fail_cq_ring;
+    }
+
+    reactor->object = object;
+    reactor->max_event_num = max_event_num;
+
+    //binding method
+    reactor->add = swReactorUring_add;
+    reactor->set = swReactorUring_set;
+    reactor->del = swReactorUring_del;
+    reactor->wait = swReactorUring_wait;
+    reactor->free = swReactorUring_free;
+
+    return SW_OK;
+
+    _fail_cq_ring:
+    if (object->cq_ring != object->sq_ring)
+    {
+        munmap(object->cq_ring, object->cq_ring_size);
+    }
+    _fail_sq_ring:
+    munmap(object->sq_ring, object->sq_ring_size);
+    _fail_ring:
+    close(object->ring_fd);
+    sw_free(object);
+    return SW_ERR;
+}
+
+static void swReactorUring_free(swReactor *reactor)
+{
+    swReactorUring *object = reactor->object;
+    munmap(object->sqes, object->sqes_size);
+    if (object->cq_ring != object->sq_ring)
+    {
+        munmap(object->cq_ring, object->cq_ring_size);
+    }
+    munmap(object->sq_ring, object->sq_ring_size);
+    close(object->ring_fd);
+    sw_free(object->fds);
+    sw_free(object->events);
+    sw_free(object->check_fds);
+    sw_free(object->check_user_data);
+    sw_free(object->pending);
+    sw_free(object);
+}
+
+static int swReactorUring_add(swReactor *reactor, int fd, int fdtype)
+{
+    swReactorUring *object = reactor->object;
+
+    swReactor_add(reactor, fd, fdtype);
+
+    if (swReactorUring_poll_remove(object, fd) < 0 || swReactorUring_poll_add(object, fd, fdtype) < 0)
+    {
+        swWarn("add events[fd=%d#%d, type=%d, events=%d] failed.", fd, reactor->id, swReactor_fdtype(fdtype),
+                swReactor_events(fdtype));
+        swReactor_del(reactor, fd);
+        return SW_ERR;
+    }
+
+    swTraceLog(SW_TRACE_EVENT, "add event[reactor_id=%d, fd=%d, events=%d]", reactor->id, fd, swReactor_events(fdtype));
+    reactor->event_num++;
+
+    return SW_OK;
+}
+
+static int swReactorUring_del(swReactor *reactor, int fd)
+{
+    swReactorUring *object = reactor->object;
+    if (swReactorUring_poll_remove(object, fd) < 0)
+    {
+        swWarn("io_uring remove fd[%d#%d] failed.", fd, reactor->id);
+        return SW_ERR;
+    }
+
+    swTraceLog(SW_TRACE_REACTOR, "remove event[reactor_id=%d|fd=%d]", reactor->id, fd);
+    reactor->event_num = reactor->event_num <= 0 ? 0 : reactor->event_num - 1;
+    swReactor_del(reactor, fd);
+
+    return SW_OK;
+}
+
+static int swReactorUring_set(swReactor *reactor, int fd, int fdtype)
+{
+    swReactorUring *object = reactor->object;
+
+    if (swReactor_event_write(fdtype))
+    {
+        assert(fd > 2);
+    }
+
+    if (swReactorUring_poll_remove(object, fd) < 0 || swReactorUring_poll_add(object, fd, fdtype) < 0)
+    {
+        swWarn("reactor#%d->set(fd=%d|type=%d|events=%d) failed.", reactor->id, fd, swReactor_fdtype(fdtype),
+                swReactor_events(fdtype));
+        return SW_ERR;
+    }
+    swTraceLog(SW_TRACE_EVENT, "set event[reactor_id=%d, fd=%d, events=%d]", reactor->id, fd, swReactor_events(fdtype));
+    //execute parent method
+    swReactor_set(reactor, fd, fdtype);
+    return SW_OK;
+}
+
+/**
+ * submit all queued SQEs and wait for completions with a single io_uring_enter,
+ * then copy the pending events and the ready CQEs out so that handlers may queue new SQEs freely
+ */
+static int swReactorUring_submit_and_wait(swReactor *reactor, swReactorUring *object)
+{
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    int msec = swReactor_get_timeout_msec(reactor);
+    uint32_t to_submit = object->sq_local_tail - __atomic_load_n(object->sq_head, __ATOMIC_ACQUIRE);
+    uint32_t head, tail;
+    int n = object->pending_num;
+
+    if (n > 0)
+    {
+        memcpy(object->events, object->pending, n * sizeof(struct io_uring_cqe));
+        object->pending_num = 0;
+    }
+
+    bzero(&arg, sizeof(arg));
+    if (msec >= 0)
+    {
+        ts.tv_sec = msec / 1000;
+        ts.tv_nsec = (msec % 1000) * 1000 * 1000;
+        arg.ts = (uint64_t) (uintptr_t) &ts;
+    }
+
+    head = *object->cq_head;
+    tail = __atomic_load_n(object->cq_tail, __ATOMIC_ACQUIRE);
+    if ((head == tail && n == 0) || to_submit > 0)
+    {
+        uint32_t min_complete = (head == tail && n == 0) ? 1 : 0;
+        if (swReactorUring_enter(object->ring_fd, to_submit, min_complete, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                &arg, sizeof(arg)) < 0 && errno != ETIME)
+        {
+            return SW_ERR;
+        }
+        tail = __atomic_load_n(object->cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    while (head != tail && n < reactor->max_event_num)
+    {
+        object->events[n++] = object->cqes[head & object->cq_mask];
+        head++;
+    }
+    __atomic_store_n(object->cq_head, head, __ATOMIC_RELEASE);
+
+    return n;
+}
+
+/**
+ * multishot poll is edge-triggered and IORING_POLL_ADD_LEVEL can not be combined with it,
+ * but the handlers expect level-triggered events: accept stops after SW_ACCEPT_MAX_COUNT,
+ * a pipe read takes one message. The fds handled in this round are checked again with
+ * a single poll() and the ones still ready are dispatched in the next round.
+ */
+static void swReactorUring_check(swReactorUring *object, int num)
+{
+    int i, n;
+
+    do
+    {
+        n = poll(object->check_fds, num, 0);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0)
+    {
+        swSysError("poll(%d) failed.", num);
+        n = 0;
+    }
+    for (i = 0; i < num; i++)
+    {
+        object->fds[object->check_fds[i].fd].checking = 0;
+        //POLLNVAL has no handler
+        uint32_t revents = object->check_fds[i].revents & (object->check_fds[i].events | POLLERR | POLLHUP);
+        if (n == 0 || revents == 0)
+        {
+            continue;
+        }
+        struct io_uring_cqe *cqe = &object->pending[object->pending_num++];
+        cqe->user_data = object->check_user_data[i];
+        cqe->res = revents;
+        cqe->flags = IORING_CQE_F_MORE;
+    }
+}
+
+static int swReactorUring_wait(swReactor *reactor, struct timeval *timeo)
+{
+    swEvent event;
+    swReactorUring *object = reactor->object;
+    swReactorUring_fd *entry;
+    swReactor_handle handle;
+    int i, n, ret, check_num;
+    uint32_t revents;
+    uint32_t generation;
+    uint64_t user_data;
+
+    int reactor_id = reactor->id;
+    struct io_uring_cqe *events = object->events;
+
+    if (reactor->timeout_msec == 0)
+    {
+        if (timeo == NULL)
+        {
+            reactor->timeout_msec = -1;
+        }
+        else
+        {
+            reactor->timeout_msec = timeo->tv_sec * 1000 + timeo->tv_usec / 1000;
+        }
+    }
+
+    swReactor_before_wait(reactor);
+
+    while (reactor->running > 0)
+    {
+        if (reactor->onBegin != NULL)
+        {
+            reactor->onBegin(reactor);
+        }
+        n = swReactorUring_submit_and_wait(reactor, object);
+        if (n < 0)
+        {
+            if (swReactor_error(reactor) < 0)
+            {
+                swWarn("[Reactor#%d] io_uring_enter failed. Error: %s[%d]", reactor_id, strerror(errno), errno);
+                return SW_ERR;
+            }
+            else
+            {
+                continue;
+            }
+        }
+        else if (n == 0)
+        {
+            if (reactor->onTimeout != NULL)
+            {
+                reactor->onTimeout(reactor);
+            }
+            SW_REACTOR_CONTINUE;
+        }
+        check_num = 0;
+        for (i = 0; i < n; i++)
+        {
+            user_data = events[i].user_data;
+            if (user_data == SW_IOURING_UD_IGNORE)
+            {
+                continue;
+            }
+            event.fd = (uint32_t) user_data;
+            event.from_id = reactor_id;
+            event.type = user_data >> 56;
+
+            //stale completion of a removed or re-armed poll
+            entry = &object->fds[event.fd];
+            if (!entry->armed || (entry->generation & SW_IOURING_GEN_MASK) != ((user_data >> 32) & SW_IOURING_GEN_MASK))
+            {
+                continue;
+            }
+            if (!(events[i].flags & IORING_CQE_F_MORE))
+            {
+                entry->armed = 0;
+            }
+            generation = entry->generation;
+            if (events[i].res < 0)
+            {
+                if (events[i].res != -ECANCELED)
+                {
+                    swWarn("poll fd[%d#%d] failed. Error: %s[%d]", event.fd, reactor_id, strerror(-events[i].res), -events[i].res);
+                }
+                continue;
+            }
+            revents = events[i].res;
+            event.socket = swReactor_get(reactor, event.fd);
+
+            //read
+            if ((revents & POLLIN) && !event.socket->removed)
+            {
+                handle = swReactor_getHandle(reactor, SW_EVENT_READ, event.type);
+                ret = handle(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysError("POLLIN handle failed. fd=%d.", event.fd);
+                }
+            }
+            //write
+            if ((revents & POLLOUT) && !event.socket->removed)
+            {
+                handle = swReactor_getHandle(reactor, SW_EVENT_WRITE, event.type);
+                ret = handle(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysError("POLLOUT handle failed. fd=%d.", event.fd);
+                }
+            }
+            //error, ignore ERR and HUP if the event is already processed at IN and OUT handler.
+            if ((revents & (POLLRDHUP | POLLERR | POLLHUP)) && !(revents & (POLLIN | POLLOUT)) && !event.socket->removed)
+            {
+                handle = swReactor_getHandle(reactor, SW_EVENT_ERROR, event.type);
+                ret = handle(reactor, &event);
+                if (ret < 0)
+                {
+                    swSysError("POLLERR handle failed. fd=%d.", event.fd);
+                }
+            }
+            if (event.socket->removed)
+            {
+                continue;
+            }
+            if (event.socket->events & SW_EVENT_ONCE)
+            {
+                reactor->event_num = reactor->event_num <= 0 ? 0 : reactor->event_num - 1;
+                object->fds[event.fd].generation++;
+                swReactor_del(reactor, event.fd);
+                continue;
+            }
+            entry = &object->fds[event.fd];
+            //the handler may have called reactor->set(), which already re-armed the poll
+            if (entry->generation != generation)
+            {
+                continue;
+            }
+            if (entry->armed)
+            {
+                if (entry->checking)
+                {
+                    continue;
+                }
+                entry->checking = 1;
+                object->check_fds[check_num].fd = event.fd;
+                object->check_fds[check_num].events = swReactorUring_events(event.socket->fdtype | event.socket->events);
+                object->check_user_data[check_num] = swReactorUring_user_data(event.fd, entry);
+                check_num++;
+            }
+            //a fresh poll reports the fd if it is still ready
+            else if (event.socket->events)
+            {
+                if (swReactorUring_poll_add(object, event.fd, event.socket->fdtype | event.socket->events) < 0)
+                {
+                    swWarn("[Reactor#%d] re-arm fd[%d] failed.", reactor_id, event.fd);
+                }
+            }
+        }
+
+        if (check_num > 0)
+        {
+            swReactorUring_check(object, check_num);
+        }
+
+        if (reactor->onFinish != NULL)
+        {
+            reactor->onFinish(reactor);
+        }
+        SW_REACTOR_CONTINUE;
+    }
+    return 0;
+}
+
+#endif
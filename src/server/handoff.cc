@@ -0,0 +1,489 @@
+/*
+  +----------------------------------------------------------------------+
+  | Swoole                                                               |
+  +----------------------------------------------------------------------+
+  | This source file is subject to version 2.0 of the Apache license,    |
+  | that is bundled with this package in the file LICENSE, and is        |
+  | available through the world-wide-web at the following url:           |
+  | http://www.apache.org/licenses/LICENSE-2.0.html                      |
+  | If you did not receive a copy of the Apache2.0 license and are unable|
+  | to obtain it through the world-wide-web, please send a note to       |
+  | license@swoole.com so we can mail you a copy immediately.            |
+  +----------------------------------------------------------------------+
+  | Author: Tianfeng Han  <mikan.tenny@gmail.com>                        |
+  +----------------------------------------------------------------------+
+*/
+
+#include "swoole.h"
+#include "server.h"
+
+#include <sys/un.h>
+
+/**
+ * [handoff_socket] the running master passes its listening sockets to a new master with SCM_RIGHTS:
+ *
+ * 1. the new master connects to SWOOLE_HANDOFF_SOCKET and receives the sockets,
+ *    the ports bound to the same address take them instead of binding again
+ * 2. the new master writes one byte when it starts, the old master stops accepting
+ * 3. the old master exits when its connections are closed, or after max_wait_time
+ *
+ * the backlog of the listening sockets is shared, no connection is reset during the deploy.
+ * the socket file is created with mode 0600, and only a peer of the same user or root is served
+ */
+
+static int swServer_handoff_listen(swServer *serv, swReactor *reactor);
+static int swServer_handoff_onEvent(swReactor *reactor, swEvent *event);
+
+typedef union
+{
+    struct cmsghdr cmsg;
+    char control[CMSG_SPACE(sizeof(int) * SW_HANDOFF_MAX_FD)];
+} swHandoff_control;
+
+/**
+ * [new master] receive the listening sockets of the previous master
+ */
+static int swServer_handoff_receive(swServer *serv, const char *path)
+{
+    struct sockaddr_un addr;
+    swHandoff_control control;
+    struct msghdr msg;
+    struct iovec iov;
+    uint16_t num;
+
+    int sock = swSocket_create(SW_SOCK_UNIX_STREAM);
+    if (sock < 0)
+    {
+        swSysError("create socket failed.");
+        return SW_ERR;
+    }
+    bzero(&addr, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    if (connect(sock, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+    {
+        swSysError("connect(%s) failed.", path);
+        close(sock);
+        return SW_ERR;
+    }
+    swSocket_set_timeout(sock, SW_HANDOFF_TIMEOUT);
+
+    iov.iov_base = &num;
+    iov.iov_len = sizeof(num);
+    bzero(&msg, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.control;
+    msg.msg_controllen = sizeof(control.control);
+
+    ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (n != sizeof(num) || cmsg == NULL || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+    {
+        swWarn("no listening socket is received from %s.", path);
+        close(sock);
+        return SW_ERR;
+    }
+    if (msg.msg_flags & MSG_CTRUNC)
+    {
+        swWarn("some listening sockets from %s are truncated.", path);
+    }
+
+    num = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    serv->handoff_fds = (int *) sw_malloc(sizeof(int) * num);
+    if (serv->handoff_fds == NULL)
+    {
+        swWarn("malloc[handoff_fds] failed.");
+        close(sock);
+        return SW_ERR;
+    }
+    memcpy(serv->handoff_fds, CMSG_DATA(cmsg), sizeof(int) * num);
+    serv->handoff_fd_num = num;
+    serv->handoff_conn = sock;
+    return SW_OK;
+}
+
+/**
+ * the socket is bound to the address of the port
+ */
+static int swServer_handoff_match(int sock, swListenPort *ls)
+{
+    swSocketAddress address;
+    socklen_t optlen;
+    int val;
+
+    optlen = sizeof(val);
+    if (getsockopt(sock, SOL_SOCKET, SO_TYPE, &val, &optlen) < 0
+            || val != (swSocket_is_dgram(ls->type) ? SOCK_DGRAM : SOCK_STREAM))
+    {
+        return SW_FALSE;
+    }
+    address.len = sizeof(address.addr);
+    if (getsockname(sock, (struct sockaddr *) &address.addr, &address.len) < 0)
+    {
+        return SW_FALSE;
+    }
+
+    switch (ls->type)
+    {
+    case SW_SOCK_TCP:
+    case SW_SOCK_UDP:
+    {
+        struct in_addr addr;
+        return address.addr.inet_v4.sin_family == AF_INET && inet_pton(AF_INET, ls->host, &addr) == 1
+                && addr.s_addr == address.addr.inet_v4.sin_addr.s_addr
+                && ntohs(address.addr.inet_v4.sin_port) == ls->port;
+    }
+    case SW_SOCK_TCP6:
+    case SW_SOCK_UDP6:
+    {
+        struct in6_addr addr;
+        return address.addr.inet_v6.sin6_family == AF_INET6 && inet_pton(AF_INET6, ls->host, &addr) == 1
+                && memcmp(&addr, &address.addr.inet_v6.sin6_addr, sizeof(addr)) == 0
+                && ntohs(address.addr.inet_v6.sin6_port) == ls->port;
+    }
+    case SW_SOCK_UNIX_STREAM:
+    case SW_SOCK_UNIX_DGRAM:
+        return address.addr.un.sun_family == AF_UNIX && strcmp(address.addr.un.sun_path, ls->host) == 0;
+    default:
+        return SW_FALSE;
+    }
+}
+
+/**
+ * [new master] the listening socket of the previous master for the port, SW_ERR if there is none
+ */
+int swServer_handoff_adopt(swServer *serv, swListenPort *ls)
+{
+    int i, sock;
+
+    if (serv->handoff_fds == NULL)
+    {
+        char *path = getenv(SW_HANDOFF_ENV);
+        if (path == NULL || serv->handoff_failed)
+        {
+            return SW_ERR;
+        }
+        if (swServer_handoff_receive(serv, path) < 0)
+        {
+            serv->handoff_failed = 1;
+            return SW_ERR;
+        }
+    }
+    //a random port
+    if (ls->port == 0 && !(ls->type == SW_SOCK_UNIX_STREAM || ls->type == SW_SOCK_UNIX_DGRAM))
+    {
+        return SW_ERR;
+    }
+
+    for (i = 0; i < serv->handoff_fd_num; i++)
+    {
+        sock = serv->handoff_fds[i];
+        if (sock >= 0 && swServer_handoff_match(sock, ls))
+        {
+            serv->handoff_fds[i] = -1;
+            ls->handoff_received = 1;
+            return sock;
+        }
+    }
+    return SW_ERR;
+}
+
+/**
+ * [new master] the sockets of the ports that are not added are closed before the workers are forked
+ */
+void swServer_handoff_init(swServer *serv)
+{
+    int i;
+    if (serv->handoff_fds == NULL)
+    {
+        return;
+    }
+    for (i = 0; i < serv->handoff_fd_num; i++)
+    {
+        if (serv->handoff_fds[i] >= 0)
+        {
+            close(serv->handoff_fds[i]);
+        }
+    }
+    sw_free(serv->handoff_fds);
+    serv->handoff_fds = NULL;
+    serv->handoff_fd_num = 0;
+}
+
+/**
+ * [master] the new master accepts, the previous master drains,
+ * then the master waits for the next one on handoff_socket
+ */
+int swServer_handoff_start(swServer *serv, swReactor *reactor)
+{
+    if (serv->handoff_conn >= 0)
+    {
+        if (write(serv->handoff_conn, "", 1) != 1)
+        {
+            swSysError("write() to the previous master failed.");
+        }
+        else
+        {
+            swNotice("the listening sockets are taken over from the previous master.");
+        }
+        close(serv->handoff_conn);
+    }
+    serv->handoff_conn = -1;
+
+    if (serv->handoff_socket == NULL)
+    {
+        return SW_OK;
+    }
+    if (reactor == NULL)
+    {
+        swWarn("handoff_socket is only supported in SWOOLE_PROCESS mode.");
+        return SW_OK;
+    }
+    reactor->setHandle(reactor, SW_FD_HANDOFF, swServer_handoff_onEvent);
+    reactor->setHandle(reactor, SW_FD_HANDOFF | SW_EVENT_ERROR, swServer_handoff_onEvent);
+    return swServer_handoff_listen(serv, reactor);
+}
+
+static int swServer_handoff_listen(swServer *serv, swReactor *reactor)
+{
+    int port = 0;
+    int sock = swSocket_create(SW_SOCK_UNIX_STREAM);
+    if (sock < 0)
+    {
+        swSysError("create socket failed.");
+        return SW_ERR;
+    }
+    if (swSocket_bind(sock, SW_SOCK_UNIX_STREAM, serv->handoff_socket, &port) < 0)
+    {
+        close(sock);
+        return SW_ERR;
+    }
+    //no one can connect before listen()
+    if (chmod(serv->handoff_socket, 0600) < 0)
+    {
+        swSysError("chmod(%s) failed.", serv->handoff_socket);
+        close(sock);
+        return SW_ERR;
+    }
+    if (listen(sock, 1) < 0)
+    {
+        swSysError("listen(%s) failed.", serv->handoff_socket);
+        close(sock);
+        return SW_ERR;
+    }
+    swoole_fcntl_set_option(sock, 1, 1);
+    if (reactor->add(reactor, sock, SW_FD_HANDOFF | SW_EVENT_READ) < 0)
+    {
+        close(sock);
+        return SW_ERR;
+    }
+    serv->handoff_sock = sock;
+    return SW_OK;
+}
+
+/**
+ * [previous master] only a process of the same user or root may take the listening sockets
+ */
+static int swServer_handoff_check_peer(int conn)
+{
+    uid_t uid;
+#ifdef SO_PEERCRED
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+    {
+        swSysError("getsockopt(SO_PEERCRED) failed.");
+        return SW_ERR;
+    }
+    uid = cred.uid;
+#else
+    gid_t gid;
+    if (getpeereid(conn, &uid, &gid) < 0)
+    {
+        swSysError("getpeereid() failed.");
+        return SW_ERR;
+    }
+#endif
+    if (uid != 0 && uid != geteuid())
+    {
+        swWarn("the process of uid=%d is refused by handoff_socket.", (int) uid);
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+/**
+ * [previous master] the sockets of SO_REUSEPORT are bound by the new master itself
+ */
+static int swServer_handoff_send(swServer *serv, int conn)
+{
+    int fds[SW_HANDOFF_MAX_FD];
+    swHandoff_control control;
+    struct msghdr msg;
+    struct iovec iov;
+    uint16_t num = 0;
+    swListenPort *ls;
+
+    LL_FOREACH(serv->listen_list, ls)
+    {
+        if (ls->thread_socks)
+        {
+            continue;
+        }
+        if (num == SW_HANDOFF_MAX_FD)
+        {
+            swWarn("only %d listening sockets can be handed over.", SW_HANDOFF_MAX_FD);
+            break;
+        }
+        fds[num++] = ls->sock;
+    }
+    if (num == 0)
+    {
+        return SW_ERR;
+    }
+
+    iov.iov_base = &num;
+    iov.iov_len = sizeof(num);
+    bzero(&msg, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * num);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * num);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * num);
+
+    if (sendmsg(conn, &msg, 0) < 0)
+    {
+        swSysError("sendmsg() to the new master failed.");
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+/**
+ * [previous master] stop accepting, the connections are served until they are closed
+ */
+static void swServer_handoff_drain(swServer *serv, swReactor *reactor)
+{
+    swListenPort *ls;
+    LL_FOREACH(serv->listen_list, ls)
+    {
+        if (ls->thread_socks)
+        {
+            continue;
+        }
+        ls->handoff_sent = 1;
+        //the datagrams are read by the new master, the replies are still sent on the socket
+        if (swSocket_is_dgram(ls->type) && !serv->single_thread)
+        {
+            swReactor *thread_reactor = &swServer_get_thread(serv, ls->sock % serv->reactor_num)->reactor;
+            thread_reactor->del(thread_reactor, ls->sock);
+        }
+        else
+        {
+            reactor->del(reactor, ls->sock);
+        }
+    }
+    serv->handoff_sent = 1;
+    //the path belongs to the new master
+    reactor->del(reactor, serv->handoff_sock);
+    close(serv->handoff_sock);
+    serv->handoff_sock = 0;
+
+    serv->handoff_draining = 1;
+    serv->handoff_drain_time = serv->gs->now;
+    swNotice("the listening sockets are handed over to the new master, %d connections are draining.",
+            serv->stats->connection_num);
+}
+
+static int swServer_handoff_onEvent(swReactor *reactor, swEvent *event)
+{
+    swServer *serv = (swServer *) reactor->ptr;
+
+    if (event->fd == serv->handoff_sock)
+    {
+        swSocketAddress addr;
+        int conn = swSocket_accept(event->fd, &addr);
+        if (conn < 0)
+        {
+            return SW_OK;
+        }
+        //one new master at a time
+        if (serv->handoff_conn >= 0 || swServer_handoff_check_peer(conn) < 0 || swServer_handoff_send(serv, conn) < 0)
+        {
+            close(conn);
+            return SW_OK;
+        }
+        serv->handoff_conn = conn;
+        reactor->add(reactor, conn, SW_FD_HANDOFF | SW_EVENT_READ);
+        return SW_OK;
+    }
+
+    char c;
+    ssize_t n = read(event->fd, &c, 1);
+    if (n < 0 && swConnection_error(errno) == SW_WAIT)
+    {
+        return SW_OK;
+    }
+    reactor->del(reactor, event->fd);
+    close(event->fd);
+    serv->handoff_conn = -1;
+
+    if (n == 1)
+    {
+        swServer_handoff_drain(serv, reactor);
+        return SW_OK;
+    }
+
+    //the new master may have replaced the socket file
+    swWarn("the new master exited before taking over the listening sockets.");
+    reactor->del(reactor, serv->handoff_sock);
+    close(serv->handoff_sock);
+    serv->handoff_sock = 0;
+    return swServer_handoff_listen(serv, reactor);
+}
+
+/**
+ * [previous master] exit when the connections are closed, or after max_wait_time
+ */
+void swServer_handoff_check(swServer *serv)
+{
+    if (!serv->handoff_draining)
+    {
+        return;
+    }
+    if (serv->stats->connection_num > 0
+            && (serv->max_wait_time == 0 || serv->gs->now - serv->handoff_drain_time < serv->max_wait_time))
+    {
+        return;
+    }
+    serv->handoff_draining = 0;
+    swNotice("Server is shutdown now.");
+    SwooleG.main_reactor->running = 0;
+}
+
+void swServer_handoff_free(swServer *serv)
+{
+    swServer_handoff_init(serv);
+    if (serv->handoff_conn >= 0)
+    {
+        close(serv->handoff_conn);
+        serv->handoff_conn = -1;
+    }
+    if (serv->handoff_sock > 0)
+    {
+        close(serv->handoff_sock);
+        unlink(serv->handoff_socket);
+        serv->handoff_sock = 0;
+    }
+    if (serv->handoff_socket)
+    {
+        sw_free(serv->handoff_socket);
+        serv->handoff_socket = NULL;
+    }
+}
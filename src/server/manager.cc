@@ -19,6 +19,29 @@
 
 #include <sys/wait.h>
 
+/**
+ * [standby_worker_num] a worker forked for the slot worker_id, which runs onWorkerStart
+ * and waits until the manager writes to the pipe
+ */
+typedef struct
+{
+    pid_t pid;
+    uint16_t worker_id;
+    uint8_t ready;
+    int pipe_fd;
+} swStandbyWorker;
+
+/**
+ * [reload_batch_num] a worker stopped by the rolling reload, the slot counts against the batch
+ * until the replacement is ready
+ */
+typedef struct
+{
+    pid_t pid;
+    uint16_t worker_id;
+    uint8_t ready;
+} swRollingWorker;
+
 typedef struct
 {
     uint8_t  reloading;
@@ -29,6 +52,11 @@ typedef struct
     uint32_t reload_worker_i;
     uint32_t reload_worker_num;
     swWorker *reload_workers;
+    uint8_t reload_wait_standby;
+    uint16_t standby_count;
+    swStandbyWorker *standby_workers;
+    uint16_t rolling_count;
+    swRollingWorker *rolling_workers;
 } swManagerProcess;
 
 typedef struct
@@ -40,6 +68,16 @@ typedef struct
 static int swManager_loop(swFactory *factory);
 static void swManager_signal_handler(int sig);
 static pid_t swManager_spawn_worker(swFactory *factory, int worker_id);
+static pid_t swManager_replace_worker(swFactory *factory, int worker_id);
+static void swManager_close_standby_pipes();
+static void swManager_standby_fill(swFactory *factory);
+static void swManager_standby_discard(swServer *serv);
+static void swManager_standby_ready(swServer *serv, pid_t pid);
+static int swManager_standby_exit(swServer *serv, pid_t pid);
+static int swManager_standby_warming(int worker_id);
+static int swManager_rolling_reload(swServer *serv);
+static void swManager_rolling_ready(swServer *serv, int worker_id, pid_t pid);
+static void swManager_reload_begin(swServer *serv);
 static void swManager_check_exit_status(swServer *serv, int worker_id, pid_t pid, int status);
 
 static swManagerProcess ManagerProcess;
@@ -98,6 +136,22 @@ static void swManager_add_timeout_killer(swServer *serv, swWorker *workers, int
     swTimer_add(&SwooleG.timer, (long) (serv->max_wait_time * 1000), 0, reload_info, swManager_kill_timeout_process);
 }
 
+/**
+ * consistent hash dispatch takes one more worker, only the keys of the new worker move
+ */
+static void swManager_rebalance_dispatch(swServer *serv)
+{
+    if (serv->dispatch_mode != SW_DISPATCH_IPHASH && serv->dispatch_mode != SW_DISPATCH_UIDHASH)
+    {
+        return;
+    }
+    if (serv->gs->dispatch_hash_num < serv->worker_num)
+    {
+        sw_atomic_fetch_add(&serv->gs->dispatch_hash_num, 1);
+        swNotice("dispatch to %d of %d workers.", serv->gs->dispatch_hash_num, serv->worker_num);
+    }
+}
+
 //create worker child proccess
 int swManager_start(swFactory *factory)
 {
@@ -249,6 +303,7 @@ int swManager_start(swFactory *factory)
 
 static void swManager_check_exit_status(swServer *serv, int worker_id, pid_t pid, int status)
 {
+    swTaskWorker_reclaim(serv, pid);
     if (status != 0)
     {
         swWarn(
@@ -270,6 +325,7 @@ static int swManager_loop(swFactory *factory)
     pid_t reload_worker_pid = 0;
 
     int status;
+    int wait_errno;
 
     SwooleG.use_signalfd = 0;
     SwooleG.main_reactor = NULL;
@@ -296,6 +352,26 @@ static int swManager_loop(swFactory *factory)
         return SW_ERR;
     }
 
+    if (serv->standby_worker_num > 0)
+    {
+        ManagerProcess.standby_workers = (swStandbyWorker *) sw_calloc(serv->standby_worker_num, sizeof(swStandbyWorker));
+        if (ManagerProcess.standby_workers == NULL)
+        {
+            swError("malloc[standby_workers] failed");
+            return SW_ERR;
+        }
+    }
+
+    if (serv->reload_batch_num > 0)
+    {
+        ManagerProcess.rolling_workers = (swRollingWorker *) sw_calloc(serv->reload_batch_num, sizeof(swRollingWorker));
+        if (ManagerProcess.rolling_workers == NULL)
+        {
+            swError("malloc[rolling_workers] failed");
+            return SW_ERR;
+        }
+    }
+
     //for reload
     swSignal_add(SIGHUP, NULL);
     swSignal_add(SIGTERM, swManager_signal_handler);
@@ -311,10 +387,14 @@ static int swManager_loop(swFactory *factory)
     {
         swTimer_add(&SwooleG.timer, (long) (serv->manager_alarm * 1000), 1, serv, swManager_onTimer);
     }
+    swTaskWorker_check_queue(serv);
+
+    swManager_standby_fill(factory);
 
     while (SwooleG.running > 0)
     {
         _wait: pid = wait(&status);
+        wait_errno = errno;
 
         if (ManagerProcess.read_message)
         {
@@ -325,13 +405,23 @@ static int swManager_loop(swFactory *factory)
                 {
                     continue;
                 }
+                if (msg.type == SW_WORKER_MESSAGE_STANDBY_READY)
+                {
+                    swManager_standby_ready(serv, msg.pid);
+                    continue;
+                }
+                else if (msg.type == SW_WORKER_MESSAGE_READY)
+                {
+                    swManager_rolling_ready(serv, msg.worker_id, msg.pid);
+                    continue;
+                }
                 if (msg.worker_id >= serv->worker_num)
                 {
                     swManager_spawn_task_worker(serv, swServer_get_worker(serv, msg.worker_id));
                 }
                 else
                 {
-                    pid_t new_pid = swManager_spawn_worker(factory, msg.worker_id);
+                    pid_t new_pid = swManager_replace_worker(factory, msg.worker_id);
                     if (new_pid > 0)
                     {
                         serv->workers[msg.worker_id].pid = new_pid;
@@ -339,6 +429,7 @@ static int swManager_loop(swFactory *factory)
                 }
             }
             ManagerProcess.read_message = 0;
+            swManager_standby_fill(factory);
         }
 
         if (SwooleG.signal_alarm == 1)
@@ -349,6 +440,8 @@ static int swManager_loop(swFactory *factory)
 
         if (pid < 0)
         {
+            //the messages and the timers may have changed it
+            errno = wait_errno;
             if (ManagerProcess.reloading == 0)
             {
                 error: if (errno > 0 && errno != EINTR)
@@ -366,7 +459,11 @@ static int swManager_loop(swFactory *factory)
                     ManagerProcess.reload_init = 1;
                     memcpy(ManagerProcess.reload_workers, serv->workers, sizeof(swWorker) * serv->worker_num);
 
-                    swManager_add_timeout_killer(serv, serv->workers, serv->worker_num);
+                    //the rolling reload starts the timer when the worker is stopped
+                    if (serv->reload_batch_num == 0)
+                    {
+                        swManager_add_timeout_killer(serv, serv->workers, serv->worker_num);
+                    }
 
                     ManagerProcess.reload_worker_num = serv->worker_num;
                     if (serv->task_worker_num > 0)
@@ -375,11 +472,18 @@ static int swManager_loop(swFactory *factory)
                                 sizeof(swWorker) * serv->task_worker_num);
                         ManagerProcess.reload_worker_num += serv->task_worker_num;
 
-                        swManager_add_timeout_killer(serv, serv->gs->task_workers.workers, serv->task_worker_num);
+                        if (serv->reload_batch_num == 0)
+                        {
+                            swManager_add_timeout_killer(serv, serv->gs->task_workers.workers, serv->task_worker_num);
+                        }
                     }
 
                     ManagerProcess.reload_all_worker = 0;
-                    if (serv->reload_async)
+                    swManager_reload_begin(serv);
+                    //the standby workers have run the old code
+                    swManager_standby_discard(serv);
+                    //with standby workers or in batches the slots are handed over gradually, not all at once
+                    if (serv->reload_async && serv->standby_worker_num == 0 && serv->reload_batch_num == 0)
                     {
                         for (i = 0; i < serv->worker_num; i++)
                         {
@@ -394,6 +498,7 @@ static int swManager_loop(swFactory *factory)
                     {
                         ManagerProcess.reload_worker_i = 0;
                     }
+                    swManager_standby_fill(factory);
                 }
                 goto kill_worker;
             }
@@ -409,14 +514,23 @@ static int swManager_loop(swFactory *factory)
                 if (ManagerProcess.reload_init == 0)
                 {
                     memcpy(ManagerProcess.reload_workers, serv->gs->task_workers.workers, sizeof(swWorker) * serv->task_worker_num);
-                    swManager_add_timeout_killer(serv, serv->gs->task_workers.workers, serv->task_worker_num);
+                    if (serv->reload_batch_num == 0)
+                    {
+                        swManager_add_timeout_killer(serv, serv->gs->task_workers.workers, serv->task_worker_num);
+                    }
                     ManagerProcess.reload_worker_num = serv->task_worker_num;
                     ManagerProcess.reload_worker_i = 0;
                     ManagerProcess.reload_init = 1;
                     ManagerProcess.reload_task_worker = 0;
+                    swManager_reload_begin(serv);
                 }
                 goto kill_worker;
             }
+            //a standby worker of the reloading slot or a replacement of the batch may be ready
+            else if (ManagerProcess.reload_wait_standby || ManagerProcess.rolling_count > 0)
+            {
+                goto kill_worker;
+            }
             else
             {
                 goto error;
@@ -424,6 +538,19 @@ static int swManager_loop(swFactory *factory)
         }
         if (SwooleG.running == 1)
         {
+            if (swManager_standby_exit(serv, pid))
+            {
+                if (status != 0)
+                {
+                    swWarn("standby worker[pid=%d] abnormal exit, status=%d, signal=%d", pid, WEXITSTATUS(status), WTERMSIG(status));
+                }
+                swManager_standby_fill(factory);
+                if (ManagerProcess.reload_wait_standby)
+                {
+                    goto kill_worker;
+                }
+                continue;
+            }
             //event workers
             for (i = 0; i < serv->worker_num; i++)
             {
@@ -442,10 +569,12 @@ static int swManager_loop(swFactory *factory)
 
                 //Check the process return code and signal
                 swManager_check_exit_status(serv, i, pid, status);
+                //[SW_DISPATCH_LEAST_LOAD] the requests taken by the exited worker will never be finished
+                serv->workers[i].inflight = 0;
 
                 while (1)
                 {
-                    new_pid = swManager_spawn_worker(factory, i);
+                    new_pid = swManager_replace_worker(factory, i);
                     if (new_pid < 0)
                     {
                         SW_START_SLEEP;
@@ -457,6 +586,11 @@ static int swManager_loop(swFactory *factory)
                         break;
                     }
                 }
+                swManager_standby_fill(factory);
+                if (ManagerProcess.reloading)
+                {
+                    swManager_rebalance_dispatch(serv);
+                }
             }
 
             swWorker *exit_worker;
@@ -489,27 +623,52 @@ static int swManager_loop(swFactory *factory)
         //reload worker
         kill_worker: if (ManagerProcess.reloading == 1)
         {
-            //reload finish
-            if (ManagerProcess.reload_worker_i >= ManagerProcess.reload_worker_num)
+            if (serv->reload_batch_num > 0)
             {
-                reload_worker_pid = ManagerProcess.reload_worker_i = ManagerProcess.reload_init = ManagerProcess.reloading = 0;
-                continue;
+                if (!swManager_rolling_reload(serv))
+                {
+                    continue;
+                }
             }
-            reload_worker_pid = ManagerProcess.reload_workers[ManagerProcess.reload_worker_i].pid;
-            if (swKill(reload_worker_pid, SIGTERM) < 0)
+            else if (ManagerProcess.reload_worker_i < ManagerProcess.reload_worker_num)
             {
-                if (errno == ECHILD || errno == ESRCH)
+                serv->stats->reload_ready_num = ManagerProcess.reload_worker_i;
+                //the worker is stopped after the standby worker of its slot is ready
+                ManagerProcess.reload_wait_standby = swManager_standby_warming(ManagerProcess.reload_workers[ManagerProcess.reload_worker_i].id);
+                if (ManagerProcess.reload_wait_standby)
                 {
-                    ManagerProcess.reload_worker_i++;
-                    goto kill_worker;
+                    continue;
+                }
+                reload_worker_pid = ManagerProcess.reload_workers[ManagerProcess.reload_worker_i].pid;
+                if (swKill(reload_worker_pid, SIGTERM) < 0)
+                {
+                    if (errno == ECHILD || errno == ESRCH)
+                    {
+                        ManagerProcess.reload_worker_i++;
+                        goto kill_worker;
+                    }
+                    swSysError("swKill(%d, SIGTERM) [%d] failed.", ManagerProcess.reload_workers[ManagerProcess.reload_worker_i].pid, ManagerProcess.reload_worker_i);
                 }
-                swSysError("swKill(%d, SIGTERM) [%d] failed.", ManagerProcess.reload_workers[ManagerProcess.reload_worker_i].pid, ManagerProcess.reload_worker_i);
+                continue;
             }
+            //reload finish
+            if (ManagerProcess.reload_init)
+            {
+                serv->stats->reload_ready_num = ManagerProcess.reload_worker_num;
+                serv->stats->reloading = 0;
+                sw_atomic_fetch_add(&serv->stats->reload_count, 1);
+            }
+            reload_worker_pid = ManagerProcess.reload_worker_i = ManagerProcess.reload_init = ManagerProcess.reloading = 0;
         }
     }
 
     sw_free(ManagerProcess.reload_workers);
     swSignal_none();
+    //kill the standby workers
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        swKill(ManagerProcess.standby_workers[i].pid, SIGTERM);
+    }
     //kill all child process
     for (i = 0; i < serv->worker_num; i++)
     {
@@ -529,6 +688,22 @@ static int swManager_loop(swFactory *factory)
             swSysError("waitpid(%d) failed.", serv->workers[i].pid);
         }
     }
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        if (swWaitpid(ManagerProcess.standby_workers[i].pid, &status, 0) < 0)
+        {
+            swSysError("waitpid(%d) failed.", ManagerProcess.standby_workers[i].pid);
+        }
+        close(ManagerProcess.standby_workers[i].pipe_fd);
+    }
+    if (ManagerProcess.standby_workers)
+    {
+        sw_free(ManagerProcess.standby_workers);
+    }
+    if (ManagerProcess.rolling_workers)
+    {
+        sw_free(ManagerProcess.rolling_workers);
+    }
     //kill all user process
     if (serv->user_worker_map)
     {
@@ -559,6 +734,7 @@ static pid_t swManager_spawn_worker(swFactory *factory, int worker_id)
     //worker child processor
     else if (pid == 0)
     {
+        swManager_close_standby_pipes();
         ret = swWorker_loop(factory, worker_id);
         exit(ret);
     }
@@ -569,6 +745,311 @@ static pid_t swManager_spawn_worker(swFactory *factory, int worker_id)
     }
 }
 
+static void swManager_close_standby_pipes()
+{
+    int i;
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        close(ManagerProcess.standby_workers[i].pipe_fd);
+    }
+}
+
+static pid_t swManager_spawn_standby_worker(swFactory *factory, int worker_id)
+{
+    int pipe_fds[2];
+    if (pipe(pipe_fds) < 0)
+    {
+        swSysError("pipe() failed.");
+        return SW_ERR;
+    }
+
+    pid_t pid = swoole_fork();
+    if (pid < 0)
+    {
+        swWarn("Fork Worker failed. Error: %s [%d]", strerror(errno), errno);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return SW_ERR;
+    }
+    else if (pid == 0)
+    {
+        swManager_close_standby_pipes();
+        close(pipe_fds[1]);
+        SwooleWG.standby = 1;
+        SwooleWG.standby_fd = pipe_fds[0];
+        exit(swWorker_loop(factory, worker_id));
+    }
+
+    close(pipe_fds[0]);
+    swStandbyWorker *standby = &ManagerProcess.standby_workers[ManagerProcess.standby_count++];
+    standby->pid = pid;
+    standby->worker_id = worker_id;
+    standby->ready = 0;
+    standby->pipe_fd = pipe_fds[1];
+    return pid;
+}
+
+static int swManager_standby_find(int worker_id)
+{
+    int i;
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        if (ManagerProcess.standby_workers[i].worker_id == worker_id)
+        {
+            return i;
+        }
+    }
+    return SW_ERR;
+}
+
+static void swManager_standby_remove(swServer *serv, int i)
+{
+    if (ManagerProcess.standby_workers[i].ready)
+    {
+        sw_atomic_fetch_sub(&serv->stats->standby_worker_num, 1);
+    }
+    close(ManagerProcess.standby_workers[i].pipe_fd);
+    ManagerProcess.standby_workers[i] = ManagerProcess.standby_workers[--ManagerProcess.standby_count];
+}
+
+/**
+ * the slots of a running reload in their order, otherwise the worker closest to max_request
+ */
+static int swManager_standby_pick(swServer *serv)
+{
+    uint32_t i;
+    int worker_id = SW_ERR;
+
+    if (ManagerProcess.reloading && ManagerProcess.reload_init)
+    {
+        for (i = ManagerProcess.reload_worker_i; i < ManagerProcess.reload_worker_num; i++)
+        {
+            worker_id = ManagerProcess.reload_workers[i].id;
+            //not replaced yet
+            if (worker_id < serv->worker_num && ManagerProcess.reload_workers[i].pid == serv->workers[worker_id].pid
+                    && swManager_standby_find(worker_id) < 0)
+            {
+                return worker_id;
+            }
+        }
+        worker_id = SW_ERR;
+    }
+    for (i = 0; i < serv->worker_num; i++)
+    {
+        if (swManager_standby_find(i) >= 0)
+        {
+            continue;
+        }
+        if (worker_id < 0 || serv->workers[i].request_count > serv->workers[worker_id].request_count)
+        {
+            worker_id = i;
+        }
+    }
+    return worker_id;
+}
+
+static void swManager_standby_fill(swFactory *factory)
+{
+    swServer *serv = (swServer *) factory->ptr;
+    while (SwooleG.running && ManagerProcess.standby_count < serv->standby_worker_num)
+    {
+        int worker_id = swManager_standby_pick(serv);
+        if (worker_id < 0 || swManager_spawn_standby_worker(factory, worker_id) < 0)
+        {
+            break;
+        }
+    }
+}
+
+static void swManager_standby_discard(swServer *serv)
+{
+    while (ManagerProcess.standby_count > 0)
+    {
+        swKill(ManagerProcess.standby_workers[0].pid, SIGTERM);
+        swManager_standby_remove(serv, 0);
+    }
+}
+
+/**
+ * the standby worker may have taken over a slot before it was ready
+ */
+static void swManager_standby_ready(swServer *serv, pid_t pid)
+{
+    int i;
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        if (ManagerProcess.standby_workers[i].pid == pid)
+        {
+            ManagerProcess.standby_workers[i].ready = 1;
+            sw_atomic_fetch_add(&serv->stats->standby_worker_num, 1);
+            return;
+        }
+    }
+}
+
+static int swManager_standby_exit(swServer *serv, pid_t pid)
+{
+    int i;
+    for (i = 0; i < ManagerProcess.standby_count; i++)
+    {
+        if (ManagerProcess.standby_workers[i].pid == pid)
+        {
+            swManager_standby_remove(serv, i);
+            return SW_TRUE;
+        }
+    }
+    return SW_FALSE;
+}
+
+static int swManager_standby_warming(int worker_id)
+{
+    int i = swManager_standby_find(worker_id);
+    return i >= 0 && !ManagerProcess.standby_workers[i].ready;
+}
+
+/**
+ * the standby worker of the slot takes over at once, otherwise a new worker is forked
+ */
+static pid_t swManager_replace_worker(swFactory *factory, int worker_id)
+{
+    swServer *serv = (swServer *) factory->ptr;
+    int i = swManager_standby_find(worker_id);
+    if (i < 0)
+    {
+        return swManager_spawn_worker(factory, worker_id);
+    }
+
+    pid_t pid = ManagerProcess.standby_workers[i].pid;
+    ssize_t n = write(ManagerProcess.standby_workers[i].pipe_fd, "", 1);
+    swManager_standby_remove(serv, i);
+    if (n != 1)
+    {
+        swSysError("write() to standby worker[pid=%d] failed.", pid);
+        swKill(pid, SIGTERM);
+        pid = swManager_spawn_worker(factory, worker_id);
+    }
+    else
+    {
+        sw_atomic_fetch_add(&serv->stats->standby_activate_count, 1);
+    }
+    return pid;
+}
+
+static void swManager_reload_begin(swServer *serv)
+{
+    serv->stats->reload_worker_num = ManagerProcess.reload_worker_num;
+    serv->stats->reload_ready_num = 0;
+    serv->stats->reloading = 1;
+}
+
+static void swManager_rolling_timeout(swTimer *timer, swTimer_node *tnode)
+{
+    swServer *serv = SwooleG.serv;
+    pid_t pid = (pid_t) (long) tnode->data;
+    int i;
+
+    for (i = 0; i < ManagerProcess.rolling_count; i++)
+    {
+        swRollingWorker *rolling = &ManagerProcess.rolling_workers[i];
+        if (rolling->pid != pid)
+        {
+            continue;
+        }
+        //the stopped worker has not exited yet, the replacement gets the whole timeout
+        if (swServer_get_worker(serv, rolling->worker_id)->pid == pid)
+        {
+            swTimer_add(&SwooleG.timer, (long) (serv->reload_ready_timeout * 1000), 0, tnode->data, swManager_rolling_timeout);
+        }
+        else
+        {
+            rolling->ready = 1;
+        }
+        return;
+    }
+}
+
+/**
+ * the replacement of the slot has served its first request
+ */
+static void swManager_rolling_ready(swServer *serv, int worker_id, pid_t pid)
+{
+    int i;
+    //only the workers send it, the task workers are ready once spawned
+    if (worker_id < 0 || worker_id >= (int) serv->worker_num)
+    {
+        return;
+    }
+    if (swServer_get_worker(serv, worker_id)->pid != pid)
+    {
+        return;
+    }
+    for (i = 0; i < ManagerProcess.rolling_count; i++)
+    {
+        if (ManagerProcess.rolling_workers[i].worker_id == worker_id)
+        {
+            ManagerProcess.rolling_workers[i].ready = 1;
+        }
+    }
+}
+
+/**
+ * [reload_batch_num] the slots with a ready replacement leave the batch, then the next workers are stopped,
+ * returns SW_TRUE when all the workers have been replaced
+ */
+static int swManager_rolling_reload(swServer *serv)
+{
+    int i;
+    for (i = 0; i < ManagerProcess.rolling_count;)
+    {
+        swRollingWorker *rolling = &ManagerProcess.rolling_workers[i];
+        //the task workers take tasks as soon as they are spawned
+        if (swServer_get_worker(serv, rolling->worker_id)->pid != rolling->pid
+                && (rolling->ready || rolling->worker_id >= serv->worker_num))
+        {
+            *rolling = ManagerProcess.rolling_workers[--ManagerProcess.rolling_count];
+            sw_atomic_fetch_add(&serv->stats->reload_ready_num, 1);
+            continue;
+        }
+        i++;
+    }
+
+    ManagerProcess.reload_wait_standby = 0;
+    while (ManagerProcess.rolling_count < serv->reload_batch_num
+            && ManagerProcess.reload_worker_i < ManagerProcess.reload_worker_num)
+    {
+        swWorker *worker = &ManagerProcess.reload_workers[ManagerProcess.reload_worker_i];
+        //the worker is stopped after the standby worker of its slot has run onWorkerStart
+        if (swManager_standby_warming(worker->id))
+        {
+            ManagerProcess.reload_wait_standby = 1;
+            break;
+        }
+        ManagerProcess.reload_worker_i++;
+        if (swKill(worker->pid, SIGTERM) < 0)
+        {
+            if (errno != ECHILD && errno != ESRCH)
+            {
+                swSysError("swKill(%d, SIGTERM) [%d] failed.", worker->pid, worker->id);
+            }
+            sw_atomic_fetch_add(&serv->stats->reload_ready_num, 1);
+            continue;
+        }
+        swManager_add_timeout_killer(serv, worker, 1);
+        if (serv->reload_ready_timeout > 0 && worker->id < serv->worker_num)
+        {
+            swTimer_add(&SwooleG.timer, (long) (serv->reload_ready_timeout * 1000), 0, (void *) (long) worker->pid,
+                    swManager_rolling_timeout);
+        }
+
+        swRollingWorker *rolling = &ManagerProcess.rolling_workers[ManagerProcess.rolling_count++];
+        rolling->pid = worker->pid;
+        rolling->worker_id = worker->id;
+        rolling->ready = 0;
+    }
+
+    return ManagerProcess.reload_worker_i >= ManagerProcess.reload_worker_num && ManagerProcess.rolling_count == 0;
+}
+
 static void swManager_signal_handler(int sig)
 {
     switch (sig)
@@ -19,9 +19,14 @@
 #include "connection.h"
 
 static int swServer_start_check(swServer *serv);
+static void swServer_check_max_connection(swServer *serv);
 static void swServer_signal_handler(int sig);
 static void swServer_disable_accept(swReactor *reactor);
 static void swServer_master_update_time(swServer *serv);
+static void swServer_master_update_event_rate(swServer *serv);
+#ifdef HAVE_NUMA
+static void swServer_numa_init(swServer *serv);
+#endif
 
 static int swServer_tcp_send(swServer *serv, int session_id, void *data, uint32_t length);
 static int swServer_tcp_sendwait(swServer *serv, int session_id, void *data, uint32_t length);
@@ -39,10 +44,28 @@ __thread swThreadG SwooleTG;
 int16_t sw_errno;
 char sw_error[SW_ERROR_MSG_SIZE];
 
+/**
+ * the listening socket of the port in this reactor, -1 if it accepts in other reactors
+ */
+static sw_inline int swServer_get_listen_socket(swServer *serv, swListenPort *ls, swReactor *reactor)
+{
+    //the new master accepts on it
+    if (ls->handoff_sent)
+    {
+        return -1;
+    }
+    if (ls->thread_socks == NULL)
+    {
+        return SwooleTG.type == SW_THREAD_REACTOR && !serv->single_thread ? -1 : ls->sock;
+    }
+    return SwooleTG.type == SW_THREAD_REACTOR ? ls->thread_socks[reactor->id] : -1;
+}
+
 static void swServer_disable_accept(swReactor *reactor)
 {
     swListenPort *ls;
     swServer *serv = (swServer *) reactor->ptr;
+    int sock;
 
     LL_FOREACH(serv->listen_list, ls)
     {
@@ -51,7 +74,11 @@ static void swServer_disable_accept(swReactor *reactor)
         {
             continue;
         }
-        reactor->del(reactor, ls->sock);
+        sock = swServer_get_listen_socket(serv, ls, reactor);
+        if (sock >= 0)
+        {
+            reactor->del(reactor, sock);
+        }
     }
 }
 
@@ -59,6 +86,7 @@ void swServer_enable_accept(swReactor *reactor)
 {
     swListenPort *ls;
     swServer *serv = (swServer *) reactor->ptr;
+    int sock;
 
     LL_FOREACH(serv->listen_list, ls)
     {
@@ -67,7 +95,11 @@ void swServer_enable_accept(swReactor *reactor)
         {
             continue;
         }
-        reactor->add(reactor, ls->sock, SW_FD_LISTEN);
+        sock = swServer_get_listen_socket(serv, ls, reactor);
+        if (sock >= 0)
+        {
+            reactor->add(reactor, sock, SW_FD_LISTEN);
+        }
     }
 }
 
@@ -82,6 +114,14 @@ void swServer_close_port(swServer *serv, enum swBool_type only_stream_port)
             continue;
         }
         //stream socket
+        if (ls->thread_socks)
+        {
+            int i;
+            for (i = 1; i < serv->reactor_num; i++)
+            {
+                close(ls->thread_socks[i]);
+            }
+        }
         close(ls->sock);
     }
 }
@@ -112,6 +152,11 @@ int swServer_master_onAccept(swReactor *reactor, swEvent *event)
                 {
                     swServer_disable_accept(reactor);
                     reactor->disable_accept = 1;
+                    //reactor thread has no timer, listen again in onTimeout
+                    if (SwooleTG.type == SW_THREAD_REACTOR)
+                    {
+                        reactor->timeout_msec = SW_ACCEPT_RETRY_TIME;
+                    }
                 }
                 swoole_error_log(SW_LOG_ERROR, SW_ERROR_SYSTEM_CALL_FAIL, "accept() failed. Error: %s[%d]", strerror(errno), errno);
                 return SW_OK;
@@ -133,9 +178,15 @@ int swServer_master_onAccept(swReactor *reactor, swEvent *event)
             reactor_id = 0;
             sub_reactor = reactor;
         }
+        //SO_REUSEPORT, the reactor thread owns the connections it accepted
+        else if (SwooleTG.type == SW_THREAD_REACTOR)
+        {
+            reactor_id = reactor->id;
+            sub_reactor = reactor;
+        }
         else
         {
-            reactor_id = new_fd % serv->reactor_num;
+            reactor_id = swServer_reactor_schedule(serv, new_fd);
             sub_reactor = &serv->reactor_threads[reactor_id].reactor;
         }
 
@@ -170,6 +221,10 @@ int swServer_master_onAccept(swReactor *reactor, swEvent *event)
             close(new_fd);
             return SW_OK;
         }
+        if (serv->factory_mode == SW_MODE_PROCESS)
+        {
+            sw_atomic_fetch_add(&swServer_get_thread(serv, reactor_id)->connection_num, 1);
+        }
 
 #ifdef SW_ACCEPT_AGAIN
         continue;
@@ -194,10 +249,11 @@ static int swServer_start_check(swServer *serv)
         swWarn("onPacket event callback must be set.");
         return SW_ERR;
     }
-    //disable notice when use SW_DISPATCH_ROUND and SW_DISPATCH_QUEUE
+    //disable notice when use SW_DISPATCH_ROUND, SW_DISPATCH_QUEUE and SW_DISPATCH_LEAST_LOAD
     if (serv->factory_mode == SW_MODE_PROCESS)
     {
-        if (serv->dispatch_mode == SW_DISPATCH_ROUND || serv->dispatch_mode == SW_DISPATCH_QUEUE)
+        if (serv->dispatch_mode == SW_DISPATCH_ROUND || serv->dispatch_mode == SW_DISPATCH_QUEUE
+                || serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD)
         {
             if (!serv->enable_unsafe_event)
             {
@@ -220,6 +276,12 @@ static int swServer_start_check(swServer *serv)
             swWarn("serv->task_worker_num > %d, Too many processes, the system will be slow", SW_CPU_NUM * SW_MAX_WORKER_NCPU);
             serv->task_worker_num = SW_CPU_NUM * SW_MAX_WORKER_NCPU;
         }
+        //the async task worker reads from its pipe
+        if (serv->task_ipc_mode == SW_TASK_IPC_SHM_QUEUE && serv->task_enable_coroutine)
+        {
+            swWarn("task_ipc_mode=%d cannot be used with task_enable_coroutine, use unix socket instead.", SW_TASK_IPC_SHM_QUEUE);
+            serv->task_ipc_mode = SW_TASK_IPC_UNIXSOCK;
+        }
     }
     //check thread num
     if (serv->reactor_num > SW_CPU_NUM * SW_MAX_THREAD_NCPU)
@@ -244,22 +306,45 @@ static int swServer_start_check(swServer *serv)
     {
         serv->reactor_num = serv->worker_num;
     }
-    // max connections
-    uint32_t minimum_connection = (serv->worker_num + serv->task_worker_num) * 2 + 32;
-    if (serv->max_connection < minimum_connection)
+    if (serv->dispatch_hash_num == 0 || serv->dispatch_hash_num > serv->worker_num)
     {
-        serv->max_connection = SwooleG.max_sockets;
-        swWarn("serv->max_connection must be bigger than %u, it's reset to %u", minimum_connection, SwooleG.max_sockets);
+        serv->dispatch_hash_num = serv->worker_num;
     }
-    else if (SwooleG.max_sockets > 0 && serv->max_connection > SwooleG.max_sockets)
+    serv->gs->dispatch_hash_num = serv->dispatch_hash_num;
+    //the standby workers only take over the slots of the event workers
+    if (serv->factory_mode != SW_MODE_PROCESS)
     {
-        serv->max_connection = SwooleG.max_sockets;
-        swWarn("serv->max_connection is exceed the maximum value, it's reset to %u.", SwooleG.max_sockets);
+        serv->standby_worker_num = 0;
     }
-    else if (serv->max_connection > SW_SESSION_LIST_SIZE)
+    else if (serv->standby_worker_num > serv->worker_num)
     {
-        serv->max_connection = SW_SESSION_LIST_SIZE;
-        swWarn("serv->max_connection is exceed the SW_SESSION_LIST_SIZE, it's reset to %u.", SW_SESSION_LIST_SIZE);
+        serv->standby_worker_num = serv->worker_num;
+    }
+    //the manager of SWOOLE_BASE reloads through the process pool
+    if (serv->factory_mode != SW_MODE_PROCESS)
+    {
+        serv->reload_batch_num = 0;
+    }
+    else if (serv->reload_batch_ratio > 0)
+    {
+        uint16_t batch_num = SW_MAX((uint16_t) (serv->worker_num * serv->reload_batch_ratio), 1);
+        if (serv->reload_batch_num == 0 || serv->reload_batch_num > batch_num)
+        {
+            serv->reload_batch_num = batch_num;
+        }
+    }
+    //the events are already coalesced in the shared memory rings
+    if (serv->ipc_ring_size > 0 || serv->factory_mode != SW_MODE_PROCESS)
+    {
+        serv->ipc_batch_size = 0;
+    }
+    else if (serv->ipc_batch_size > 0)
+    {
+        serv->ipc_batch_size = SW_MAX(SW_IPC_MAX_SIZE * 2, SW_MIN(serv->ipc_batch_size, SW_IPC_BATCH_SIZE));
+    }
+    if (serv->ipc_low_watermark >= serv->ipc_high_watermark)
+    {
+        serv->ipc_low_watermark = serv->ipc_high_watermark / 2;
     }
     // package max length
     swListenPort *ls;
@@ -278,6 +363,31 @@ static int swServer_start_check(swServer *serv)
     {
         swSSL_init_thread_safety();
     }
+    /**
+     * allocated before the workers are forked, so that they can read the stats
+     */
+    if (serv->ssl_handshake_thread_num > 0)
+    {
+        int have_ssl = 0;
+        LL_FOREACH(serv->listen_list, ls)
+        {
+            have_ssl |= ls->ssl;
+        }
+        if (!have_ssl || serv->factory_mode != SW_MODE_PROCESS || serv->single_thread)
+        {
+            serv->ssl_handshake_thread_num = 0;
+        }
+        else
+        {
+            serv->ssl_handshake_threads = (swSSLHandshakeThread *) SwooleG.memory_pool->alloc(SwooleG.memory_pool,
+                    serv->ssl_handshake_thread_num * sizeof(swSSLHandshakeThread));
+            if (serv->ssl_handshake_threads == NULL)
+            {
+                swError("malloc[ssl_handshake_threads] failed");
+                return SW_ERR;
+            }
+        }
+    }
 #endif
 
     return SW_OK;
@@ -308,6 +418,17 @@ void swServer_store_listen_socket(swServer *serv)
                 serv->udp_socket_ipv6 = sockfd;
                 serv->connection_list[sockfd].info.addr.inet_v6.sin6_port = htons(ls->port);
             }
+#if defined(HAVE_RECVMMSG) && defined(UDP_GRO)
+            //the coalesced datagrams are split by swReactorThread_onPackage
+            if (ls->open_udp_gro && ls->type != SW_SOCK_UNIX_DGRAM)
+            {
+                int value = 1;
+                if (setsockopt(sockfd, SOL_UDP, UDP_GRO, &value, sizeof(value)) != 0)
+                {
+                    swSysError("setsockopt(UDP_GRO) failed.");
+                }
+            }
+#endif
         }
         else
         {
@@ -327,6 +448,20 @@ void swServer_store_listen_socket(swServer *serv)
             swServer_set_minfd(serv, sockfd);
             swServer_set_maxfd(serv, sockfd);
         }
+        //the same port listened by each reactor thread
+        if (ls->thread_socks)
+        {
+            int i;
+            for (i = 1; i < serv->reactor_num; i++)
+            {
+                serv->connection_list[ls->thread_socks[i]] = serv->connection_list[sockfd];
+                serv->connection_list[ls->thread_socks[i]].fd = ls->thread_socks[i];
+                if (ls->thread_socks[i] > swServer_get_maxfd(serv))
+                {
+                    swServer_set_maxfd(serv, ls->thread_socks[i]);
+                }
+            }
+        }
     }
 }
 
@@ -378,6 +513,10 @@ int swServer_create_task_worker(swServer *serv)
     {
         ipc_mode = SW_IPC_SOCKET;
     }
+    else if (serv->task_ipc_mode == SW_TASK_IPC_SHM_QUEUE)
+    {
+        ipc_mode = SW_IPC_SHM_QUEUE;
+    }
     else
     {
         ipc_mode = SW_IPC_UNIXSOCK;
@@ -424,16 +563,164 @@ int swServer_worker_create(swServer *serv, swWorker *worker)
     return SW_OK;
 }
 
+#ifdef HAVE_NUMA
+#define SW_NUMA_MAX_NODES     64
+
+static void swServer_numa_report(swServer *serv, int index, int num)
+{
+    char buf[SW_ERROR_MSG_SIZE];
+    int i, n;
+
+    n = snprintf(buf, sizeof(buf), "NUMA node %d: cpus=%d, reactor threads=[", serv->numa_nodes[index], CPU_COUNT(&serv->numa_cpus[index]));
+    for (i = index; serv->factory_mode == SW_MODE_PROCESS && i < serv->reactor_num && n < (int) sizeof(buf); i += serv->numa_node_num)
+    {
+        n += snprintf(buf + n, sizeof(buf) - n, i == index ? "%d" : ",%d", i);
+    }
+    if (n < (int) sizeof(buf))
+    {
+        n += snprintf(buf + n, sizeof(buf) - n, "], workers=[");
+    }
+    for (i = index; i < num && n < (int) sizeof(buf); i += serv->numa_node_num)
+    {
+        n += snprintf(buf + n, sizeof(buf) - n, i == index ? "%d" : ",%d", i);
+    }
+    if (n < (int) sizeof(buf))
+    {
+        snprintf(buf + n, sizeof(buf) - n, "]");
+    }
+    swNotice("%s", buf);
+}
+
+/**
+ * [Master] read the NUMA topology and report the layout
+ */
+static void swServer_numa_init(swServer *serv)
+{
+    int nodes[SW_NUMA_MAX_NODES];
+    int i, n;
+
+    n = swoole_numa_get_nodes(nodes, SW_NUMA_MAX_NODES);
+    if (n <= 0)
+    {
+        swWarn("NUMA topology is not available, open_numa_affinity is ignored.");
+        return;
+    }
+    serv->numa_nodes = (int *) sw_malloc(n * sizeof(int));
+    serv->numa_cpus = (cpu_set_t *) sw_malloc(n * sizeof(cpu_set_t));
+    if (serv->numa_nodes == NULL || serv->numa_cpus == NULL)
+    {
+        swWarn("malloc[numa_nodes] failed.");
+        if (serv->numa_nodes)
+        {
+            sw_free(serv->numa_nodes);
+            serv->numa_nodes = NULL;
+        }
+        if (serv->numa_cpus)
+        {
+            sw_free(serv->numa_cpus);
+            serv->numa_cpus = NULL;
+        }
+        return;
+    }
+    //memory-only nodes have no CPU to run on
+    for (i = 0; i < n; i++)
+    {
+        if (swoole_numa_get_cpus(nodes[i], &serv->numa_cpus[serv->numa_node_num]) > 0)
+        {
+            serv->numa_nodes[serv->numa_node_num++] = nodes[i];
+        }
+    }
+
+    int worker_num = serv->worker_num + serv->task_worker_num;
+    for (i = 0; i < serv->numa_node_num; i++)
+    {
+        swServer_numa_report(serv, i, worker_num);
+    }
+    if (serv->factory_mode == SW_MODE_PROCESS)
+    {
+        swNotice("NUMA memory: connection_list and session_list are interleaved, "
+                "send_shm and the IPC rings are bound to the node of the process reading them.");
+    }
+}
+
+/**
+ * the CPUs of the node for reactor thread or worker id, a single CPU of them with open_cpu_affinity
+ */
+void swServer_get_numa_cpus(swServer *serv, int id, cpu_set_t *cpu_set)
+{
+    int index = swServer_get_numa_index(serv, id);
+    cpu_set_t *node_cpus = &serv->numa_cpus[index];
+
+    if (!serv->open_cpu_affinity)
+    {
+        *cpu_set = *node_cpus;
+        return;
+    }
+
+    int i, k = (id / serv->numa_node_num) % CPU_COUNT(node_cpus);
+    CPU_ZERO(cpu_set);
+    for (i = 0; i < CPU_SETSIZE; i++)
+    {
+        if (CPU_ISSET(i, node_cpus) && k-- == 0)
+        {
+            CPU_SET(i, cpu_set);
+            break;
+        }
+    }
+}
+
+/**
+ * [Master] bind the shared memory before the workers are forked
+ */
+void swServer_numa_bind_memory(swServer *serv)
+{
+    int i, j;
+
+    if (!swServer_numa_enabled(serv))
+    {
+        return;
+    }
+    sw_shm_numa_bind(serv->connection_list, -1);
+    sw_shm_numa_bind(serv->session_list, -1);
+
+    for (i = 0; i < serv->worker_num; i++)
+    {
+        int worker_node = serv->numa_nodes[swServer_get_numa_index(serv, i)];
+        swWorker *worker = swServer_get_worker(serv, i);
+        if (worker->send_shm)
+        {
+            sw_shm_numa_bind(worker->send_shm, worker_node);
+        }
+        if (serv->ipc_rings == NULL)
+        {
+            continue;
+        }
+        for (j = 0; j < serv->reactor_num; j++)
+        {
+            sw_shm_numa_bind(swServer_get_ipc_ring(serv, j, i), worker_node);
+            sw_shm_numa_bind(swServer_get_response_ring(serv, i, j), serv->numa_nodes[swServer_get_numa_index(serv, j)]);
+        }
+    }
+}
+#endif
+
 /**
  * [Worker]
  */
 int swServer_worker_init(swServer *serv, swWorker *worker)
 {
 #ifdef HAVE_CPU_AFFINITY
-    if (serv->open_cpu_affinity)
+    if (serv->open_cpu_affinity || swServer_numa_enabled(serv))
     {
         cpu_set_t cpu_set;
         CPU_ZERO(&cpu_set);
+#ifdef HAVE_NUMA
+        if (swServer_numa_enabled(serv))
+        {
+            swServer_get_numa_cpus(serv, SwooleWG.id, &cpu_set);
+        }
+        else
+#endif
         if (serv->cpu_affinity_available_num)
         {
             CPU_SET(serv->cpu_affinity_available[SwooleWG.id % serv->cpu_affinity_available_num], &cpu_set);
@@ -480,9 +767,13 @@ int swServer_worker_init(swServer *serv, swWorker *worker)
         }
     }
 
-    worker->start_time = serv->gs->now;
-    worker->request_time = 0;
-    worker->request_count = 0;
+    //the slot is still used by the worker that the standby worker replaces
+    if (!SwooleWG.standby)
+    {
+        worker->start_time = serv->gs->now;
+        worker->request_time = 0;
+        worker->request_count = 0;
+    }
 
     return SW_OK;
 }
@@ -587,6 +878,14 @@ int swServer_start(swServer *serv)
     //master pid
     serv->gs->master_pid = getpid();
     serv->gs->now = serv->stats->start_time = time(NULL);
+    swServer_handoff_init(serv);
+
+#ifdef HAVE_NUMA
+    if (serv->open_numa_affinity)
+    {
+        swServer_numa_init(serv);
+    }
+#endif
 
     /**
      * init method
@@ -637,6 +936,18 @@ int swServer_start(swServer *serv)
         }
     }
 
+    /**
+     * large task packages and results are written to the arena once, instead of tmpfiles
+     */
+    if (serv->task_worker_num > 0 && serv->task_shm_size > 0)
+    {
+        serv->task_shm = swPagePool_new(serv->task_shm_size, SW_TASK_SHM_PAGE_SIZE, 1);
+        if (serv->task_shm == NULL)
+        {
+            swWarn("create task shared memory failed, use tmpfile instead.");
+        }
+    }
+
     /**
      * user worker process
      */
@@ -680,8 +991,8 @@ int swServer_start(swServer *serv)
     }
     swServer_free(serv);
     serv->gs->start = 0;
-    //remove PID file
-    if (serv->pid_file)
+    //remove PID file, unless it has been written by the new master
+    if (serv->pid_file && !serv->handoff_sent)
     {
         unlink(serv->pid_file);
     }
@@ -701,11 +1012,15 @@ void swServer_init(swServer *serv)
     serv->reactor_num = SW_REACTOR_NUM > SW_REACTOR_MAX_THREAD ? SW_REACTOR_MAX_THREAD : SW_REACTOR_NUM;
 
     serv->dispatch_mode = SW_DISPATCH_FDMOD;
+    serv->reactor_dispatch_mode = SW_REACTOR_DISPATCH_FDMOD;
 
     serv->worker_num = SW_CPU_NUM;
     serv->max_connection = SW_MIN(SW_MAX_CONNECTION, SwooleG.max_sockets);
 
     serv->max_wait_time = SW_WORKER_MAX_WAIT_TIME;
+    serv->reload_ready_timeout = SW_RELOAD_READY_TIMEOUT;
+    serv->task_shm_size = SW_TASK_SHM_SIZE;
+    serv->handoff_conn = -1;
 
     //http server
     serv->http_parse_post = 1;
@@ -715,6 +1030,7 @@ void swServer_init(swServer *serv)
 
     serv->buffer_input_size = SW_BUFFER_INPUT_SIZE;
     serv->buffer_output_size = SW_BUFFER_OUTPUT_SIZE;
+    serv->ipc_high_watermark = SW_IPC_HIGH_WATERMARK;
 
     serv->task_ipc_mode = SW_TASK_IPC_UNIXSOCK;
 
@@ -737,6 +1053,29 @@ void swServer_init(swServer *serv)
     SwooleG.serv = serv;
 }
 
+/**
+ * connection_list and session_list are sized from max_connection
+ */
+static void swServer_check_max_connection(swServer *serv)
+{
+    uint32_t minimum_connection = (serv->worker_num + serv->task_worker_num) * 2 + 32;
+    if (serv->max_connection < minimum_connection)
+    {
+        serv->max_connection = SwooleG.max_sockets;
+        swWarn("serv->max_connection must be bigger than %u, it's reset to %u", minimum_connection, SwooleG.max_sockets);
+    }
+    else if (SwooleG.max_sockets > 0 && serv->max_connection > SwooleG.max_sockets)
+    {
+        serv->max_connection = SwooleG.max_sockets;
+        swWarn("serv->max_connection is exceed the maximum value, it's reset to %u.", SwooleG.max_sockets);
+    }
+    else if (serv->max_connection > SW_SESSION_MAX_NUM)
+    {
+        serv->max_connection = SW_SESSION_MAX_NUM;
+        swWarn("serv->max_connection is exceed the SW_SESSION_MAX_NUM, it's reset to %u.", SW_SESSION_MAX_NUM);
+    }
+}
+
 int swServer_create(swServer *serv)
 {
     serv->factory.ptr = serv;
@@ -744,13 +1083,24 @@ int swServer_create(swServer *serv)
      * init current time
      */
     swServer_master_update_time(serv);
+    swServer_check_max_connection(serv);
 
-    serv->session_list = (swSession *) sw_shm_calloc(SW_SESSION_LIST_SIZE, sizeof(swSession));
+    /**
+     * at least half of the slots are free, a new session finds one in a few steps,
+     * and a slot is reused only after all the other free slots
+     */
+    uint32_t session_list_size = 1024;
+    while (session_list_size < serv->max_connection * 2)
+    {
+        session_list_size <<= 1;
+    }
+    serv->session_list = (swSession *) sw_shm_calloc(session_list_size, sizeof(swSession));
     if (serv->session_list == NULL)
     {
-        swError("sw_shm_calloc(%ld) for session_list failed", SW_SESSION_LIST_SIZE * sizeof(swSession));
+        swError("sw_shm_calloc(%ld) for session_list failed", (long) (session_list_size * sizeof(swSession)));
         return SW_ERR;
     }
+    serv->session_list_mask = session_list_size - 1;
 
     if (serv->factory_mode == SW_MODE_BASE)
     {
@@ -818,6 +1168,12 @@ int swServer_free(swServer *serv)
     {
         swPort_free(port);
     }
+    swServer_handoff_free(serv);
+    if (serv->task_shm)
+    {
+        serv->task_shm->destroy(serv->task_shm);
+        serv->task_shm = NULL;
+    }
     //close log file
     if (SwooleG.log_file != 0)
     {
@@ -970,8 +1326,7 @@ int swServer_master_send(swServer *serv, swSendData *_send)
     else
     {
         reactor = &(serv->reactor_threads[conn->from_id].reactor);
-        assert(fd % serv->reactor_num == reactor->id);
-        assert(fd % serv->reactor_num == SwooleTG.id);
+        assert(conn->from_id == SwooleTG.id);
     }
 
     if (serv->factory_mode == SW_MODE_BASE && conn->overflow)
@@ -1005,28 +1360,35 @@ int swServer_master_send(swServer *serv, swSendData *_send)
      */
     else if (_send->info.type == SW_EVENT_PAUSE_RECV)
     {
-        if (conn->events & SW_EVENT_WRITE)
+        if (swConnection_recv_paused(conn))
         {
-            return reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_WRITE);
+            conn->pause_recv = 1;
+            return SW_OK;
         }
-        else
+        //keep the fd registered like the ipc watermark does, the pending responses still go out
+        if (reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_DEAULT | (conn->events & SW_EVENT_WRITE)) < 0)
         {
-            return reactor->del(reactor, conn->fd);
+            return SW_ERR;
         }
+        conn->pause_recv = 1;
+        return SW_OK;
     }
     /**
      * resume recv data
      */
     else if (_send->info.type == SW_EVENT_RESUME_RECV)
     {
-        if (conn->events & SW_EVENT_WRITE)
+        if (!conn->pause_recv)
         {
-            return reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_READ | SW_EVENT_WRITE);
+            return SW_OK;
         }
-        else
+        conn->pause_recv = 0;
+        //still paused by the ipc watermark, EPOLLIN is armed again by swReactorThread_ipc_resume
+        if (conn->ipc_wait)
         {
-            return reactor->add(reactor, conn->fd, conn->fdtype | SW_EVENT_READ);
+            return SW_OK;
         }
+        return reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_READ | (conn->events & SW_EVENT_WRITE));
     }
 
     if (swBuffer_empty(conn->out_buffer))
@@ -1048,6 +1410,12 @@ int swServer_master_send(swServer *serv, swSendData *_send)
             {
                 goto buffer_send;
             }
+#ifdef HAVE_ZEROCOPY
+            if (conn->zerocopy && _send_length >= SW_ZEROCOPY_MIN_SIZE)
+            {
+                goto buffer_send;
+            }
+#endif
 
             ssize_t n;
 
@@ -1138,7 +1506,16 @@ int swServer_master_send(swServer *serv, swSendData *_send)
         while (_length > 0)
         {
             _n = _length >= SW_BUFFER_SIZE_BIG ? SW_BUFFER_SIZE_BIG : _length;
-            swBuffer_append(conn->out_buffer, _pos, _n);
+#ifdef HAVE_ZEROCOPY
+            if (conn->zerocopy && _n >= SW_ZEROCOPY_MIN_SIZE)
+            {
+                swBuffer_append_zerocopy(conn->out_buffer, _pos, _n);
+            }
+            else
+#endif
+            {
+                swBuffer_append(conn->out_buffer, _pos, _n);
+            }
             _pos += _n;
             _length -= _n;
         }
@@ -1152,7 +1529,7 @@ int swServer_master_send(swServer *serv, swSendData *_send)
     }
 
     //listen EPOLLOUT event
-    if (reactor->set(reactor, fd, SW_EVENT_TCP | SW_EVENT_WRITE | SW_EVENT_READ) < 0
+    if (reactor->set(reactor, fd, SW_EVENT_TCP | SW_EVENT_WRITE | (swConnection_recv_paused(conn) ? 0 : SW_EVENT_READ)) < 0
             && (errno == EBADF || errno == ENOENT))
     {
         goto close_fd;
@@ -1325,12 +1702,17 @@ void swServer_master_onTimer(swTimer *timer, swTimer_node *tnode)
 {
     swServer *serv = (swServer *) tnode->data;
     swServer_master_update_time(serv);
+    if (serv->factory_mode == SW_MODE_PROCESS)
+    {
+        swServer_master_update_event_rate(serv);
+    }
     if (serv->scheduler_warning && serv->warning_time < serv->gs->now)
     {
         serv->scheduler_warning = 0;
         serv->warning_time = serv->gs->now;
         swoole_error_log(SW_LOG_WARNING, SW_ERROR_SERVER_NO_IDLE_WORKER, "No idle worker is available.");
     }
+    swServer_handoff_check(serv);
 
     if (serv->hooks[SW_SERVER_HOOK_MASTER_TIMER])
     {
@@ -1358,6 +1740,23 @@ int swServer_add_worker(swServer *serv, swWorker *worker)
     return worker->id;
 }
 
+/**
+ * sample the read events of each reactor thread in the last second
+ */
+static void swServer_master_update_event_rate(swServer *serv)
+{
+    int i;
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        swReactorThread *thread = swServer_get_thread(serv, i);
+        int64_t rate = thread->event_rate;
+        int64_t count = thread->event_count;
+        int64_t sample = count - thread->last_event_count;
+        thread->last_event_count = count;
+        thread->event_rate = (uint32_t) (rate + (sample - rate) / (1 << SW_REACTOR_EWMA_SHIFT));
+    }
+}
+
 static void swServer_master_update_time(swServer *serv)
 {
     time_t now = time(NULL);
@@ -1591,6 +1990,8 @@ swListenPort* swServer_add_port(swServer *serv, int type, const char *host, int
 #ifdef SW_USE_OPENSSL
             ls->ssl_config.prefer_server_ciphers = 1;
             ls->ssl_config.session_tickets = 0;
+            ls->ssl_config.session_timeout = SW_SSL_SESSION_TIMEOUT;
+            ls->ssl_config.ticket_key_rotate = SW_SSL_TICKET_KEY_ROTATE;
             ls->ssl_config.stapling = 1;
             ls->ssl_config.stapling_verify = 1;
             ls->ssl_config.ciphers = sw_strdup(SW_SSL_CIPHER_LIST);
@@ -1599,8 +2000,14 @@ swListenPort* swServer_add_port(swServer *serv, int type, const char *host, int
         }
     }
 
+    //the listening socket of the previous master
+    int sock = swServer_handoff_adopt(serv, ls);
+    if (sock >= 0)
+    {
+        goto _set_option;
+    }
     //create server socket
-    int sock = swSocket_create(ls->type);
+    sock = swSocket_create(ls->type);
     if (sock < 0)
     {
         swSysError("create socket failed.");
@@ -1612,6 +2019,7 @@ swListenPort* swServer_add_port(swServer *serv, int type, const char *host, int
         close(sock);
         return NULL;
     }
+    _set_option:
     //dgram socket, setting socket buffer size
     if (swSocket_is_dgram(ls->type))
     {
@@ -1749,13 +2157,18 @@ static swConnection* swServer_connection_new(swServer *serv, swListenPort *ls, i
 {
     swConnection* connection = NULL;
 
-    serv->stats->accept_count++;
+    sw_atomic_fetch_add(&serv->stats->accept_count, 1);
     sw_atomic_fetch_add(&serv->stats->connection_num, 1);
     sw_atomic_fetch_add(&ls->connection_num, 1);
 
-    if (fd > swServer_get_maxfd(serv))
+    //reactor threads may accept at the same time
+    int maxfd;
+    while (fd > (maxfd = swServer_get_maxfd(serv)))
     {
-        swServer_set_maxfd(serv, fd);
+        if (sw_atomic_cmp_set(&swServer_get_maxfd(serv), maxfd, fd))
+        {
+            break;
+        }
     }
 
     connection = &(serv->connection_list[fd]);
@@ -1772,6 +2185,21 @@ static swConnection* swServer_connection_new(swServer *serv, swListenPort *ls, i
         connection->tcp_nodelay = 1;
     }
 
+#ifdef HAVE_ZEROCOPY
+    //the completions are read by the reactor threads
+    if (ls->open_tcp_zerocopy && serv->factory_mode == SW_MODE_PROCESS && !ls->ssl && ls->type != SW_SOCK_UNIX_STREAM)
+    {
+        if (swSocket_set_zerocopy(fd) != 0)
+        {
+            swSysError("setsockopt(SO_ZEROCOPY) failed.");
+        }
+        else
+        {
+            connection->zerocopy = 1;
+        }
+    }
+#endif
+
     //socket recv buffer size
     if (ls->kernel_socket_recv_buffer_size > 0)
     {
@@ -1805,16 +2233,15 @@ static swConnection* swServer_connection_new(swServer *serv, swListenPort *ls, i
     }
 #endif
 
-    swSession *session;
+    swSession *session, new_session;
     sw_spinlock(&serv->gs->spinlock);
     uint32_t i;
     uint32_t session_id = serv->gs->session_round;
-    //get session id
-    for (i = 0; i < serv->max_connection; i++)
+    //get session id, the id of a slot grows by session_list_mask + 1 each time it is reused
+    for (i = 0; i <= serv->session_list_mask; i++)
     {
         session_id++;
-        //SwooleGS->session_round just has 24 bits size;
-        if (unlikely(session_id == 1 << 24))
+        if (unlikely(session_id > SW_MAX_SESSION_ID))
         {
             session_id = 1;
         }
@@ -1822,9 +2249,11 @@ static swConnection* swServer_connection_new(swServer *serv, swListenPort *ls, i
         //vacancy
         if (session->fd == 0)
         {
-            session->fd = fd;
-            session->id = session_id;
-            session->reactor_id = connection->from_id;
+            new_session.id = session_id;
+            new_session.fd = fd;
+            new_session.reactor_id = connection->from_id;
+            //workers read the slot without lock, write it with one store
+            __atomic_store_n(&session->value, new_session.value, __ATOMIC_RELEASE);
             break;
         }
     }
@@ -88,6 +88,11 @@ int swPort_enable_ssl_encrypt(swListenPort *ls)
         swWarn("swSSL_server_set_cipher() error.");
         return SW_ERR;
     }
+    if (swSSL_server_set_session_cache(ls->ssl_context, &ls->ssl_config) < 0)
+    {
+        swWarn("swSSL_server_set_session_cache() error.");
+        return SW_ERR;
+    }
     return SW_OK;
 }
 #endif
@@ -600,8 +605,8 @@ void swPort_free(swListenPort *port)
 
     close(port->sock);
 
-    //remove unix socket file
-    if (port->type == SW_SOCK_UNIX_STREAM || port->type == SW_SOCK_UNIX_DGRAM)
+    //remove unix socket file, unless the new master has taken it over
+    if ((port->type == SW_SOCK_UNIX_STREAM || port->type == SW_SOCK_UNIX_DGRAM) && !port->handoff_sent)
     {
         unlink(port->host);
     }
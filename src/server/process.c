@@ -22,9 +22,11 @@
 static int swFactoryProcess_start(swFactory *factory);
 static int swFactoryProcess_notify(swFactory *factory, swDataHead *event);
 static int swFactoryProcess_dispatch(swFactory *factory, swSendData *data);
+static int swFactoryProcess_send2worker(swServer *serv, swWorker *worker, swSendData *task);
 static int swFactoryProcess_finish(swFactory *factory, swSendData *data);
 static int swFactoryProcess_shutdown(swFactory *factory);
 static int swFactoryProcess_end(swFactory *factory, int fd);
+static int swFactoryProcess_create_rings(swServer *serv);
 
 int swFactoryProcess_create(swFactory *factory, int worker_num)
 {
@@ -47,6 +49,32 @@ int swFactoryProcess_create(swFactory *factory, int worker_num)
     return SW_OK;
 }
 
+/**
+ * one ring for each reactor thread and worker pair, so that both sides need no lock
+ */
+static int swFactoryProcess_create_rings(swServer *serv)
+{
+    int i, n = serv->reactor_num * serv->worker_num;
+
+    serv->ipc_rings = SwooleG.memory_pool->alloc(SwooleG.memory_pool, n * sizeof(swShmRing *));
+    serv->ipc_response_rings = SwooleG.memory_pool->alloc(SwooleG.memory_pool, n * sizeof(swShmRing *));
+    if (serv->ipc_rings == NULL || serv->ipc_response_rings == NULL)
+    {
+        swWarn("[Master] malloc[ipc_rings] failed");
+        return SW_ERR;
+    }
+    for (i = 0; i < n; i++)
+    {
+        serv->ipc_rings[i] = swShmRing_new(serv->ipc_ring_size);
+        serv->ipc_response_rings[i] = swShmRing_new(serv->ipc_ring_size);
+        if (serv->ipc_rings[i] == NULL || serv->ipc_response_rings[i] == NULL)
+        {
+            return SW_ERR;
+        }
+    }
+    return SW_OK;
+}
+
 static int swFactoryProcess_shutdown(swFactory *factory)
 {
     int status;
@@ -62,6 +90,18 @@ static int swFactoryProcess_shutdown(swFactory *factory)
         swSysError("waitpid(%d) failed.", serv->gs->manager_pid);
     }
 
+    if (serv->ipc_rings)
+    {
+        int i;
+        for (i = 0; i < serv->reactor_num * serv->worker_num; i++)
+        {
+            swShmRing_free(serv->ipc_rings[i]);
+            swShmRing_free(serv->ipc_response_rings[i]);
+        }
+        serv->ipc_rings = NULL;
+        serv->ipc_response_rings = NULL;
+    }
+
     return SW_OK;
 }
 
@@ -98,6 +138,18 @@ static int swFactoryProcess_start(swFactory *factory)
 
     serv->reactor_pipe_num = serv->worker_num / serv->reactor_num;
 
+    if (serv->ipc_ring_size > 0 && serv->dispatch_mode != SW_DISPATCH_STREAM)
+    {
+        if (swFactoryProcess_create_rings(serv) < 0)
+        {
+            return SW_ERR;
+        }
+    }
+
+#ifdef HAVE_NUMA
+    swServer_numa_bind_memory(serv);
+#endif
+
     /**
      * The manager process must be started first, otherwise it will have a thread fork
      */
@@ -128,6 +180,7 @@ static int swFactoryProcess_notify(swFactory *factory, swDataHead *ev)
 static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
 {
     swServer *serv = (swServer *) factory->ptr;
+    swConnection *conn = NULL;
     int fd = task->info.fd;
 
     int target_worker_id = swServer_worker_schedule(serv, fd, task);
@@ -144,7 +197,7 @@ static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
 
     if (swEventData_is_stream(task->info.type))
     {
-        swConnection *conn = swServer_connection_get(serv, fd);
+        conn = swServer_connection_get(serv, fd);
         if (conn == NULL || conn->active == 0)
         {
             swWarn("dispatch[type=%d] failed, connection#%d is not active.", task->info.type, fd);
@@ -170,9 +223,14 @@ static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
     if (task->data == NULL)
     {
         task->info.flags = 0;
+        if (serv->ipc_rings && SwooleTG.type == SW_THREAD_REACTOR)
+        {
+            return swReactorThread_send2ring(serv, worker, &task->info, NULL, 0);
+        }
         return swReactorThread_send2worker(serv, worker, &task->info, sizeof(task->info));
     }
 
+    int inflight = 0;
     switch (task->info.type)
     {
     case SW_EVENT_TCP6:
@@ -182,9 +240,39 @@ static int swFactoryProcess_dispatch(swFactory *factory, swSendData *task)
     case SW_EVENT_UDP6:
     case SW_EVENT_UNIX_DGRAM:
         worker->dispatch_count++;
+        if (serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD)
+        {
+            sw_atomic_fetch_add(&worker->inflight, 1);
+            inflight = 1;
+        }
+        //backpressure, the worker is not keeping up with the connection
+        if (conn && serv->ipc_high_watermark > 0 && SwooleTG.type == SW_THREAD_REACTOR)
+        {
+            swReactorThread_ipc_pause(serv, conn, target_worker_id);
+        }
         break;
     }
 
+    int ret = swFactoryProcess_send2worker(serv, worker, task);
+    //the request never reaches the worker, it will not be finished
+    if (ret < 0 && inflight)
+    {
+        sw_atomic_fetch_sub(&worker->inflight, 1);
+    }
+    return ret;
+}
+
+/**
+ * [ReactorThread] write the request into the ring or the pipe of the worker
+ */
+static int swFactoryProcess_send2worker(swServer *serv, swWorker *worker, swSendData *task)
+{
+    //written into the shared memory ring once, without chunking at SW_IPC_BUFFER_SIZE
+    if (serv->ipc_rings && SwooleTG.type == SW_THREAD_REACTOR)
+    {
+        return swReactorThread_send2ring(serv, worker, &task->info, task->data, task->length);
+    }
+
     uint32_t send_n = task->length;
     uint32_t offset = 0;
     swEventData buf;
@@ -313,6 +401,17 @@ static int swFactoryProcess_finish(swFactory *factory, swSendData *resp)
         return SW_OK;
     }
 
+    /**
+     * shared memory ring of the reactor thread, many responses of any size can be in flight.
+     * an exiting worker shares the rings of its slot with the replacement, a ring has a single producer
+     */
+    if (serv->ipc_response_rings && SwooleG.main_reactor && SwooleWG.id < serv->worker_num && swIsWorker()
+            && !SwooleWG.wait_exit)
+    {
+        resp->info.from_id = conn->from_id;
+        return swWorker_send2ring(serv, &resp->info, resp->data, resp->length);
+    }
+
     /**
      * Big response, use shared memory
      */
@@ -22,6 +22,7 @@ static int swReactorProcess_onClose(swReactor *reactor, swEvent *event);
 static int swReactorProcess_send2client(swFactory *, swSendData *);
 static int swReactorProcess_send2worker(int, void *, int);
 static void swReactorProcess_onTimeout(swTimer *timer, swTimer_node *tnode);
+static void swReactorProcess_onWorkerReap(swProcessPool *pool, swWorker *worker, int status);
 
 #ifdef HAVE_REUSEPORT
 static int swReactorProcess_reuse_port(swListenPort *ls);
@@ -37,12 +38,18 @@ static bool swServer_is_single(swServer *serv)
 int swReactorProcess_create(swServer *serv)
 {
     serv->reactor_num = serv->worker_num;
-    serv->connection_list = (swConnection *) sw_calloc(serv->max_connection, sizeof(swConnection));
-    if (serv->connection_list == NULL)
+    /**
+     * an anonymous mapping starts on a page like the shared memory connection_list of SWOOLE_PROCESS,
+     * its pages are zeroed by the kernel when they are touched, so max_connection costs no memory up front
+     */
+    size_t size = (size_t) serv->max_connection * sizeof(swConnection);
+    void *list = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (list == MAP_FAILED)
     {
-        swSysError("calloc[2](%d) failed.", (int )(serv->max_connection * sizeof(swConnection)));
+        swSysError("mmap(%ld) failed.", (long) size);
         return SW_ERR;
     }
+    serv->connection_list = (swConnection *) list;
     //create factry object
     if (swFactory_create(&(serv->factory)) < 0)
     {
@@ -86,6 +93,11 @@ int swReactorProcess_start(swServer *serv)
         }
     }
 
+    if (swServer_handoff_start(serv, NULL) < 0)
+    {
+        return SW_ERR;
+    }
+
     if (swProcessPool_create(&serv->gs->event_workers, serv->worker_num, serv->max_request, 0, SW_IPC_UNIXSOCK) < 0)
     {
         return SW_ERR;
@@ -100,6 +112,7 @@ int swReactorProcess_start(swServer *serv)
     serv->gs->event_workers.use_msgqueue = 0;
     serv->gs->event_workers.main_loop = swReactorProcess_loop;
     serv->gs->event_workers.onWorkerNotFound = swManager_wait_other_worker;
+    serv->gs->event_workers.onWorkerReap = swReactorProcess_onWorkerReap;
 
     int i;
     for (i = 0; i < serv->worker_num; i++)
@@ -187,6 +200,7 @@ int swReactorProcess_start(swServer *serv)
         serv->onManagerStart(serv);
     }
 
+    swTaskWorker_check_queue(serv);
     swProcessPool_wait(&serv->gs->event_workers);
     swProcessPool_shutdown(&serv->gs->event_workers);
 
@@ -200,6 +214,11 @@ int swReactorProcess_start(swServer *serv)
     return SW_OK;
 }
 
+static void swReactorProcess_onWorkerReap(swProcessPool *pool, swWorker *worker, int status)
+{
+    swTaskWorker_reclaim((swServer *) pool->ptr, worker->pid);
+}
+
 static int swReactorProcess_onPipeRead(swReactor *reactor, swEvent *event)
 {
     swEventData task;
@@ -517,17 +536,18 @@ static int swReactorProcess_send2client(swFactory *factory, swSendData *_send)
         _send->length = _send->info.len;
     }
 
-    swSession *session = swServer_get_session(serv, session_id);
-    if (session->fd == 0)
+    swSession session;
+    swServer_load_session(serv, session_id, &session);
+    if (session.fd == 0)
     {
         swoole_error_log(SW_LOG_NOTICE, SW_ERROR_SESSION_NOT_EXIST, "send %d byte failed, session#%d does not exist.",  _send->length, session_id);
         return SW_ERR;
     }
     //proxy
-    if (session->reactor_id != SwooleWG.id)
+    if (session.reactor_id != SwooleWG.id)
     {
-        swTrace("session->reactor_id=%d, SwooleWG.id=%d", session->reactor_id, SwooleWG.id);
-        swWorker *worker = swProcessPool_get_worker(&serv->gs->event_workers, session->reactor_id);
+        swTrace("session.reactor_id=%d, SwooleWG.id=%d", session.reactor_id, SwooleWG.id);
+        swWorker *worker = swProcessPool_get_worker(&serv->gs->event_workers, session.reactor_id);
         swEventData proxy_msg;
 
         if (_send->info.type == SW_EVENT_TCP)
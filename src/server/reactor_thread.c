@@ -20,68 +20,204 @@
 #include "client.h"
 #include "websocket.h"
 
+#ifdef HAVE_REUSEPORT
+#include <linux/filter.h>
+#endif
+
 static int swReactorThread_loop(swThreadParam *param);
 static int swReactorThread_init_reactor(swServer *serv, swReactor *reactor, uint16_t reactor_id);
 static int swReactorThread_onPipeWrite(swReactor *reactor, swEvent *ev);
 static int swReactorThread_onPipeReceive(swReactor *reactor, swEvent *ev);
+static void swReactorThread_onRingReceive(swReactor *reactor);
+static int swReactorThread_ring_flush(swServer *serv, swReactorThread *thread, int worker_id);
 static int swReactorThread_onRead(swReactor *reactor, swEvent *ev);
 static int swReactorThread_onWrite(swReactor *reactor, swEvent *ev);
 static int swReactorThread_onPackage(swReactor *reactor, swEvent *event);
 static int swReactorThread_onClose(swReactor *reactor, swEvent *event);
+#ifdef HAVE_ZEROCOPY
+static int swReactorThread_onError(swReactor *reactor, swEvent *event);
+#endif
 static void swReactorThread_onStreamResponse(swStream *stream, char *data, uint32_t length);
+static void swReactorThread_onTimeout(swReactor *reactor);
+static void swReactorThread_ipc_resume(swReactor *reactor, swReactorThread *thread);
 
 static void swHeartbeatThread_start(swServer *serv);
 static void swHeartbeatThread_loop(swThreadParam *param);
 
 #ifdef SW_USE_OPENSSL
-static sw_inline int swReactorThread_verify_ssl_state(swReactor *reactor, swListenPort *port, swConnection *conn)
+static int swSSLHandshakeThread_start(swServer *serv);
+static void swSSLHandshakeThread_free(swServer *serv);
+#endif
+
+#define swReactorThread_enable_heartbeat(serv) \
+    (serv->heartbeat_check_interval >= 1 && serv->heartbeat_check_interval <= serv->heartbeat_idle_time)
+
+/**
+ * the reactor thread wakes up every heartbeat_check_interval to close the idle connections
+ */
+static sw_inline int swReactorThread_get_timeout_msec(swServer *serv)
+{
+    return swReactorThread_enable_heartbeat(serv) && !serv->single_thread ? serv->heartbeat_check_interval * 1000 : -1;
+}
+
+#ifdef SW_USE_OPENSSL
+static int swReactorThread_ssl_ready(swReactor *reactor, swListenPort *port, swConnection *conn)
 {
     swServer *serv = reactor->ptr;
-    if (conn->ssl_state == 0 && conn->ssl)
+    int ret;
+
+    if (port->ssl_option.client_cert_file)
     {
-        int ret = swSSL_accept(conn);
-        if (ret == SW_READY)
+        ret = swSSL_get_client_certificate(conn->ssl, SwooleTG.buffer_stack->str, SwooleTG.buffer_stack->size);
+        if (ret < 0)
+        {
+            goto no_client_cert;
+        }
+        else
         {
-            if (port->ssl_option.client_cert_file)
+            if (!port->ssl_option.verify_peer || swSSL_verify(conn, port->ssl_option.allow_self_signed) == SW_OK)
             {
-                ret = swSSL_get_client_certificate(conn->ssl, SwooleTG.buffer_stack->str, SwooleTG.buffer_stack->size);
-                if (ret < 0)
-                {
-                    goto no_client_cert;
-                }
-                else
-                {
-                    if (!port->ssl_option.verify_peer || swSSL_verify(conn, port->ssl_option.allow_self_signed) == SW_OK)
-                    {
-                        swFactory *factory = &serv->factory;
-                        swSendData task;
-                        task.info.fd = conn->fd;
-                        task.info.type = SW_EVENT_CONNECT;
-                        task.info.from_id = conn->from_id;
-                        task.data = SwooleTG.buffer_stack->str;
-                        task.length = ret;
-                        factory->dispatch(factory, &task);
-                        goto delay_receive;
-                    }
-                    else
-                    {
-                        return SW_ERR;
-                    }
-                }
+                swFactory *factory = &serv->factory;
+                swSendData task;
+                task.info.fd = conn->fd;
+                task.info.type = SW_EVENT_CONNECT;
+                task.info.from_id = conn->from_id;
+                task.data = SwooleTG.buffer_stack->str;
+                task.length = ret;
+                factory->dispatch(factory, &task);
+                goto delay_receive;
             }
-            no_client_cert:
-            if (port->ssl_option.verify_peer)
+            else
             {
                 return SW_ERR;
             }
-            if (serv->onConnect)
+        }
+    }
+    no_client_cert:
+    if (port->ssl_option.verify_peer)
+    {
+        return SW_ERR;
+    }
+    if (serv->onConnect)
+    {
+        serv->notify(serv, conn, SW_EVENT_CONNECT);
+    }
+    delay_receive:
+    if (serv->enable_delay_receive)
+    {
+        conn->listen_wait = 1;
+    }
+    return SW_OK;
+}
+
+/**
+ * move the connection to a handshake thread, the reactor thread stops watching it until it is handed back.
+ * returns SW_CONTINUE if the pipe of the handshake thread is full, the connection stays in the reactor thread
+ */
+static int swReactorThread_ssl_handover(swReactor *reactor, swConnection *conn)
+{
+    swServer *serv = reactor->ptr;
+    swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[conn->fd % serv->ssl_handshake_thread_num];
+    swDataHead ev;
+
+    //pairs with swSSLHandshakeThread_free(), either the connection is not handed over or it is seen there
+    __atomic_store_n(&conn->ssl_handshaking, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&hs_thread->exited, __ATOMIC_SEQ_CST))
+    {
+        conn->ssl_handshaking = 0;
+        return SW_ERR;
+    }
+    if (reactor->del(reactor, conn->fd) < 0)
+    {
+        conn->ssl_handshaking = 0;
+        return SW_ERR;
+    }
+    bzero(&ev, sizeof(ev));
+    ev.fd = conn->fd;
+    ev.from_id = reactor->id;
+    if (hs_thread->pipe.write(&hs_thread->pipe, &ev, sizeof(ev)) < 0)
+    {
+        conn->ssl_handshaking = 0;
+        if (swConnection_error(errno) == SW_WAIT)
+        {
+            return reactor->add(reactor, conn->fd, SW_FD_TCP | SW_EVENT_READ) < 0 ? SW_ERR : SW_CONTINUE;
+        }
+        swSysError("write(ssl_handshake_pipe) failed.");
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+/**
+ * [ReactorThread] the handshake thread has finished the handshake of the connection
+ */
+static int swReactorThread_ssl_handback(swReactor *reactor, int fd, int result)
+{
+    swServer *serv = reactor->ptr;
+    swConnection *conn = swServer_connection_get(serv, fd);
+    if (conn == NULL || !conn->ssl_handshaking)
+    {
+        return SW_ERR;
+    }
+    conn->ssl_handshaking = 0;
+    if (result != SW_READY || swReactorThread_ssl_ready(reactor, swServer_get_port(serv, fd), conn) < 0)
+    {
+        return swReactorThread_close(reactor, fd);
+    }
+    if (conn->listen_wait)
+    {
+        return SW_OK;
+    }
+    if (reactor->add(reactor, fd, SW_FD_TCP | SW_EVENT_READ) < 0)
+    {
+        return swReactorThread_close(reactor, fd);
+    }
+    //the records read ahead with the handshake are not signaled by the reactor again
+    swEvent event;
+    event.fd = fd;
+    event.from_id = reactor->id;
+    event.type = SW_FD_TCP;
+    event.socket = conn;
+    return swReactorThread_onRead(reactor, &event);
+}
+
+/**
+ * returns SW_WAIT if the connection is handed over to a handshake thread
+ */
+static sw_inline int swReactorThread_verify_ssl_state(swReactor *reactor, swListenPort *port, swConnection *conn)
+{
+    if (conn->ssl_state == 0 && conn->ssl)
+    {
+        int ret;
+#ifndef SSL_CLIENT_HELLO_SUCCESS
+        swServer *serv = reactor->ptr;
+        if (serv->ssl_handshake_threads && (ret = swReactorThread_ssl_handover(reactor, conn)) != SW_CONTINUE)
+        {
+            return ret < 0 ? SW_ERR : SW_WAIT;
+        }
+#endif
+        ret = swSSL_accept(conn);
+        //a full handshake, the session resumptions are cheap enough to finish in the reactor thread
+        if (ret == SW_CONTINUE)
+        {
+            ret = swReactorThread_ssl_handover(reactor, conn);
+            if (ret != SW_CONTINUE)
+            {
+                return ret < 0 ? SW_ERR : SW_WAIT;
+            }
+            //the handshake threads are too far behind, finish it here rather than block on the pipe
+            SwooleTG.ssl_handshake_inline = 1;
+            ret = swSSL_accept(conn);
+            SwooleTG.ssl_handshake_inline = 0;
+        }
+        if (ret == SW_READY)
+        {
+            if (swReactorThread_ssl_ready(reactor, port, conn) < 0)
             {
-                serv->notify(serv, conn, SW_EVENT_CONNECT);
+                return SW_ERR;
             }
-            delay_receive:
-            if (serv->enable_delay_receive)
+            if (conn->listen_wait)
             {
-                conn->listen_wait = 1;
                 return reactor->del(reactor, conn->fd);
             }
             return SW_OK;
@@ -117,22 +253,192 @@ static void swReactorThread_onStreamResponse(swStream *stream, char *data, uint3
     swServer_master_send(SwooleG.serv, &response);
 }
 
+static int swReactorThread_dispatch_packet(swFactory *factory, swSendData *task, swDgramPacket *pkt, int socket_type)
+{
+    //IPv4
+    if (socket_type == SW_SOCK_UDP)
+    {
+        memcpy(&task->info.fd, &pkt->info.addr.inet_v4.sin_addr, sizeof(task->info.fd));
+    }
+    //IPv6
+    else if (socket_type == SW_SOCK_UDP6)
+    {
+        memcpy(&task->info.fd, &pkt->info.addr.inet_v6.sin6_addr, sizeof(task->info.fd));
+    }
+#ifndef _WIN32
+    else
+    {
+        task->info.fd = swoole_crc32(pkt->info.addr.un.sun_path, pkt->info.len);
+    }
+#endif
+
+    task->length = sizeof(*pkt) + pkt->length;
+    task->data = (char*) pkt;
+
+    return factory->dispatch(factory, task);
+}
+
+#ifdef HAVE_RECVMMSG
+static swDgramBatch* swReactorThread_get_dgram_batch()
+{
+    if (SwooleTG.dgram_batch)
+    {
+        return SwooleTG.dgram_batch;
+    }
+
+    int i;
+    size_t packet_size = sizeof(swDgramPacket) + SW_BUFFER_SIZE_UDP;
+    swDgramBatch *batch = sw_malloc(sizeof(swDgramBatch));
+    if (batch == NULL)
+    {
+        return NULL;
+    }
+    char *buffer = sw_malloc(packet_size * SW_UDP_BATCH_NUM);
+    if (buffer == NULL)
+    {
+        sw_free(batch);
+        return NULL;
+    }
+    bzero(batch, sizeof(swDgramBatch));
+    for (i = 0; i < SW_UDP_BATCH_NUM; i++)
+    {
+        batch->packets[i] = (swDgramPacket *) (buffer + packet_size * i);
+        batch->iov[i].iov_base = batch->packets[i]->data;
+        batch->iov[i].iov_len = SW_BUFFER_SIZE_UDP;
+    }
+    SwooleTG.dgram_batch = batch;
+    return batch;
+}
+
+static void swReactorThread_free_dgram_batch()
+{
+    if (SwooleTG.dgram_batch)
+    {
+        sw_free(SwooleTG.dgram_batch->packets[0]);
+        sw_free(SwooleTG.dgram_batch);
+        SwooleTG.dgram_batch = NULL;
+    }
+}
+
+/**
+ * [UDP_GRO] the size of the coalesced datagrams, 0 if it is a single one
+ */
+static sw_inline int swReactorThread_get_gro_size(struct msghdr *msg)
+{
+    int gso_size = 0;
+#ifdef UDP_GRO
+    struct cmsghdr *cmsg;
+    for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg))
+    {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+        {
+            memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            break;
+        }
+    }
+#endif
+    return gso_size;
+}
+
+/**
+ * receive up to SW_UDP_BATCH_NUM datagrams with one recvmmsg(), then dispatch them one by one,
+ * with ipc_batch_size the ones to the same worker are written to the pipe together.
+ */
+static int swReactorThread_recv_batch(swFactory *factory, int fd, swSendData *task, int socket_type)
+{
+    swDgramBatch *batch = swReactorThread_get_dgram_batch();
+    swDgramPacket *pkt;
+    struct msghdr *msg;
+    int i, n, gso_size;
+    uint32_t offset, length;
+
+    if (batch == NULL)
+    {
+        return SW_ERR;
+    }
+
+    do_recvmmsg:
+    for (i = 0; i < SW_UDP_BATCH_NUM; i++)
+    {
+        msg = &batch->msgs[i].msg_hdr;
+        msg->msg_name = &batch->packets[i]->info.addr;
+        msg->msg_namelen = sizeof(batch->packets[i]->info.addr);
+        msg->msg_iov = &batch->iov[i];
+        msg->msg_iovlen = 1;
+        msg->msg_control = batch->control[i];
+        msg->msg_controllen = sizeof(batch->control[i]);
+        msg->msg_flags = 0;
+    }
+
+    n = recvmmsg(fd, batch->msgs, SW_UDP_BATCH_NUM, 0, NULL);
+    if (n < 0)
+    {
+        if (errno == EAGAIN)
+        {
+            return SW_OK;
+        }
+        else if (errno == EINTR)
+        {
+            goto do_recvmmsg;
+        }
+        swSysError("recvmmsg(%d) failed.", fd);
+        return SW_ERR;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        msg = &batch->msgs[i].msg_hdr;
+        pkt = batch->packets[i];
+        pkt->info.len = msg->msg_namelen;
+        length = batch->msgs[i].msg_len;
+        gso_size = swReactorThread_get_gro_size(msg);
+
+        if (gso_size <= 0 || (uint32_t) gso_size >= length)
+        {
+            pkt->length = length;
+            if (swReactorThread_dispatch_packet(factory, task, pkt, socket_type) < 0)
+            {
+                return SW_ERR;
+            }
+            continue;
+        }
+        /**
+         * split the coalesced datagrams, the header of a segment is written over the previous one,
+         * which is already copied to the worker.
+         */
+        swSocketAddress addr = pkt->info;
+        for (offset = 0; offset < length; offset += gso_size)
+        {
+            swDgramPacket *segment = (swDgramPacket *) (pkt->data + offset - sizeof(swDgramPacket));
+            segment->info = addr;
+            segment->length = SW_MIN((uint32_t) gso_size, length - offset);
+            if (swReactorThread_dispatch_packet(factory, task, segment, socket_type) < 0)
+            {
+                return SW_ERR;
+            }
+        }
+    }
+
+    if (n == SW_UDP_BATCH_NUM)
+    {
+        goto do_recvmmsg;
+    }
+    return SW_OK;
+}
+#endif
+
 /**
  * for udp
  */
 static int swReactorThread_onPackage(swReactor *reactor, swEvent *event)
 {
     int fd = event->fd;
-    int ret;
 
     swServer *serv = SwooleG.serv;
     swConnection *server_sock = &serv->connection_list[fd];
     swSendData task;
-    swDgramPacket *pkt = (swDgramPacket *) SwooleTG.buffer_stack->str;
     swFactory *factory = &serv->factory;
 
-    pkt->info.len = sizeof(pkt->info.addr);
-
     bzero(&task.info, sizeof(task.info));
     task.info.from_fd = fd;
     task.info.from_id = SwooleTG.id;
@@ -155,7 +461,14 @@ static int swReactorThread_onPackage(swReactor *reactor, swEvent *event)
         break;
     }
 
-    do_recvfrom: ret = recvfrom(fd, pkt->data, SwooleTG.buffer_stack->size - sizeof(*pkt), 0,
+#ifdef HAVE_RECVMMSG
+    return swReactorThread_recv_batch(factory, fd, &task, socket_type);
+#else
+    swDgramPacket *pkt = (swDgramPacket *) SwooleTG.buffer_stack->str;
+
+    do_recvfrom:
+    pkt->info.len = sizeof(pkt->info.addr);
+    int ret = recvfrom(fd, pkt->data, SwooleTG.buffer_stack->size - sizeof(*pkt), 0,
             (struct sockaddr *) &pkt->info.addr, &pkt->info.len);
 
     if (ret <= 0)
@@ -171,28 +484,8 @@ static int swReactorThread_onPackage(swReactor *reactor, swEvent *event)
         }
     }
 
-    //IPv4
-    if (socket_type == SW_SOCK_UDP)
-    {
-        memcpy(&task.info.fd, &pkt->info.addr.inet_v4.sin_addr, sizeof(task.info.fd));
-    }
-    //IPv6
-    else if (socket_type == SW_SOCK_UDP6)
-    {
-        memcpy(&task.info.fd, &pkt->info.addr.inet_v6.sin6_addr, sizeof(task.info.fd));
-    }
-#ifndef _WIN32
-    else
-    {
-        task.info.fd = swoole_crc32(pkt->info.addr.un.sun_path, pkt->info.len);
-    }
-#endif
-
     pkt->length = ret;
-    task.length = sizeof(*pkt) + ret;
-    task.data = (char*) pkt;
-
-    if (factory->dispatch(factory, &task) < 0)
+    if (swReactorThread_dispatch_packet(factory, &task, pkt, socket_type) < 0)
     {
         return SW_ERR;
     }
@@ -200,6 +493,7 @@ static int swReactorThread_onPackage(swReactor *reactor, swEvent *event)
     {
         goto do_recvfrom;
     }
+#endif
 }
 
 /**
@@ -217,8 +511,8 @@ int swReactorThread_close(swReactor *reactor, int fd)
 
     if (serv->factory_mode == SW_MODE_PROCESS)
     {
-        assert(fd % serv->reactor_num == reactor->id);
-        assert(fd % serv->reactor_num == SwooleTG.id);
+        assert(conn->from_id == reactor->id);
+        assert(conn->from_id == SwooleTG.id);
     }
 
     if (conn->removed == 0 && reactor->del(reactor, fd) < 0)
@@ -228,6 +522,10 @@ int swReactorThread_close(swReactor *reactor, int fd)
 
     sw_atomic_fetch_add(&serv->stats->close_count, 1);
     sw_atomic_fetch_sub(&serv->stats->connection_num, 1);
+    if (serv->factory_mode == SW_MODE_PROCESS)
+    {
+        sw_atomic_fetch_sub(&swServer_get_thread(serv, reactor->id)->connection_num, 1);
+    }
 
     swTrace("Close Event.fd=%d|from=%d", fd, reactor->id);
 
@@ -267,8 +565,10 @@ int swReactorThread_close(swReactor *reactor, int fd)
     }
 #endif
 
-    swSession *session = swServer_get_session(serv, conn->session_id);
-    session->fd = 0;
+    swSession session;
+    swServer_load_session(serv, conn->session_id, &session);
+    session.fd = 0;
+    __atomic_store_n(&swServer_get_session(serv, conn->session_id)->value, session.value, __ATOMIC_RELEASE);
 
     /**
      * reset maxfd, for connection_list
@@ -300,8 +600,8 @@ static int swReactorThread_onClose(swReactor *reactor, swEvent *event)
     swDataHead notify_ev;
     bzero(&notify_ev, sizeof(notify_ev));
 
-    assert(fd % serv->reactor_num == reactor->id);
-    assert(fd % serv->reactor_num == SwooleTG.id);
+    assert(serv->connection_list[fd].from_id == reactor->id);
+    assert(serv->connection_list[fd].from_id == SwooleTG.id);
 
     notify_ev.from_id = reactor->id;
     notify_ev.fd = fd;
@@ -337,6 +637,36 @@ static int swReactorThread_onClose(swReactor *reactor, swEvent *event)
     }
 }
 
+#ifdef HAVE_ZEROCOPY
+/**
+ * EPOLLERR is also raised by the MSG_ZEROCOPY completions in the error queue,
+ * close the connection only if the socket is broken after they are read.
+ */
+static int swReactorThread_onError(swReactor *reactor, swEvent *event)
+{
+    swServer *serv = reactor->ptr;
+    swConnection *conn = swServer_connection_get(serv, event->fd);
+    if (conn && conn->active && conn->zerocopy_buffer)
+    {
+        swConnection_zerocopy_complete(conn);
+
+        int error = 0;
+        socklen_t len = sizeof(error);
+        struct pollfd pfd;
+        pfd.fd = event->fd;
+        pfd.events = POLLRDHUP;
+        pfd.revents = 0;
+
+        if (getsockopt(event->fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0
+                && poll(&pfd, 1, 0) >= 0 && !(pfd.revents & (POLLHUP | POLLRDHUP)))
+        {
+            return SW_OK;
+        }
+    }
+    return reactor->handle[SW_FD_CLOSE](reactor, event);
+}
+#endif
+
 /**
  * receive data from worker process pipe
  */
@@ -359,6 +689,14 @@ static int swReactorThread_onPipeReceive(swReactor *reactor, swEvent *ev)
         if (n > 0)
         {
             memcpy(&_send.info, &resp.info, sizeof(resp.info));
+            /**
+             * an exiting worker sends through the pipe what it wrote to the ring before,
+             * the ring is drained first so the responses of a connection stay in order
+             */
+            if (serv->ipc_response_rings && _send.info.from_fd <= SW_RESPONSE_TMPFILE)
+            {
+                swReactorThread_onRingReceive(reactor);
+            }
             //pipe data
             if (_send.info.from_fd == SW_RESPONSE_SMALL)
             {
@@ -401,6 +739,21 @@ static int swReactorThread_onPipeReceive(swReactor *reactor, swEvent *ev)
                 _send.length = data->length;
                 swServer_master_send(serv, &_send);
             }
+            //the worker has released some space of the ring
+            else if (_send.info.from_fd == SW_RESPONSE_RING_RESUME)
+            {
+                swReactorThread_ring_flush(serv, swServer_get_thread(serv, reactor->id), _send.info.fd);
+            }
+            else if (_send.info.from_fd == SW_RESPONSE_RING_NOTIFY)
+            {
+                //wake up only, the responses are sent in swReactorThread_onRingReceive
+            }
+#ifdef SW_USE_OPENSSL
+            else if (_send.info.from_fd == SW_RESPONSE_SSL_HANDSHAKE)
+            {
+                swReactorThread_ssl_handback(reactor, _send.info.fd, _send.info.len);
+            }
+#endif
             //reactor thread exit
             else if (_send.info.from_fd == SW_RESPONSE_EXIT)
             {
@@ -427,51 +780,148 @@ static int swReactorThread_onPipeReceive(swReactor *reactor, swEvent *ev)
     return SW_OK;
 }
 
-int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, int len)
+static int swReactorThread_pipe_write(swServer *serv, swWorker *worker, void *data, int len)
 {
     int ret = -1;
+    int pipe_fd = worker->pipe_master;
+    int thread_id = serv->connection_list[pipe_fd].from_id;
+    swReactorThread *thread = swServer_get_thread(serv, thread_id);
+    swLock *lock = serv->connection_list[pipe_fd].object;
 
-    //reactor thread
-    if (SwooleTG.type == SW_THREAD_REACTOR)
-    {
-        int pipe_fd = worker->pipe_master;
-        int thread_id = serv->connection_list[pipe_fd].from_id;
-        swReactorThread *thread = swServer_get_thread(serv, thread_id);
-        swLock *lock = serv->connection_list[pipe_fd].object;
-
-        //lock thread
-        lock->lock(lock);
+    //lock thread
+    lock->lock(lock);
 
-        swBuffer *buffer = serv->connection_list[pipe_fd].in_buffer;
-        if (swBuffer_empty(buffer))
-        {
-            ret = write(pipe_fd, (void *) data, len);
-            if (ret < 0 && swConnection_error(errno) == SW_WAIT)
-            {
-                if (thread->reactor.set(&thread->reactor, pipe_fd, SW_FD_PIPE | SW_EVENT_READ | SW_EVENT_WRITE) < 0)
-                {
-                    swSysError("reactor->set(%d, PIPE | READ | WRITE) failed.", pipe_fd);
-                }
-                goto append_pipe_buffer;
-            }
-        }
-        else
+    swBuffer *buffer = serv->connection_list[pipe_fd].in_buffer;
+    if (swBuffer_empty(buffer))
+    {
+        ret = write(pipe_fd, (void *) data, len);
+        if (ret < 0 && swConnection_error(errno) == SW_WAIT)
         {
-            append_pipe_buffer:
-            if (swBuffer_append(buffer, data, len) < 0)
+            if (thread->reactor.set(&thread->reactor, pipe_fd, SW_FD_PIPE | SW_EVENT_READ | SW_EVENT_WRITE) < 0)
             {
-                swWarn("append to pipe_buffer failed.");
-                ret = SW_ERR;
-            }
-            else
-            {
-                ret = SW_OK;
+                swSysError("reactor->set(%d, PIPE | READ | WRITE) failed.", pipe_fd);
             }
+            goto append_pipe_buffer;
         }
-        //release thread lock
-        lock->unlock(lock);
     }
-    //master/udp thread
+    else
+    {
+        append_pipe_buffer:
+        if (swBuffer_append(buffer, data, len) < 0)
+        {
+            swWarn("append to pipe_buffer failed.");
+            ret = SW_ERR;
+        }
+        else
+        {
+            ret = SW_OK;
+        }
+    }
+    //release thread lock
+    lock->unlock(lock);
+    return ret;
+}
+
+/**
+ * [ReactorThread] write the coalesced events to the worker in one pipe message
+ */
+static int swReactorThread_batch_flush(swServer *serv, swReactorThread *thread, int worker_id)
+{
+    swString *batch = thread->pipe_batch[worker_id];
+    if (batch == NULL || batch->length == SW_IPC_BATCH_HEAD_SIZE)
+    {
+        return SW_OK;
+    }
+
+    swDataHead *head = (swDataHead *) batch->str;
+    bzero(head, sizeof(*head));
+    head->flags = SW_EVENT_DATA_BATCH;
+    head->from_id = SwooleTG.id;
+
+    int ret = swReactorThread_pipe_write(serv, swServer_get_worker(serv, worker_id), batch->str, batch->length);
+    batch->length = SW_IPC_BATCH_HEAD_SIZE;
+    return ret;
+}
+
+static int swReactorThread_batch_append(swServer *serv, swWorker *worker, void *data, int len)
+{
+    swReactorThread *thread = swServer_get_thread(serv, SwooleTG.id);
+    swString *batch = thread->pipe_batch[worker->id];
+    uint64_t length = len;
+
+    if (batch == NULL)
+    {
+        batch = swString_new(SW_IPC_MAX_SIZE * 2);
+        if (batch == NULL)
+        {
+            return SW_ERR;
+        }
+        batch->length = SW_IPC_BATCH_HEAD_SIZE;
+        thread->pipe_batch[worker->id] = batch;
+    }
+    else if (batch->length + SW_IPC_BATCH_ITEM_SIZE(len) > serv->ipc_batch_size)
+    {
+        if (swReactorThread_batch_flush(serv, thread, worker->id) < 0)
+        {
+            return SW_ERR;
+        }
+    }
+
+    if (batch->size < batch->length + SW_IPC_BATCH_ITEM_SIZE(len)
+            && swString_extend_align(batch, batch->length + SW_IPC_BATCH_ITEM_SIZE(len)) < 0)
+    {
+        return SW_ERR;
+    }
+    memcpy(batch->str + batch->length, &length, sizeof(length));
+    memcpy(batch->str + batch->length + sizeof(length), data, len);
+    batch->length += SW_IPC_BATCH_ITEM_SIZE(len);
+    return SW_OK;
+}
+
+/**
+ * [ReactorThread] the loop iteration is finished, send the coalesced events and close the idle connections
+ */
+static void swReactorThread_onFinish(swReactor *reactor)
+{
+    swServer *serv = reactor->ptr;
+    swReactorThread *thread = swServer_get_thread(serv, reactor->id);
+    int i;
+
+    if (thread->idle_wheel)
+    {
+        swReactorThread_idle_check(reactor);
+    }
+    if (thread->ipc_paused_num > 0)
+    {
+        swReactorThread_ipc_resume(reactor, thread);
+    }
+    //the close events of the idle connections are coalesced too
+    if (thread->pipe_batch)
+    {
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            swReactorThread_batch_flush(serv, thread, i);
+        }
+    }
+}
+
+int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, int len)
+{
+    int ret = -1;
+
+    //reactor thread
+    if (SwooleTG.type == SW_THREAD_REACTOR)
+    {
+        if (serv->ipc_batch_size > 0)
+        {
+            ret = swReactorThread_batch_append(serv, worker, data, len);
+        }
+        else
+        {
+            ret = swReactorThread_pipe_write(serv, worker, data, len);
+        }
+    }
+    //master/udp thread
     else
     {
         int pipe_fd = worker->pipe_master;
@@ -481,6 +931,491 @@ int swReactorThread_send2worker(swServer *serv, swWorker *worker, void *data, in
 }
 
 
+/**
+ * [ReactorThread] wake up the worker if it is waiting on the pipe
+ */
+static sw_inline int swReactorThread_ring_notify(swServer *serv, swShmRing *ring, swWorker *worker)
+{
+    sw_atomic_memory_barrier();
+    if (ring->consumer_wait && sw_atomic_cmp_set(&ring->consumer_wait, 1, 0))
+    {
+        swDataHead ev;
+        bzero(&ev, sizeof(ev));
+        ev.flags = SW_EVENT_DATA_RING;
+        ev.from_id = SwooleTG.id;
+        return swReactorThread_send2worker(serv, worker, &ev, sizeof(ev));
+    }
+    return SW_OK;
+}
+
+static sw_inline void* swReactorThread_ring_alloc(swShmRing *ring, uint32_t length)
+{
+    void *ptr = swShmRing_alloc(ring, length);
+    if (ptr == NULL)
+    {
+        ring->producer_wait = 1;
+        sw_atomic_memory_barrier();
+        //the worker may have released some items in the meantime
+        ptr = swShmRing_alloc(ring, length);
+        if (ptr)
+        {
+            ring->producer_wait = 0;
+        }
+    }
+    return ptr;
+}
+
+static int swReactorThread_ring_push(swReactorThread *thread, swShmRing *ring, int worker_id, swDataHead *info, char *data)
+{
+    swBuffer *buffer = thread->ipc_ring_buffers[worker_id];
+    uint32_t length = sizeof(*info) + info->len;
+    char *ptr;
+
+    if (swBuffer_empty(buffer))
+    {
+        ptr = swReactorThread_ring_alloc(ring, length);
+        if (ptr)
+        {
+            memcpy(ptr, info, sizeof(*info));
+            if (info->len > 0)
+            {
+                memcpy(ptr + sizeof(*info), data, info->len);
+            }
+            swShmRing_commit(ring);
+            return SW_OK;
+        }
+    }
+
+    //the ring is full, keep the request until the worker notifies us [SW_RESPONSE_RING_RESUME]
+    if (buffer == NULL)
+    {
+        buffer = swBuffer_new(0);
+        if (buffer == NULL)
+        {
+            return SW_ERR;
+        }
+        thread->ipc_ring_buffers[worker_id] = buffer;
+    }
+    swBuffer_chunk *chunk = swBuffer_new_chunk(buffer, SW_CHUNK_DATA, length);
+    if (chunk == NULL)
+    {
+        return SW_ERR;
+    }
+    ptr = chunk->store.ptr;
+    memcpy(ptr, info, sizeof(*info));
+    if (info->len > 0)
+    {
+        memcpy(ptr + sizeof(*info), data, info->len);
+    }
+    chunk->length = length;
+    buffer->length += length;
+    return SW_OK;
+}
+
+/**
+ * [ReactorThread] move the pending requests into the ring after the worker has released some space
+ */
+static int swReactorThread_ring_flush(swServer *serv, swReactorThread *thread, int worker_id)
+{
+    swBuffer *buffer = thread->ipc_ring_buffers[worker_id];
+    swShmRing *ring = swServer_get_ipc_ring(serv, SwooleTG.id, worker_id);
+    swBuffer_chunk *chunk;
+    void *ptr;
+
+    if (swBuffer_empty(buffer))
+    {
+        return SW_OK;
+    }
+    while (!swBuffer_empty(buffer))
+    {
+        chunk = swBuffer_get_chunk(buffer);
+        ptr = swReactorThread_ring_alloc(ring, chunk->length);
+        if (ptr == NULL)
+        {
+            break;
+        }
+        memcpy(ptr, chunk->store.ptr, chunk->length);
+        swShmRing_commit(ring);
+        swBuffer_pop_chunk(buffer, chunk);
+    }
+    return swReactorThread_ring_notify(serv, ring, swServer_get_worker(serv, worker_id));
+}
+
+/**
+ * [ReactorThread] each reactor thread owns one ring per worker, so the request is copied once
+ * without any lock, the pipe is only used to wake up the worker
+ */
+int swReactorThread_send2ring(swServer *serv, swWorker *worker, swDataHead *info, char *data, uint32_t length)
+{
+    swReactorThread *thread = swServer_get_thread(serv, SwooleTG.id);
+    swShmRing *ring = swServer_get_ipc_ring(serv, SwooleTG.id, worker->id);
+    uint32_t chunk_size = ring->size / 4;
+    uint32_t offset = 0;
+    swDataHead head = *info;
+
+    head.flags = length > chunk_size ? SW_EVENT_DATA_CHUNK : 0;
+    do
+    {
+        head.len = length - offset > chunk_size ? chunk_size : length - offset;
+        if ((head.flags & SW_EVENT_DATA_CHUNK) && offset + head.len == length)
+        {
+            head.flags |= SW_EVENT_DATA_END;
+        }
+        if (swReactorThread_ring_push(thread, ring, worker->id, &head, data + offset) < 0)
+        {
+            return SW_ERR;
+        }
+        offset += head.len;
+    } while (offset < length);
+
+    return swReactorThread_ring_notify(serv, ring, worker);
+}
+
+/**
+ * [ReactorThread] send the responses in the rings of all workers before waiting for events,
+ * the data is appended to the output buffer of the connection directly from the shared memory
+ */
+static void swReactorThread_onRingReceive(swReactor *reactor)
+{
+    swServer *serv = reactor->ptr;
+    swShmRing *ring;
+    swSendData _send;
+    char *ptr;
+    uint32_t length;
+    int i, n;
+
+    for (i = 0; i < serv->worker_num; i++)
+    {
+        swServer_get_response_ring(serv, i, reactor->id)->consumer_wait = 0;
+    }
+
+    while (1)
+    {
+        n = 0;
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            ring = swServer_get_response_ring(serv, i, reactor->id);
+            while ((ptr = swShmRing_peek(ring, &length)))
+            {
+                memcpy(&_send.info, ptr, sizeof(_send.info));
+                _send.data = ptr + sizeof(_send.info);
+                _send.length = length - sizeof(_send.info);
+                swServer_master_send(serv, &_send);
+                swShmRing_release(ring);
+                n++;
+            }
+            //notify the worker to move the pending responses into the ring
+            if (ring->producer_wait && sw_atomic_cmp_set(&ring->producer_wait, 1, 0))
+            {
+                swDataHead ev;
+                bzero(&ev, sizeof(ev));
+                ev.flags = SW_EVENT_DATA_RING;
+                ev.from_id = reactor->id;
+                swReactorThread_send2worker(serv, swServer_get_worker(serv, i), &ev, sizeof(ev));
+            }
+        }
+        if (n > 0)
+        {
+            continue;
+        }
+        //no more responses, the workers must wake us up through the pipe
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            swServer_get_response_ring(serv, i, reactor->id)->consumer_wait = 1;
+        }
+        sw_atomic_memory_barrier();
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            if (!swShmRing_empty(swServer_get_response_ring(serv, i, reactor->id)))
+            {
+                break;
+            }
+        }
+        if (i == serv->worker_num)
+        {
+            return;
+        }
+    }
+}
+
+typedef struct
+{
+    int fd;
+    uint32_t session_id;
+} swIdleConnection;
+
+static sw_inline int swReactorThread_idle_add(swServer *serv, swReactorThread *thread, swConnection *conn)
+{
+    swIdleConnection item;
+    item.fd = conn->fd;
+    item.session_id = conn->session_id;
+
+    //the first tick at or after the deadline, a slot that is visited is never written again in the same tick
+    time_t deadline = (conn->last_time + serv->heartbeat_idle_time) / serv->heartbeat_check_interval + 1;
+    if (deadline <= thread->idle_wheel_tick)
+    {
+        deadline = thread->idle_wheel_tick + 1;
+    }
+    uint32_t index = deadline % thread->idle_wheel_size;
+    if (thread->idle_wheel[index] == NULL)
+    {
+        thread->idle_wheel[index] = swString_new(SW_BUFFER_SIZE_STD);
+        if (thread->idle_wheel[index] == NULL)
+        {
+            return SW_ERR;
+        }
+    }
+    return swString_append_ptr(thread->idle_wheel[index], (char *) &item, sizeof(item));
+}
+
+/**
+ * [ReactorThread] a new connection joins the timing wheel only when heartbeat_idle_time is set,
+ * the reactor of the workers in SWOOLE_BASE mode has no reactor thread
+ */
+void swReactorThread_idle_enroll(swReactor *reactor, swConnection *conn)
+{
+    swServer *serv = (swServer *) reactor->ptr;
+    if (serv->factory_mode != SW_MODE_PROCESS || serv->single_thread || !swReactorThread_enable_heartbeat(serv))
+    {
+        return;
+    }
+    swReactorThread *thread = swServer_get_thread(serv, reactor->id);
+    if (thread->idle_wheel)
+    {
+        swReactorThread_idle_add(serv, thread, conn);
+    }
+}
+
+/**
+ * [ReactorThread] close the connections of the slot that are idle, move the active ones to the slot of their new deadline.
+ * the new deadline may map to the slot itself, appending to it here would realloc it under the loop
+ */
+static void swReactorThread_idle_expire(swReactor *reactor, swReactorThread *thread, swString *slot)
+{
+    swServer *serv = reactor->ptr;
+    swIdleConnection *item = (swIdleConnection *) slot->str;
+    swIdleConnection *end = (swIdleConnection *) (slot->str + slot->length);
+    swConnection *conn;
+    time_t checktime = serv->gs->now - serv->heartbeat_idle_time;
+
+    swString_clear(thread->idle_requeue);
+
+    for (; item < end; item++)
+    {
+        conn = swServer_connection_get(serv, item->fd);
+        //closed, or the fd is used by a new connection
+        if (conn == NULL || conn->active == 0 || conn->closed || conn->session_id != item->session_id
+                || conn->fdtype != SW_FD_TCP || conn->close_force)
+        {
+            continue;
+        }
+        /**
+         * a connection paused by the ipc watermark is waiting for the worker, not idle.
+         * a connection in a handshake thread is aborted there, it is only checked again after the handback
+         */
+        if (conn->protect || conn->ipc_wait || swConnection_ssl_handshaking(conn) || conn->last_time > checktime)
+        {
+            if (conn->protect || conn->ipc_wait)
+            {
+                conn->last_time = serv->gs->now;
+            }
+            swString_append_ptr(thread->idle_requeue, (char *) item, sizeof(*item));
+            continue;
+        }
+
+        conn->close_force = 1;
+        conn->close_notify = 1;
+        if (conn->removed)
+        {
+            serv->notify(serv, conn, SW_EVENT_CLOSE);
+        }
+        else
+        {
+            reactor->set(reactor, item->fd, SW_FD_TCP | SW_EVENT_WRITE);
+        }
+    }
+    slot->length = 0;
+
+    item = (swIdleConnection *) thread->idle_requeue->str;
+    end = (swIdleConnection *) (thread->idle_requeue->str + thread->idle_requeue->length);
+    for (; item < end; item++)
+    {
+        swReactorThread_idle_add(serv, thread, swServer_connection_get(serv, item->fd));
+    }
+}
+
+int swReactorThread_idle_init(swServer *serv, swReactorThread *thread)
+{
+    //a connection is checked again at most idle_time + interval later
+    thread->idle_wheel_size = serv->heartbeat_idle_time / serv->heartbeat_check_interval + 2;
+    thread->idle_wheel = sw_calloc(thread->idle_wheel_size, sizeof(swString *));
+    if (thread->idle_wheel == NULL)
+    {
+        swWarn("calloc(%d) failed.", (int) (thread->idle_wheel_size * sizeof(swString *)));
+        return SW_ERR;
+    }
+    thread->idle_requeue = swString_new(SW_BUFFER_SIZE_STD);
+    if (thread->idle_requeue == NULL)
+    {
+        return SW_ERR;
+    }
+    thread->idle_wheel_tick = serv->gs->now / serv->heartbeat_check_interval;
+    return SW_OK;
+}
+
+void swReactorThread_idle_check(swReactor *reactor)
+{
+    swServer *serv = reactor->ptr;
+    swReactorThread *thread = swServer_get_thread(serv, reactor->id);
+    time_t tick = serv->gs->now / serv->heartbeat_check_interval;
+    time_t i;
+
+    if (tick <= thread->idle_wheel_tick)
+    {
+        return;
+    }
+    //the thread may be blocked for a while, each slot is visited once at most
+    i = SW_MAX(thread->idle_wheel_tick + 1, tick - thread->idle_wheel_size + 1);
+    thread->idle_wheel_tick = tick;
+    for (; i <= tick; i++)
+    {
+        swString *slot = thread->idle_wheel[i % thread->idle_wheel_size];
+        if (slot && slot->length > 0)
+        {
+            swReactorThread_idle_expire(reactor, thread, slot);
+        }
+    }
+}
+
+/**
+ * [ReactorThread] bytes waiting for the worker, the pipe buffer is shared by all reactor threads
+ */
+static sw_inline size_t swReactorThread_ipc_queued(swServer *serv, swReactorThread *thread, int worker_id)
+{
+    swConnection *pipe_conn = &serv->connection_list[swServer_get_worker(serv, worker_id)->pipe_master];
+    size_t length = 0;
+
+    if (thread->ipc_ring_buffers && thread->ipc_ring_buffers[worker_id])
+    {
+        length = thread->ipc_ring_buffers[worker_id]->length;
+    }
+    /**
+     * the buffer lives as long as the reactor thread owning the pipe, it is appended and drained by other
+     * threads under the pipe lock, which is not taken here, a stale length is good enough for a watermark
+     */
+    swBuffer *buffer = sw_atomic_load_relaxed(&pipe_conn->in_buffer);
+    if (buffer)
+    {
+        length += sw_atomic_load_relaxed(&buffer->length);
+    }
+    return length;
+}
+
+/**
+ * [ReactorThread] stop reading the connection while the worker its data is dispatched to is above the high watermark
+ */
+int swReactorThread_ipc_pause(swServer *serv, swConnection *conn, int worker_id)
+{
+    swReactorThread *thread = swServer_get_thread(serv, SwooleTG.id);
+    swReactor *reactor = &thread->reactor;
+
+    if (thread->ipc_paused == NULL || conn->ipc_wait || conn->removed || conn->closed
+            || swReactorThread_ipc_queued(serv, thread, worker_id) < serv->ipc_high_watermark)
+    {
+        return SW_OK;
+    }
+    if (thread->ipc_paused[worker_id] == NULL)
+    {
+        thread->ipc_paused[worker_id] = swString_new(SW_BUFFER_SIZE_STD);
+        if (thread->ipc_paused[worker_id] == NULL)
+        {
+            return SW_ERR;
+        }
+    }
+
+    swIdleConnection item;
+    item.fd = conn->fd;
+    item.session_id = conn->session_id;
+    if (swString_append_ptr(thread->ipc_paused[worker_id], (char *) &item, sizeof(item)) < 0)
+    {
+        return SW_ERR;
+    }
+    //keep the EPOLLOUT event for the pending responses, without any event the fd is only watched for EPOLLHUP
+    if (reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_DEAULT | (conn->events & SW_EVENT_WRITE)) < 0)
+    {
+        thread->ipc_paused[worker_id]->length -= sizeof(item);
+        return SW_ERR;
+    }
+    conn->ipc_wait = 1;
+
+    if (thread->ipc_paused[worker_id]->length == sizeof(item))
+    {
+        thread->ipc_paused_since[worker_id] = swTimer_get_absolute_msec();
+        thread->ipc_pause_count++;
+        thread->ipc_paused_num++;
+        //the worker pipe may be drained by another reactor thread, wake up to check it
+        if (reactor->timeout_msec < 0 || reactor->timeout_msec > SW_IPC_RESUME_INTERVAL)
+        {
+            reactor->timeout_msec = SW_IPC_RESUME_INTERVAL;
+        }
+    }
+    return SW_OK;
+}
+
+/**
+ * [ReactorThread] read the paused connections again after their worker dropped below the low watermark
+ */
+static void swReactorThread_ipc_resume(swReactor *reactor, swReactorThread *thread)
+{
+    swServer *serv = reactor->ptr;
+    swConnection *conn;
+    int i;
+
+    for (i = 0; i < serv->worker_num; i++)
+    {
+        swString *paused = thread->ipc_paused[i];
+        if (paused == NULL || paused->length == 0
+                || swReactorThread_ipc_queued(serv, thread, i) > serv->ipc_low_watermark)
+        {
+            continue;
+        }
+
+        swIdleConnection *item = (swIdleConnection *) paused->str;
+        swIdleConnection *end = (swIdleConnection *) (paused->str + paused->length);
+        for (; item < end; item++)
+        {
+            conn = swServer_connection_get(serv, item->fd);
+            //closed, or the fd is used by a new connection
+            if (conn == NULL || conn->active == 0 || conn->session_id != item->session_id || !conn->ipc_wait)
+            {
+                continue;
+            }
+            conn->ipc_wait = 0;
+            //paused by pause() as well, read again on resume()
+            if (conn->removed || conn->closed || conn->pause_recv)
+            {
+                continue;
+            }
+            if (reactor->set(reactor, conn->fd, conn->fdtype | SW_EVENT_READ | (conn->events & SW_EVENT_WRITE)) < 0)
+            {
+                swSysError("reactor->set(%d, READ) failed.", conn->fd);
+            }
+        }
+        paused->length = 0;
+        thread->ipc_pause_time += swTimer_get_absolute_msec() - thread->ipc_paused_since[i];
+        thread->ipc_paused_num--;
+    }
+
+    if (!reactor->disable_accept)
+    {
+        reactor->timeout_msec = swReactorThread_get_timeout_msec(serv);
+    }
+    if (thread->ipc_paused_num > 0 && (reactor->timeout_msec < 0 || reactor->timeout_msec > SW_IPC_RESUME_INTERVAL))
+    {
+        reactor->timeout_msec = SW_IPC_RESUME_INTERVAL;
+    }
+}
+
 /**
  * [ReactorThread] worker pipe can write.
  */
@@ -574,6 +1509,10 @@ void swReactorThread_set_protocol(swServer *serv, swReactor *reactor)
     reactor->setHandle(reactor, SW_FD_TCP | SW_EVENT_WRITE, swReactorThread_onWrite);
     //Read
     reactor->setHandle(reactor, SW_FD_TCP | SW_EVENT_READ, swReactorThread_onRead);
+#ifdef HAVE_ZEROCOPY
+    //Error
+    reactor->setHandle(reactor, SW_FD_TCP | SW_EVENT_ERROR, swReactorThread_onError);
+#endif
 
     swListenPort *ls;
     //listen the all tcp port
@@ -600,13 +1539,22 @@ static int swReactorThread_onRead(swReactor *reactor, swEvent *event)
     }
     swListenPort *port = swServer_get_port(serv, event->fd);
 #ifdef SW_USE_OPENSSL
-    if (swReactorThread_verify_ssl_state(reactor, port, event->socket) < 0)
+    int ret = swReactorThread_verify_ssl_state(reactor, port, event->socket);
+    if (ret < 0)
     {
         return swReactorThread_close(reactor, event->fd);
     }
+    else if (ret == SW_WAIT)
+    {
+        return SW_OK;
+    }
 #endif
 
     event->socket->last_time = serv->gs->now;
+    if (serv->factory_mode == SW_MODE_PROCESS)
+    {
+        swServer_get_thread(serv, reactor->id)->event_count++;
+    }
 #ifdef SW_BUFFER_RECV_TIME
     event->socket->last_time_usec = swoole_microtime();
 #endif
@@ -623,8 +1571,8 @@ static int swReactorThread_onWrite(swReactor *reactor, swEvent *ev)
 
     if (serv->factory_mode == SW_MODE_PROCESS)
     {
-        assert(fd % serv->reactor_num == reactor->id);
-        assert(fd % serv->reactor_num == SwooleTG.id);
+        assert(serv->connection_list[fd].from_id == reactor->id);
+        assert(serv->connection_list[fd].from_id == SwooleTG.id);
     }
 
     swConnection *conn = swServer_connection_get(serv, fd);
@@ -639,6 +1587,7 @@ static int swReactorThread_onWrite(swReactor *reactor, swEvent *ev)
     if (conn->connect_notify)
     {
         conn->connect_notify = 0;
+        swReactorThread_idle_enroll(reactor, conn);
 #ifdef SW_USE_OPENSSL
         if (conn->ssl)
         {
@@ -685,6 +1634,13 @@ static int swReactorThread_onWrite(swReactor *reactor, swEvent *ev)
         return swReactorThread_close(reactor, fd);
     }
 
+#ifdef HAVE_ZEROCOPY
+    if (!swBuffer_empty(conn->zerocopy_buffer))
+    {
+        swConnection_zerocopy_complete(conn);
+    }
+#endif
+
     _pop_chunk: while (!swBuffer_empty(conn->out_buffer))
     {
         chunk = swBuffer_get_chunk(conn->out_buffer);
@@ -733,7 +1689,7 @@ static int swReactorThread_onWrite(swReactor *reactor, swEvent *ev)
     //remove EPOLLOUT event
     if (!conn->removed && swBuffer_empty(conn->out_buffer))
     {
-        reactor->set(reactor, fd, SW_FD_TCP | SW_EVENT_READ);
+        reactor->set(reactor, fd, SW_FD_TCP | (swConnection_recv_paused(conn) ? SW_EVENT_DEAULT : SW_EVENT_READ));
     }
     return SW_OK;
 }
@@ -767,19 +1723,110 @@ int swReactorThread_create(swServer *serv)
         swError("Fatal Error: serv->worker_num < 1");
         return SW_ERR;
     }
-    ret = swFactoryProcess_create(&(serv->factory), serv->worker_num);
-
-    if (ret < 0)
+    ret = swFactoryProcess_create(&(serv->factory), serv->worker_num);
+
+    if (ret < 0)
+    {
+        swError("create factory failed");
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+
+/**
+ * [master]
+ */
+#ifdef HAVE_REUSEPORT
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+/**
+ * the index of the socket in the SO_REUSEPORT group is the CPU that received the connection
+ */
+static int swReactorThread_attach_cbpf(swServer *serv, int sock)
+{
+    struct sock_filter code[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, (uint32_t) (SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, serv->reactor_num},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    struct sock_fprog prog;
+    prog.len = sizeof(code) / sizeof(code[0]);
+    prog.filter = code;
+
+    if (setsockopt(sock, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0)
+    {
+        swSysError("setsockopt(%d, SO_ATTACH_REUSEPORT_CBPF) failed.", sock);
+        return SW_ERR;
+    }
+    return SW_OK;
+}
+#endif
+
+/**
+ * each reactor thread accepts on its own listening socket of the port
+ */
+static int swReactorThread_reuse_port(swServer *serv, swListenPort *ls)
+{
+    int i, sock;
+
+    ls->thread_socks = SwooleG.memory_pool->alloc(SwooleG.memory_pool, serv->reactor_num * sizeof(int));
+    if (ls->thread_socks == NULL)
+    {
+        swWarn("malloc[thread_socks] failed");
+        return SW_ERR;
+    }
+    //the socket was bound without SO_REUSEPORT
+    if (close(ls->sock) < 0)
+    {
+        swSysError("close(%d) failed.", ls->sock);
+    }
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        sock = swSocket_create(ls->type);
+        if (sock < 0)
+        {
+            swSysError("create socket failed.");
+            return SW_ERR;
+        }
+        if (swSocket_bind(sock, ls->type, ls->host, &ls->port) < 0)
+        {
+            close(sock);
+            return SW_ERR;
+        }
+        swoole_fcntl_set_option(sock, 1, 1);
+        ls->sock = sock;
+        if (swPort_listen(ls) < 0)
+        {
+            return SW_ERR;
+        }
+        ls->thread_socks[i] = sock;
+    }
+    ls->sock = ls->thread_socks[0];
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    if (serv->reuse_port_cbpf && swReactorThread_attach_cbpf(serv, ls->sock) < 0)
     {
-        swError("create factory failed");
         return SW_ERR;
     }
+#endif
     return SW_OK;
 }
+#endif
 
 /**
- * [master]
+ * [ReactorThread] listen again after accept() failed with EMFILE, close the idle connections
  */
+static void swReactorThread_onTimeout(swReactor *reactor)
+{
+    swServer *serv = reactor->ptr;
+
+    if (reactor->disable_accept)
+    {
+        reactor->enable_accept(reactor);
+        reactor->disable_accept = 0;
+        reactor->timeout_msec = swReactorThread_get_timeout_msec(serv);
+    }
+    swReactorThread_onFinish(reactor);
+}
+
 int swReactorThread_start(swServer *serv)
 {
     int ret;
@@ -812,6 +1859,17 @@ int swReactorThread_start(swServer *serv)
         {
             continue;
         }
+#ifdef HAVE_REUSEPORT
+        //the socket taken over from the previous master keeps its backlog
+        if (SwooleG.reuse_port && !serv->single_thread && !ls->handoff_received && (ls->type == SW_SOCK_TCP || ls->type == SW_SOCK_TCP6))
+        {
+            if (swReactorThread_reuse_port(serv, ls) < 0)
+            {
+                return SW_ERR;
+            }
+            continue;
+        }
+#endif
         if (swPort_listen(ls) < 0)
         {
             return SW_ERR;
@@ -843,9 +1901,19 @@ int swReactorThread_start(swServer *serv)
         {
             continue;
         }
+        //accept in the reactor threads
+        if (ls->thread_socks)
+        {
+            continue;
+        }
         main_reactor->add(main_reactor, ls->sock, SW_FD_LISTEN);
     }
 
+    if (swServer_handoff_start(serv, main_reactor) < 0)
+    {
+        return SW_ERR;
+    }
+
     if (serv->single_thread)
     {
         swReactorThread_init_reactor(serv, main_reactor, 0);
@@ -863,6 +1931,13 @@ int swReactorThread_start(swServer *serv)
         SwooleTG.id = serv->reactor_num;
     }
 
+#ifdef SW_USE_OPENSSL
+    if (serv->ssl_handshake_threads && swSSLHandshakeThread_start(serv) < 0)
+    {
+        return SW_ERR;
+    }
+#endif
+
 #ifdef HAVE_PTHREAD_BARRIER
     //init thread barrier
     pthread_barrier_init(&serv->barrier, NULL, serv->reactor_num + 1);
@@ -900,7 +1975,7 @@ int swReactorThread_start(swServer *serv)
     /**
      * heartbeat thread
      */
-    if (serv->heartbeat_check_interval >= 1 && serv->heartbeat_check_interval <= serv->heartbeat_idle_time)
+    if (swReactorThread_enable_heartbeat(serv) && serv->single_thread)
     {
         swTrace("hb timer start, time: %d live time:%d", serv->heartbeat_check_interval, serv->heartbeat_idle_time);
         swHeartbeatThread_start(serv);
@@ -993,9 +2068,68 @@ int swReactorThread_init_reactor(swServer *serv, swReactor *reactor, uint16_t re
         }
     }
 
+    //listen TCP, SO_REUSEPORT
+    swListenPort *ls;
+    LL_FOREACH(serv->listen_list, ls)
+    {
+        if (ls->thread_socks == NULL)
+        {
+            continue;
+        }
+        if (reactor->add(reactor, ls->thread_socks[reactor_id], SW_FD_LISTEN) < 0)
+        {
+            return SW_ERR;
+        }
+        reactor->setHandle(reactor, SW_FD_LISTEN, swServer_master_onAccept);
+        reactor->enable_accept = swServer_enable_accept;
+        reactor->onTimeout = swReactorThread_onTimeout;
+    }
+
     //set protocol function point
     swReactorThread_set_protocol(serv, reactor);
 
+    if (serv->ipc_batch_size > 0)
+    {
+        thread->pipe_batch = sw_calloc(serv->worker_num, sizeof(swString *));
+        if (thread->pipe_batch == NULL)
+        {
+            swWarn("calloc(%d) failed.", (int) (serv->worker_num * sizeof(swString *)));
+            return SW_ERR;
+        }
+        reactor->onFinish = swReactorThread_onFinish;
+    }
+    if (serv->ipc_high_watermark > 0)
+    {
+        thread->ipc_paused = sw_calloc(serv->worker_num, sizeof(swString *));
+        thread->ipc_paused_since = sw_calloc(serv->worker_num, sizeof(int64_t));
+        if (thread->ipc_paused == NULL || thread->ipc_paused_since == NULL)
+        {
+            swWarn("calloc(%d) failed.", (int) (serv->worker_num * sizeof(int64_t)));
+            return SW_ERR;
+        }
+        reactor->onFinish = swReactorThread_onFinish;
+        reactor->onTimeout = swReactorThread_onTimeout;
+    }
+    if (swReactorThread_enable_heartbeat(serv) && !serv->single_thread)
+    {
+        if (swReactorThread_idle_init(serv, thread) < 0)
+        {
+            return SW_ERR;
+        }
+        reactor->timeout_msec = swReactorThread_get_timeout_msec(serv);
+        reactor->onFinish = swReactorThread_onFinish;
+        reactor->onTimeout = swReactorThread_onTimeout;
+    }
+    if (serv->ipc_rings)
+    {
+        thread->ipc_ring_buffers = sw_calloc(serv->worker_num, sizeof(swBuffer *));
+        if (thread->ipc_ring_buffers == NULL)
+        {
+            swWarn("calloc(%d) failed.", (int) (serv->worker_num * sizeof(swBuffer *)));
+            return SW_ERR;
+        }
+    }
+
     int i = 0, pipe_fd;
     for (i = 0; i < serv->worker_num; i++)
     {
@@ -1071,13 +2205,23 @@ static int swReactorThread_loop(swThreadParam *param)
 
     SwooleTG.reactor = reactor;
 
+    swBuffer_slab_init(&thread->buffer_slab);
+    SwooleTG.buffer_slab = &thread->buffer_slab;
+
 #ifdef HAVE_CPU_AFFINITY
     //cpu affinity setting
-    if (serv->open_cpu_affinity)
+    if (serv->open_cpu_affinity || swServer_numa_enabled(serv))
     {
         cpu_set_t cpu_set;
         CPU_ZERO(&cpu_set);
 
+#ifdef HAVE_NUMA
+        if (swServer_numa_enabled(serv))
+        {
+            swServer_get_numa_cpus(serv, reactor_id, &cpu_set);
+        }
+        else
+#endif
         if (serv->cpu_affinity_available_num)
         {
             CPU_SET(serv->cpu_affinity_available[reactor_id % serv->cpu_affinity_available_num], &cpu_set);
@@ -1104,6 +2248,10 @@ static int swReactorThread_loop(swThreadParam *param)
 
     reactor->onFinish = NULL;
     reactor->onTimeout = NULL;
+    if (serv->ipc_response_rings)
+    {
+        reactor->onBegin = swReactorThread_onRingReceive;
+    }
 
     if (swReactorThread_init_reactor(serv, reactor, reactor_id) < 0)
     {
@@ -1121,6 +2269,54 @@ static int swReactorThread_loop(swThreadParam *param)
     //shutdown
     reactor->free(reactor);
 
+    if (thread->pipe_batch)
+    {
+        int i;
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            if (thread->pipe_batch[i])
+            {
+                swString_free(thread->pipe_batch[i]);
+            }
+        }
+        sw_free(thread->pipe_batch);
+        thread->pipe_batch = NULL;
+    }
+    if (thread->ipc_ring_buffers)
+    {
+        int i;
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            if (thread->ipc_ring_buffers[i])
+            {
+                swBuffer_free(thread->ipc_ring_buffers[i]);
+            }
+        }
+        sw_free(thread->ipc_ring_buffers);
+        thread->ipc_ring_buffers = NULL;
+    }
+    if (thread->ipc_paused)
+    {
+        int i;
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            if (thread->ipc_paused[i])
+            {
+                swString_free(thread->ipc_paused[i]);
+            }
+        }
+        sw_free(thread->ipc_paused);
+        sw_free(thread->ipc_paused_since);
+        thread->ipc_paused = NULL;
+        thread->ipc_paused_since = NULL;
+    }
+
+    SwooleTG.buffer_slab = NULL;
+    swBuffer_slab_free(&thread->buffer_slab);
+#ifdef HAVE_RECVMMSG
+    swReactorThread_free_dgram_batch();
+#endif
+
     swString_free(SwooleTG.buffer_stack);
     pthread_exit(0);
     return SW_OK;
@@ -1188,6 +2384,13 @@ void swReactorThread_free(swServer *serv)
         return;
     }
 
+#ifdef SW_USE_OPENSSL
+    if (serv->ssl_handshake_threads)
+    {
+        swSSLHandshakeThread_free(serv);
+    }
+#endif
+
     for (i = 0; i < serv->reactor_num; i++)
     {
         thread = &(serv->reactor_threads[i]);
@@ -1214,7 +2417,276 @@ void swReactorThread_free(swServer *serv)
             swSysError("pthread_join(%ld) failed.", (long ) thread->thread_id);
         }
     }
+#ifdef SW_USE_OPENSSL
+    //a reactor thread may be writing to the pipe until it is stopped
+    for (i = 0; serv->ssl_handshake_threads && i < serv->ssl_handshake_thread_num; i++)
+    {
+        serv->ssl_handshake_threads[i].pipe.close(&serv->ssl_handshake_threads[i].pipe);
+    }
+#endif
+}
+
+#ifdef SW_USE_OPENSSL
+/**
+ * [HandshakeThread] hand the connection back to its reactor thread
+ */
+static void swSSLHandshakeThread_finish(swReactor *reactor, swConnection *conn, int result)
+{
+    swServer *serv = reactor->ptr;
+    swDataHead ev;
+
+    if (!conn->removed)
+    {
+        reactor->del(reactor, conn->fd);
+    }
+    //not owned by this thread anymore, it is skipped by swSSLHandshakeThread_expire() until the handback
+    __atomic_store_n(&conn->ssl_handshaking, 2, __ATOMIC_SEQ_CST);
+    bzero(&ev, sizeof(ev));
+    ev.fd = conn->fd;
+    ev.from_id = conn->from_id;
+    ev.from_fd = SW_RESPONSE_SSL_HANDSHAKE;
+    ev.len = result;
+    if (swSocket_write_blocking(swServer_get_thread(serv, conn->from_id)->notify_pipe, &ev, sizeof(ev)) < 0)
+    {
+        swSysError("write(notify_pipe) failed.");
+    }
+}
+
+static void swSSLHandshakeThread_accept(swReactor *reactor, swConnection *conn)
+{
+    int ret = swSSL_accept(conn);
+    if (ret == SW_WAIT)
+    {
+        int events = SW_FD_TCP | (conn->ssl_want_write ? SW_EVENT_WRITE : SW_EVENT_READ);
+        if ((conn->removed ? reactor->add(reactor, conn->fd, events) : reactor->set(reactor, conn->fd, events)) == SW_OK)
+        {
+            return;
+        }
+        ret = SW_ERROR;
+    }
+    if (ret == SW_READY)
+    {
+        swServer *serv = reactor->ptr;
+        sw_atomic_fetch_add(&serv->ssl_handshake_threads[reactor->id].handshake_count, 1);
+    }
+    swSSLHandshakeThread_finish(reactor, conn, ret);
+}
+
+static int swSSLHandshakeThread_onEvent(swReactor *reactor, swEvent *event)
+{
+    swSSLHandshakeThread_accept(reactor, event->socket);
+    return SW_OK;
+}
+
+static int swSSLHandshakeThread_onPipeReceive(swReactor *reactor, swEvent *event)
+{
+    swServer *serv = reactor->ptr;
+    swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[reactor->id];
+    swConnection *conn;
+    swDataHead ev;
+
+    while (read(event->fd, &ev, sizeof(ev)) == sizeof(ev))
+    {
+        if (ev.from_fd == SW_RESPONSE_EXIT)
+        {
+            reactor->running = 0;
+            break;
+        }
+        conn = swServer_connection_get(serv, ev.fd);
+        if (hs_thread->pending)
+        {
+            swIdleConnection item;
+            item.fd = conn->fd;
+            item.session_id = conn->session_id;
+            swString_append_ptr(hs_thread->pending, (char *) &item, sizeof(item));
+        }
+        swSSLHandshakeThread_accept(reactor, conn);
+    }
+    return SW_OK;
+}
+
+/**
+ * [HandshakeThread] a client that stalls in the handshake would hold the connection here forever,
+ * it is handed back as failed once heartbeat_idle_time has passed since its last data in the reactor thread
+ */
+static void swSSLHandshakeThread_expire(swReactor *reactor)
+{
+    swServer *serv = reactor->ptr;
+    swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[reactor->id];
+    swString *pending = hs_thread->pending;
+    time_t checktime = serv->gs->now - serv->heartbeat_idle_time;
+    swConnection *conn;
+
+    if (serv->gs->now == hs_thread->pending_check_time)
+    {
+        return;
+    }
+    hs_thread->pending_check_time = serv->gs->now;
+
+    swIdleConnection *item = (swIdleConnection *) pending->str;
+    swIdleConnection *end = (swIdleConnection *) (pending->str + pending->length);
+    swIdleConnection *keep = item;
+    for (; item < end; item++)
+    {
+        conn = swServer_connection_get(serv, item->fd);
+        //finished, or the fd is used by a new connection
+        if (conn == NULL || !conn->active || conn->session_id != item->session_id
+                || __atomic_load_n(&conn->ssl_handshaking, __ATOMIC_SEQ_CST) != 1)
+        {
+            continue;
+        }
+        if (conn->last_time <= checktime)
+        {
+            swSSLHandshakeThread_finish(reactor, conn, SW_ERROR);
+            continue;
+        }
+        *keep++ = *item;
+    }
+    pending->length = (char *) keep - pending->str;
+}
+
+static int swSSLHandshakeThread_loop(swThreadParam *param)
+{
+    swServer *serv = param->object;
+    swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[param->pti];
+    swReactor *reactor = &hs_thread->reactor;
+    int pipe_fd = hs_thread->pipe.getFd(&hs_thread->pipe, 0);
+
+    SwooleTG.id = param->pti;
+    SwooleTG.type = SW_THREAD_SSL_HANDSHAKE;
+    SwooleTG.reactor = reactor;
+    swSignal_none();
+
+    if (swReactor_create(reactor, SW_REACTOR_MAXEVENTS) < 0)
+    {
+        return SW_ERR;
+    }
+    reactor->ptr = serv;
+    reactor->id = SwooleTG.id;
+    reactor->thread = 1;
+    reactor->socket_list = serv->connection_list;
+    reactor->max_socket = serv->max_connection;
+
+    reactor->setHandle(reactor, SW_FD_PIPE | SW_EVENT_READ, swSSLHandshakeThread_onPipeReceive);
+    reactor->setHandle(reactor, SW_FD_TCP | SW_EVENT_READ, swSSLHandshakeThread_onEvent);
+    reactor->setHandle(reactor, SW_FD_TCP | SW_EVENT_WRITE, swSSLHandshakeThread_onEvent);
+    reactor->setHandle(reactor, SW_FD_CLOSE, swSSLHandshakeThread_onEvent);
+
+    if (swReactorThread_enable_heartbeat(serv))
+    {
+        hs_thread->pending = swString_new(SW_BUFFER_SIZE_STD);
+        if (hs_thread->pending == NULL)
+        {
+            return SW_ERR;
+        }
+        reactor->timeout_msec = serv->heartbeat_check_interval * 1000;
+        reactor->onTimeout = swSSLHandshakeThread_expire;
+        reactor->onFinish = swSSLHandshakeThread_expire;
+    }
+
+    swSetNonBlock(pipe_fd);
+    if (reactor->add(reactor, pipe_fd, SW_FD_PIPE) < 0)
+    {
+        return SW_ERR;
+    }
+    reactor->wait(reactor, NULL);
+    reactor->free(reactor);
+    if (hs_thread->pending)
+    {
+        swString_free(hs_thread->pending);
+        hs_thread->pending = NULL;
+    }
+    return SW_OK;
+}
+
+/**
+ * the full handshakes are CPU bound, they stall every established connection of the reactor thread
+ */
+static int swSSLHandshakeThread_start(swServer *serv)
+{
+    swThreadParam *param;
+    swListenPort *ls;
+    int i;
+
+    LL_FOREACH(serv->listen_list, ls)
+    {
+        if (ls->ssl_context)
+        {
+            swSSL_server_defer_full_handshake(ls->ssl_context);
+        }
+    }
+    for (i = 0; i < serv->ssl_handshake_thread_num; i++)
+    {
+        swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[i];
+        if (swPipeUnsock_create(&hs_thread->pipe, 1, SOCK_DGRAM) < 0)
+        {
+            return SW_ERR;
+        }
+        //a reactor thread must not block on a burst of handshakes
+        swSetNonBlock(hs_thread->pipe.getFd(&hs_thread->pipe, 1));
+        param = SwooleG.memory_pool->alloc(SwooleG.memory_pool, sizeof(swThreadParam));
+        if (param == NULL)
+        {
+            swError("malloc failed");
+            return SW_ERR;
+        }
+        param->object = serv;
+        param->pti = i;
+        if (pthread_create(&hs_thread->thread_id, NULL, (void * (*)(void *)) swSSLHandshakeThread_loop, (void *) param) < 0)
+        {
+            swSysError("pthread_create[ssl_handshake] failed.");
+            return SW_ERR;
+        }
+    }
+    return SW_OK;
+}
+
+static void swSSLHandshakeThread_free(swServer *serv)
+{
+    swConnection *conn;
+    swDataHead ev;
+    int fd, i;
+
+    bzero(&ev, sizeof(ev));
+    ev.from_fd = SW_RESPONSE_EXIT;
+    for (i = 0; i < serv->ssl_handshake_thread_num; i++)
+    {
+        swSSLHandshakeThread *hs_thread = &serv->ssl_handshake_threads[i];
+        __atomic_store_n(&hs_thread->exited, 1, __ATOMIC_SEQ_CST);
+        if (swSocket_write_blocking(hs_thread->pipe.getFd(&hs_thread->pipe, 1), &ev, sizeof(ev)) < 0)
+        {
+            continue;
+        }
+        if (pthread_join(hs_thread->thread_id, NULL) != 0)
+        {
+            swSysError("pthread_join(%ld) failed.", (long ) hs_thread->thread_id);
+        }
+    }
+    /**
+     * the connections left in the handshake threads, or in their pipes, are closed by their reactor threads,
+     * which are still running and read these before SW_RESPONSE_EXIT
+     */
+    for (fd = swServer_get_minfd(serv); fd <= swServer_get_maxfd(serv); fd++)
+    {
+        conn = &serv->connection_list[fd];
+        if (!conn->active || !__atomic_load_n(&conn->ssl_handshaking, __ATOMIC_SEQ_CST))
+        {
+            continue;
+        }
+        //the epoll of the handshake thread is closed with it
+        conn->removed = 1;
+        bzero(&ev, sizeof(ev));
+        ev.fd = fd;
+        ev.from_id = conn->from_id;
+        ev.from_fd = SW_RESPONSE_SSL_HANDSHAKE;
+        ev.len = SW_ERROR;
+        if (swSocket_write_blocking(swServer_get_thread(serv, conn->from_id)->notify_pipe, &ev, sizeof(ev)) < 0)
+        {
+            swSysError("write(notify_pipe) failed.");
+        }
+    }
 }
+#endif
 
 static void swHeartbeatThread_start(swServer *serv)
 {
@@ -19,6 +19,134 @@
 
 static swEventData *g_current_task = NULL;
 
+/**
+ * free the task_shm blocks and hand on the shm_queue slots which an exited process held, called in the manager
+ */
+void swTaskWorker_reclaim(swServer *serv, pid_t pid)
+{
+    int n;
+    if (serv->task_shm)
+    {
+        n = swPagePool_reclaim(serv->task_shm, pid);
+        if (n > 0)
+        {
+            swWarn("reclaim %d pages of task_shm from the exited process[pid=%d].", n, pid);
+        }
+    }
+    if (serv->gs->task_workers.shm_queue)
+    {
+        n = swShmQueue_repair(serv->gs->task_workers.shm_queue, pid);
+        if (n > 0)
+        {
+            swWarn("repair %d slots of the task queue taken by the exited process[pid=%d].", n, pid);
+        }
+    }
+}
+
+/**
+ * drop a result which is not going to be unpacked, the task_shm block or the tmpfile of a large package is released
+ */
+void swTaskWorker_large_free(swEventData *task)
+{
+    if (!(swTask_type(task) & SW_TASK_TMPFILE))
+    {
+        return;
+    }
+    swPackage_task pkg;
+    memcpy(&pkg, task->data, sizeof(pkg));
+    if (pkg.shm_data)
+    {
+        swMemoryPool *pool = SwooleG.serv->task_shm;
+        pool->free(pool, pkg.shm_data);
+    }
+    else
+    {
+        unlink(pkg.tmpfile);
+    }
+}
+
+/**
+ * [worker] clear the task_result slot, a result which arrived after its taskwait timed out is freed
+ */
+void swTaskWorker_reset_result(swServer *serv, int worker_id)
+{
+    swWorker *worker = swServer_get_worker(serv, worker_id);
+    swEventData *result = &serv->task_result[worker_id];
+
+    worker->lock.lock(&worker->lock);
+    swTaskWorker_large_free(result);
+    bzero(result, sizeof(swEventData));
+    worker->lock.unlock(&worker->lock);
+}
+
+/**
+ * [worker] a new process takes over the slot, free the blocks left to the previous one
+ */
+void swTaskWorker_reclaim_result(swServer *serv, int worker_id)
+{
+    swWorker *worker = swServer_get_worker(serv, worker_id);
+    swEventData *result = &serv->task_result[worker_id];
+
+    worker->lock.lock(&worker->lock);
+    if (serv->task_shm)
+    {
+        int n = swPagePool_reclaim(serv->task_shm, SW_TASK_RESULT_OWNER(worker_id));
+        if (n > 0)
+        {
+            swWarn("reclaim %d pages of task_shm from the task results of worker#%d.", n, worker_id);
+        }
+    }
+    if (swTask_type(result) & SW_TASK_TMPFILE)
+    {
+        swPackage_task pkg;
+        memcpy(&pkg, result->data, sizeof(pkg));
+        if (!pkg.shm_data)
+        {
+            unlink(pkg.tmpfile);
+        }
+    }
+    bzero(result, sizeof(swEventData));
+    worker->lock.unlock(&worker->lock);
+}
+
+/**
+ * [worker] move the result out of the slot, a task worker may write the next one as soon as the lock is released
+ */
+void swTaskWorker_take_result(swServer *serv, swEventData *task)
+{
+    swWorker *worker = swServer_get_worker(serv, SwooleWG.id);
+    swEventData *result = &serv->task_result[SwooleWG.id];
+
+    worker->lock.lock(&worker->lock);
+    memcpy(task, result, sizeof(result->info) + result->info.len);
+    bzero(&result->info, sizeof(result->info));
+    worker->lock.unlock(&worker->lock);
+}
+
+static void swTaskWorker_onQueueTimer(swTimer *timer, swTimer_node *tnode)
+{
+    swServer *serv = (swServer *) tnode->data;
+    swShmQueue *q = serv->gs->task_workers.shm_queue;
+
+    if (swShmQueue_stalled(q))
+    {
+        swoole_error_log(SW_LOG_ERROR, SW_ERROR_TASK_QUEUE_STALLED,
+                "the task queue is stuck at a slot of a killed process, %ld tasks are blocked, the server must be restarted.",
+                (long) swShmQueue_count(q));
+    }
+}
+
+/**
+ * [manager] a process killed right after taking a slot of the task queue cannot be repaired, report it
+ */
+void swTaskWorker_check_queue(swServer *serv)
+{
+    if (serv->gs->task_workers.shm_queue)
+    {
+        swTimer_add(&SwooleG.timer, SW_SHM_QUEUE_CHECK_INTERVAL * 1000, 1, serv, swTaskWorker_onQueueTimer);
+    }
+}
+
 static void swTaskWorker_signal_init(swProcessPool *pool);
 static int swTaskWorker_onPipeReceive(swReactor *reactor, swEvent *event);
 static int swTaskWorker_loop_async(swProcessPool *pool, swWorker *worker);
@@ -40,7 +168,7 @@ void swTaskWorker_init(swServer *serv)
     {
         pool->main_loop = swTaskWorker_loop_async;
     }
-    if (serv->task_ipc_mode == SW_TASK_IPC_PREEMPTIVE)
+    if (serv->task_ipc_mode == SW_TASK_IPC_PREEMPTIVE || serv->task_ipc_mode == SW_TASK_IPC_SHM_QUEUE)
     {
         pool->dispatch_mode = SW_DISPATCH_QUEUE;
     }
@@ -86,6 +214,20 @@ int swTaskWorker_large_pack(swEventData *task, void *data, int data_len)
     swPackage_task pkg;
     bzero(&pkg, sizeof(pkg));
 
+    swServer *serv = SwooleG.serv;
+    if (serv && serv->task_shm)
+    {
+        //the consumer frees it after reading, use the tmpfile when the arena is full
+        pkg.shm_data = serv->task_shm->alloc(serv->task_shm, data_len);
+        if (pkg.shm_data)
+        {
+            memcpy(pkg.shm_data, data, data_len);
+            //in flight, not reclaimed when this process exits
+            swPagePool_set_owner(serv->task_shm, pkg.shm_data, 0);
+            goto _pack;
+        }
+    }
+
     memcpy(pkg.tmpfile, SwooleG.task_tmpdir, SwooleG.task_tmpdir_len);
 
     //create temp file
@@ -99,16 +241,18 @@ int swTaskWorker_large_pack(swEventData *task, void *data, int data_len)
     if (swoole_sync_writefile(tmp_fd, data, data_len) != data_len)
     {
         swWarn("write to tmpfile failed.");
+        close(tmp_fd);
         return SW_ERR;
     }
+    close(tmp_fd);
 
+    _pack:
     task->info.len = sizeof(swPackage_task);
-    //use tmp file
+    //large package, stored in the arena or the tmp file
     swTask_type(task) |= SW_TASK_TMPFILE;
 
     pkg.length = data_len;
     memcpy(task->data, &pkg, sizeof(swPackage_task));
-    close(tmp_fd);
     return SW_OK;
 }
 
@@ -387,6 +531,9 @@ int swTaskWorker_finish(swServer *serv, char *data, int data_len, int flags, swE
         }
         else
         {
+            //the worker gave up waiting for the previous result
+            swTaskWorker_large_free(result);
+
             result->info.type = SW_EVENT_FINISH;
             result->info.fd = current_task->info.fd;
             swTask_type(result) = flags;
@@ -395,11 +542,18 @@ int swTaskWorker_finish(swServer *serv, char *data, int data_len, int flags, swE
             {
                 if (swTaskWorker_large_pack(result, data, data_len) < 0)
                 {
+                    bzero(&result->info, sizeof(result->info));
                     //unlock worker
                     worker->lock.unlock(&worker->lock);
                     swWarn("large task pack failed()");
                     return SW_ERR;
                 }
+                swPackage_task *pkg = (swPackage_task *) result->data;
+                if (pkg->shm_data)
+                {
+                    //only referenced by the slot, reclaimed if no process of the slot takes it
+                    swPagePool_set_owner(serv->task_shm, pkg->shm_data, SW_TASK_RESULT_OWNER(source_worker_id));
+                }
             }
             else
             {
@@ -18,16 +18,28 @@
 #include "server.h"
 #include "client.h"
 #include "async.h"
+#include "coroutine.h"
 
 #include <pwd.h>
 #include <grp.h>
 
+#include <unordered_map>
+
+using swoole::Coroutine;
+
 static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event);
+static void swWorker_onRingReceive(swServer *serv, swWorker *worker);
+static void swWorker_onRingDefer(void *data);
+static void swWorker_recover_rings(swServer *serv, swWorker *worker);
+static int swWorker_ring_flush(swServer *serv, int reactor_id);
+static void swWorker_ring_handover(swServer *serv);
 static void swWorker_onTimeout(swTimer *timer, swTimer_node *tnode);
 static int swWorker_onStreamAccept(swReactor *reactor, swEvent *event);
 static int swWorker_onStreamRead(swReactor *reactor, swEvent *event);
 static int swWorker_onStreamPackage(swConnection *conn, char *data, uint32_t length);
 static int swWorker_onStreamClose(swReactor *reactor, swEvent *event);
+static int swWorker_standby_wait(swServer *serv, swWorker *worker);
+static void swWorker_start_receive(swServer *serv);
 
 void swWorker_free(swWorker *worker)
 {
@@ -250,13 +262,64 @@ static int swWorker_onStreamPackage(swConnection *conn, char *data, uint32_t len
 
 typedef int (*task_callback)(swServer *, swEventData *);
 
+/**
+ * [SW_DISPATCH_LEAST_LOAD] the request is finished, update the load of the worker
+ */
+static sw_inline void swWorker_finish_request(swServer *serv, swWorker *worker, double start_time)
+{
+    if (serv->dispatch_mode != SW_DISPATCH_LEAST_LOAD)
+    {
+        return;
+    }
+    if (start_time > 0)
+    {
+        int64_t usec = (int64_t) ((swoole_microtime() - start_time) * 1000000);
+        int64_t avg = worker->service_time;
+        worker->service_time = (uint32_t) (avg + (SW_MAX(usec, 0) - avg) / (1 << SW_DISPATCH_EWMA_SHIFT));
+    }
+    //the manager resets the counter when a worker exits, the requests still in the pipe must not make it negative
+    int32_t inflight = worker->inflight;
+    while (inflight > 0 && !sw_atomic_cmp_set(&worker->inflight, inflight, inflight - 1))
+    {
+        inflight = worker->inflight;
+    }
+}
+
+/**
+ * [SW_DISPATCH_LEAST_LOAD] the start time of the requests whose coroutine has yielded, by cid
+ */
+static std::unordered_map<long, double> swWorker_coroutine_requests;
+
+static void swWorker_onCoroutineStop(void *data)
+{
+    auto i = swWorker_coroutine_requests.find(Coroutine::get_current_cid());
+    if (i == swWorker_coroutine_requests.end())
+    {
+        return;
+    }
+    double start_time = i->second;
+    swWorker_coroutine_requests.erase(i);
+    swWorker_finish_request(SwooleG.serv, SwooleWG.worker, start_time);
+}
+
 static sw_inline void swWorker_do_task(swServer *serv, swWorker *worker, swEventData *task, task_callback callback)
 {
+    double start_time = serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD ? swoole_microtime() : 0;
+    long last_cid = Coroutine::get_last_cid();
     worker->request_time = serv->gs->now;
 #ifdef SW_BUFFER_RECV_TIME
     serv->last_receive_usec = task->info.time;
 #endif
     callback(serv, task);
+    //with enable_coroutine the callback returns at the first yield, the request is finished when its coroutine ends
+    if (start_time > 0 && Coroutine::get_last_cid() != last_cid && Coroutine::get_task_by_cid(last_cid + 1))
+    {
+        swWorker_coroutine_requests[last_cid + 1] = start_time;
+    }
+    else
+    {
+        swWorker_finish_request(serv, worker, start_time);
+    }
     worker->request_time = 0;
 #ifdef SW_BUFFER_RECV_TIME
     serv->last_receive_usec = 0;
@@ -264,6 +327,10 @@ static sw_inline void swWorker_do_task(swServer *serv, swWorker *worker, swEvent
     worker->traced = 0;
     worker->request_count++;
     sw_atomic_fetch_add(&serv->stats->request_count, 1);
+    if (unlikely(!SwooleWG.ready))
+    {
+        swWorker_ready(serv);
+    }
 }
 
 int swWorker_onTask(swFactory *factory, swEventData *task)
@@ -300,6 +367,7 @@ int swWorker_onTask(swFactory *factory, swEventData *task)
         //discard data
         if (swWorker_discard_data(serv, task) == SW_TRUE)
         {
+            swWorker_finish_request(serv, worker, 0);
             break;
         }
         swWorker_do_task(serv, worker, task, serv->onReceive);
@@ -467,7 +535,19 @@ void swWorker_onStart(swServer *serv)
     }
 
     SwooleWG.worker = swServer_get_worker(serv, SwooleWG.id);
-    SwooleWG.worker->status = SW_WORKER_IDLE;
+    if (swIsWorker() && serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD)
+    {
+        swoole_add_hook(SW_GLOBAL_HOOK_ON_CORO_STOP, swWorker_onCoroutineStop, 1);
+    }
+    //the slot is still used by the worker that the standby worker replaces
+    if (!SwooleWG.standby)
+    {
+        SwooleWG.worker->status = SW_WORKER_IDLE;
+        if (swIsWorker() && serv->task_result)
+        {
+            swTaskWorker_reclaim_result(serv, SwooleWG.id);
+        }
+    }
 
     if (serv->factory_mode == SW_MODE_PROCESS)
     {
@@ -495,6 +575,7 @@ void swWorker_onStop(swServer *serv)
 void swWorker_stop(swWorker *worker)
 {
     swServer *serv = (swServer *) worker->pool->ptr;
+
     worker->status = SW_WORKER_BUSY;
 
     /**
@@ -550,9 +631,20 @@ void swWorker_stop(swWorker *worker)
         goto try_to_exit;
     }
 
+    /**
+     * the manager starts the replacement of this slot when it reads the message, which writes to the same
+     * response rings, from now on the responses of the unfinished requests go through the pipe
+     */
+    SwooleWG.wait_exit = 1;
+    if (SwooleWG.ring_buffers)
+    {
+        swWorker_ring_handover(serv);
+    }
+
     swWorkerStopMessage msg;
     msg.pid = SwooleG.pid;
     msg.worker_id = SwooleWG.id;
+    msg.type = SW_WORKER_MESSAGE_STOP;
 
     //send message to manager
     if (swChannel_push(serv->message_box, &msg, sizeof(msg)) < 0)
@@ -571,6 +663,32 @@ void swWorker_stop(swWorker *worker)
     swWorker_try_to_exit();
 }
 
+/**
+ * [reload_batch_num] called after the first request, or earlier by Server::ready() when the application is warmed up,
+ * the rolling reload stops the next workers once the replacements are ready
+ */
+void swWorker_ready(swServer *serv)
+{
+    if (SwooleWG.ready)
+    {
+        return;
+    }
+    SwooleWG.ready = 1;
+    if (serv->reload_batch_num == 0 || !serv->message_box)
+    {
+        return;
+    }
+
+    swWorkerStopMessage msg;
+    msg.pid = SwooleG.pid;
+    msg.worker_id = SwooleWG.id;
+    msg.type = SW_WORKER_MESSAGE_READY;
+    if (swChannel_push(serv->message_box, &msg, sizeof(msg)) == SW_OK)
+    {
+        swKill(serv->gs->manager_pid, SIGIO);
+    }
+}
+
 static void swWorker_onTimeout(swTimer *timer, swTimer_node *tnode)
 {
     SwooleG.running = 0;
@@ -642,6 +760,13 @@ void swWorker_clean(void)
     int i;
     swServer *serv = (swServer *) SwooleWG.worker->pool->ptr;
 
+#ifdef HAVE_RECVMMSG
+    if (SwooleWG.dgram_queue)
+    {
+        swWorker_dgram_flush(NULL);
+    }
+#endif
+
     for (i = 0; i < serv->worker_num + serv->task_worker_num; i++)
     {
         swWorker *worker = swServer_get_worker(serv, i);
@@ -657,6 +782,31 @@ void swWorker_clean(void)
             }
         }
     }
+    if (SwooleWG.ring_buffers)
+    {
+        //msec, the reactor thread may be gone, do not wait for it forever
+        int wait_time = SW_WORKER_WAIT_TIMEOUT;
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            while (!swBuffer_empty(SwooleWG.ring_buffers[i]))
+            {
+                if (swWorker_ring_flush(serv, i) < 0)
+                {
+                    break;
+                }
+                if (swBuffer_empty(SwooleWG.ring_buffers[i]))
+                {
+                    break;
+                }
+                if (wait_time-- <= 0)
+                {
+                    swWarn("discard %d bytes of responses to reactor thread#%d.", (int) SwooleWG.ring_buffers[i]->length, i);
+                    break;
+                }
+                usleep(1000);
+            }
+        }
+    }
 }
 
 /**
@@ -685,14 +835,13 @@ int swWorker_loop(swFactory *factory, int worker_id)
         return SW_ERR;
     }
 
-    worker->status = SW_WORKER_IDLE;
-
-    int pipe_worker = worker->pipe_worker;
+    if (!SwooleWG.standby)
+    {
+        worker->status = SW_WORKER_IDLE;
+    }
 
-    swSetNonBlock(pipe_worker);
+    swSetNonBlock(worker->pipe_worker);
     SwooleG.main_reactor->ptr = serv;
-    SwooleG.main_reactor->add(SwooleG.main_reactor, pipe_worker, SW_FD_PIPE | SW_EVENT_READ);
-    SwooleG.main_reactor->setHandle(SwooleG.main_reactor, SW_FD_PIPE, swWorker_onPipeReceive);
     SwooleG.main_reactor->setHandle(SwooleG.main_reactor, SW_FD_WRITE, swReactor_onWrite);
 
     /**
@@ -711,7 +860,6 @@ int swWorker_loop(swFactory *factory, int worker_id)
 
     if (serv->dispatch_mode == SW_DISPATCH_STREAM)
     {
-        SwooleG.main_reactor->add(SwooleG.main_reactor, serv->stream_fd, SW_FD_LISTEN | SW_EVENT_READ);
         SwooleG.main_reactor->setHandle(SwooleG.main_reactor, SW_FD_LISTEN, swWorker_onStreamAccept);
         SwooleG.main_reactor->setHandle(SwooleG.main_reactor, SW_FD_STREAM, swWorker_onStreamRead);
         swStream_set_protocol(&serv->stream_protocol);
@@ -722,6 +870,17 @@ int swWorker_loop(swFactory *factory, int worker_id)
 
     swWorker_onStart(serv);
 
+    /**
+     * the standby worker has run onWorkerStart, its event loop starts when the manager hands over the slot
+     */
+    if (SwooleWG.standby && swWorker_standby_wait(serv, swServer_get_worker(serv, worker_id)) < 0)
+    {
+        swWorker_onStop(serv);
+        return SW_OK;
+    }
+
+    swWorker_start_receive(serv);
+
     //main loop
     SwooleG.main_reactor->wait(SwooleG.main_reactor, NULL);
     //clear pipe buffer
@@ -731,6 +890,102 @@ int swWorker_loop(swFactory *factory, int worker_id)
     return SW_OK;
 }
 
+/**
+ * the worker takes the requests of its slot
+ */
+static void swWorker_start_receive(swServer *serv)
+{
+    swReactor *reactor = SwooleG.main_reactor;
+
+    reactor->add(reactor, SwooleWG.worker->pipe_worker, SW_FD_PIPE | SW_EVENT_READ);
+    reactor->setHandle(reactor, SW_FD_PIPE, swWorker_onPipeReceive);
+    if (serv->dispatch_mode == SW_DISPATCH_STREAM)
+    {
+        reactor->add(reactor, serv->stream_fd, SW_FD_LISTEN | SW_EVENT_READ);
+    }
+    //the requests sent to the previous worker
+    if (serv->ipc_rings)
+    {
+        swWorker_recover_rings(serv, SwooleWG.worker);
+        swWorker_onRingReceive(serv, SwooleWG.worker);
+    }
+}
+
+static sig_atomic_t standby_discarded = 0;
+
+static void swWorker_standby_signal_handler(int signo)
+{
+    standby_discarded = 1;
+}
+
+/**
+ * [standby_worker_num] blocks until the previous worker of the slot has stopped receiving,
+ * returns SW_ERR if the standby worker is discarded or the manager has exited
+ */
+static int swWorker_standby_wait(swServer *serv, swWorker *worker)
+{
+    swWorkerStopMessage msg;
+    sigset_t block_mask, old_mask, wait_mask;
+    fd_set rfds;
+    ssize_t n = -1;
+    char c;
+
+    msg.pid = SwooleG.pid;
+    msg.worker_id = SwooleWG.id;
+    msg.type = SW_WORKER_MESSAGE_STANDBY_READY;
+    if (swChannel_push(serv->message_box, &msg, sizeof(msg)) == SW_OK)
+    {
+        swKill(serv->gs->manager_pid, SIGIO);
+    }
+
+    /**
+     * the reactor does not run before the slot is handed over, SIGTERM is only unblocked inside pselect,
+     * so it cannot be missed, nor reach swWorker_stop and change the slot
+     */
+    sigemptyset(&block_mask);
+    sigaddset(&block_mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &block_mask, &old_mask);
+    wait_mask = old_mask;
+    sigdelset(&wait_mask, SIGTERM);
+    swSignal_set(SIGTERM, swWorker_standby_signal_handler, 0, 0);
+
+    while (!standby_discarded)
+    {
+        FD_ZERO(&rfds);
+        FD_SET(SwooleWG.standby_fd, &rfds);
+        if (pselect(SwooleWG.standby_fd + 1, &rfds, NULL, NULL, NULL, &wait_mask) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            swSysError("pselect() failed.");
+            break;
+        }
+        n = read(SwooleWG.standby_fd, &c, 1);
+        break;
+    }
+    close(SwooleWG.standby_fd);
+    SwooleWG.standby_fd = 0;
+    if (n != 1)
+    {
+        return SW_ERR;
+    }
+    swSignal_add(SIGTERM, swWorker_signal_handler);
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+
+    SwooleWG.standby = 0;
+    worker->status = SW_WORKER_IDLE;
+    worker->start_time = serv->gs->now;
+    worker->request_time = 0;
+    worker->request_count = 0;
+    if (serv->hooks[SW_SERVER_HOOK_WORKER_ACTIVATE])
+    {
+        swServer_call_hook(serv, SW_SERVER_HOOK_WORKER_ACTIVATE, serv);
+    }
+    return SW_OK;
+}
+
 /**
  * Send data to ReactorThread
  */
@@ -750,6 +1005,542 @@ int swWorker_send2reactor(swServer *serv, swEventData *ev_data, size_t sendn, in
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+/**
+ * [Worker] queue a datagram, the queue is flushed at the end of the loop iteration
+ */
+int swWorker_dgram_send(swServer *serv, int fd, swSocketAddress *addr, char *data, uint32_t length)
+{
+    swDgramQueue *queue = SwooleWG.dgram_queue;
+    if (queue == NULL)
+    {
+        queue = (swDgramQueue *) sw_calloc(1, sizeof(swDgramQueue));
+        if (queue == NULL)
+        {
+            swWarn("malloc(%ld) failed.", sizeof(swDgramQueue));
+            return SW_ERR;
+        }
+        queue->data = swString_new(SW_BUFFER_SIZE_BIG);
+        if (queue->data == NULL)
+        {
+            sw_free(queue);
+            return SW_ERR;
+        }
+        SwooleWG.dgram_queue = queue;
+    }
+    if (swString_append_ptr(queue->data, data, length) < 0)
+    {
+        return SW_ERR;
+    }
+
+    int i = queue->num++;
+    queue->list[i].fd = fd;
+    queue->list[i].offset = queue->data->length - length;
+    queue->list[i].length = length;
+    queue->list[i].addr = *addr;
+
+    if (queue->num == SW_UDP_BATCH_NUM || SwooleG.main_reactor == NULL)
+    {
+        swWorker_dgram_flush(NULL);
+    }
+    else if (!queue->flush_deferred)
+    {
+        queue->flush_deferred = 1;
+        SwooleG.main_reactor->defer(SwooleG.main_reactor, swWorker_dgram_flush, NULL);
+    }
+    return SW_OK;
+}
+
+static int swWorker_dgram_sendmmsg(int fd, struct mmsghdr *msgs, int num, int *sent)
+{
+    *sent = 0;
+    while (*sent < num)
+    {
+        int n = sendmmsg(fd, msgs + *sent, num - *sent, 0);
+        if (n > 0)
+        {
+            *sent += n;
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n < 0 && errno == EAGAIN && swSocket_wait(fd, 1000, SW_EVENT_WRITE) == SW_OK)
+        {
+            continue;
+        }
+        else
+        {
+            return SW_ERR;
+        }
+    }
+    return SW_OK;
+}
+
+/**
+ * [Worker] send the queued datagrams, one sendmmsg() per socket
+ */
+void swWorker_dgram_flush(void *data)
+{
+    swDgramQueue *queue = SwooleWG.dgram_queue;
+    swServer *serv = (swServer *) SwooleG.serv;
+    struct mmsghdr msgs[SW_UDP_BATCH_NUM];
+    struct iovec iov[SW_UDP_BATCH_NUM];
+    char control[SW_UDP_BATCH_NUM][CMSG_SPACE(sizeof(uint16_t))];
+    //the first and the last queued datagram of each message
+    int first[SW_UDP_BATCH_NUM], last[SW_UDP_BATCH_NUM];
+    uint8_t done[SW_UDP_BATCH_NUM];
+    int i, j, n, sent;
+
+    if (queue == NULL)
+    {
+        return;
+    }
+    queue->flush_deferred = 0;
+    bzero(done, sizeof(done));
+
+    for (i = 0; i < queue->num; i++)
+    {
+        if (done[i])
+        {
+            continue;
+        }
+        int fd = queue->list[i].fd;
+        n = 0;
+        for (j = i; j < queue->num; j++)
+        {
+            if (done[j] || queue->list[j].fd != fd)
+            {
+                continue;
+            }
+            done[j] = 1;
+#ifdef UDP_SEGMENT
+            /**
+             * GSO: the segments must be sent to the same address, all of them except the last have the same size,
+             * the data of the queue is contiguous only when the datagrams are adjacent.
+             */
+            if (n > 0 && serv->udp_gso && !queue->gso_disabled && last[n - 1] == j - 1)
+            {
+                int k = first[n - 1];
+                uint32_t seg_size = queue->list[k].length;
+                int seg_num = j - k;
+                if (queue->list[j - 1].length == seg_size && queue->list[j].length <= seg_size
+                        && seg_num < SW_UDP_GSO_MAX_SEGMENTS && iov[n - 1].iov_len + queue->list[j].length <= SW_UDP_GSO_MAX_SIZE
+                        && queue->list[j].addr.len == queue->list[k].addr.len
+                        && memcmp(&queue->list[j].addr.addr, &queue->list[k].addr.addr, queue->list[k].addr.len) == 0)
+                {
+                    last[n - 1] = j;
+                    iov[n - 1].iov_len += queue->list[j].length;
+                    continue;
+                }
+            }
+#endif
+            first[n] = last[n] = j;
+            iov[n].iov_base = queue->data->str + queue->list[j].offset;
+            iov[n].iov_len = queue->list[j].length;
+            n++;
+        }
+
+        bzero(msgs, sizeof(struct mmsghdr) * n);
+        for (j = 0; j < n; j++)
+        {
+            struct msghdr *msg = &msgs[j].msg_hdr;
+            msg->msg_name = &queue->list[first[j]].addr.addr;
+            msg->msg_namelen = queue->list[first[j]].addr.len;
+            msg->msg_iov = &iov[j];
+            msg->msg_iovlen = 1;
+#ifdef UDP_SEGMENT
+            if (last[j] > first[j])
+            {
+                msg->msg_control = control[j];
+                msg->msg_controllen = sizeof(control[j]);
+                struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                *(uint16_t *) CMSG_DATA(cmsg) = (uint16_t) queue->list[first[j]].length;
+            }
+#endif
+        }
+
+        int offset = 0;
+        while (swWorker_dgram_sendmmsg(fd, msgs + offset, n - offset, &sent) < 0)
+        {
+            offset += sent;
+            int k = first[offset];
+            if (last[offset] > k)
+            {
+                //the kernel or the device does not support UDP_SEGMENT
+                swSysError("sendmmsg(%d) with UDP_SEGMENT failed, GSO is disabled.", fd);
+                queue->gso_disabled = 1;
+                for (; k <= last[offset]; k++)
+                {
+                    swSocket_sendto_blocking(fd, queue->data->str + queue->list[k].offset, queue->list[k].length, 0,
+                            (struct sockaddr *) &queue->list[k].addr.addr, queue->list[k].addr.len);
+                }
+            }
+            else
+            {
+                swSysError("sendmmsg(%d) failed.", fd);
+            }
+            if (++offset == n)
+            {
+                break;
+            }
+        }
+    }
+
+    queue->num = 0;
+    swString_clear(queue->data);
+}
+#endif
+
+/**
+ * [Worker] wake up the reactor thread if it is waiting on the pipe
+ */
+static sw_inline int swWorker_ring_notify(swServer *serv, swShmRing *ring, int reactor_id)
+{
+    sw_atomic_memory_barrier();
+    if (ring->consumer_wait && sw_atomic_cmp_set(&ring->consumer_wait, 1, 0))
+    {
+        swDataHead ev;
+        bzero(&ev, sizeof(ev));
+        ev.from_id = reactor_id;
+        ev.from_fd = SW_RESPONSE_RING_NOTIFY;
+        return swWorker_send2reactor(serv, (swEventData *) &ev, sizeof(ev), 0);
+    }
+    return SW_OK;
+}
+
+static sw_inline void* swWorker_ring_alloc(swShmRing *ring, uint32_t length)
+{
+    void *ptr = swShmRing_alloc(ring, length);
+    if (ptr == NULL)
+    {
+        ring->producer_wait = 1;
+        sw_atomic_memory_barrier();
+        //the reactor thread may have released some items in the meantime
+        ptr = swShmRing_alloc(ring, length);
+        if (ptr)
+        {
+            ring->producer_wait = 0;
+        }
+    }
+    return ptr;
+}
+
+static int swWorker_ring_push(swShmRing *ring, int reactor_id, swDataHead *info, char *data, uint32_t length)
+{
+    swBuffer *buffer = SwooleWG.ring_buffers ? SwooleWG.ring_buffers[reactor_id] : NULL;
+    char *ptr;
+
+    if (swBuffer_empty(buffer))
+    {
+        ptr = (char *) swWorker_ring_alloc(ring, sizeof(*info) + length);
+        if (ptr)
+        {
+            memcpy(ptr, info, sizeof(*info));
+            memcpy(ptr + sizeof(*info), data, length);
+            swShmRing_commit(ring);
+            return SW_OK;
+        }
+    }
+
+    //the ring is full, keep the response until the reactor thread notifies us [SW_EVENT_DATA_RING]
+    if (SwooleWG.ring_buffers == NULL)
+    {
+        SwooleWG.ring_buffers = (swBuffer **) sw_calloc(SwooleG.serv->reactor_num, sizeof(swBuffer *));
+        if (SwooleWG.ring_buffers == NULL)
+        {
+            swWarn("calloc(%d) failed.", (int) (SwooleG.serv->reactor_num * sizeof(swBuffer *)));
+            return SW_ERR;
+        }
+    }
+    if (buffer == NULL)
+    {
+        buffer = swBuffer_new(0);
+        if (buffer == NULL)
+        {
+            return SW_ERR;
+        }
+        SwooleWG.ring_buffers[reactor_id] = buffer;
+    }
+    swBuffer_chunk *chunk = swBuffer_new_chunk(buffer, SW_CHUNK_DATA, sizeof(*info) + length);
+    if (chunk == NULL)
+    {
+        return SW_ERR;
+    }
+    ptr = (char *) chunk->store.ptr;
+    memcpy(ptr, info, sizeof(*info));
+    memcpy(ptr + sizeof(*info), data, length);
+    chunk->length = sizeof(*info) + length;
+    buffer->length += chunk->length;
+    return SW_OK;
+}
+
+/**
+ * [Worker] move the pending responses into the ring after the reactor thread has released some space
+ */
+static int swWorker_ring_flush(swServer *serv, int reactor_id)
+{
+    swBuffer *buffer = SwooleWG.ring_buffers[reactor_id];
+    swShmRing *ring = swServer_get_response_ring(serv, SwooleWG.id, reactor_id);
+    swBuffer_chunk *chunk;
+    void *ptr;
+
+    if (swBuffer_empty(buffer))
+    {
+        return SW_OK;
+    }
+    while (!swBuffer_empty(buffer))
+    {
+        chunk = swBuffer_get_chunk(buffer);
+        ptr = swWorker_ring_alloc(ring, chunk->length);
+        if (ptr == NULL)
+        {
+            break;
+        }
+        memcpy(ptr, chunk->store.ptr, chunk->length);
+        swShmRing_commit(ring);
+        swBuffer_pop_chunk(buffer, chunk);
+    }
+    return swWorker_ring_notify(serv, ring, reactor_id);
+}
+
+/**
+ * [Worker] the worker is exiting and must not write to the rings anymore,
+ * the responses still waiting for ring space are sent through the pipe
+ */
+static void swWorker_ring_handover(swServer *serv)
+{
+    swBuffer *buffer;
+    swBuffer_chunk *chunk;
+    swSendData _send;
+    int i;
+
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        buffer = SwooleWG.ring_buffers[i];
+        if (buffer == NULL)
+        {
+            continue;
+        }
+        swWorker_ring_flush(serv, i);
+        while (!swBuffer_empty(buffer))
+        {
+            chunk = swBuffer_get_chunk(buffer);
+            memcpy(&_send.info, chunk->store.ptr, sizeof(_send.info));
+            _send.data = (char *) chunk->store.ptr + sizeof(_send.info);
+            _send.length = chunk->length - sizeof(_send.info);
+            serv->factory.finish(&serv->factory, &_send);
+            swBuffer_pop_chunk(buffer, chunk);
+        }
+    }
+}
+
+/**
+ * [Worker] each worker owns one response ring per reactor thread, the item is [swDataHead][data],
+ * so a response is not limited by swDataHead.len and does not need the send_shm lock
+ */
+int swWorker_send2ring(swServer *serv, swDataHead *info, char *data, uint32_t length)
+{
+    int reactor_id = info->from_id;
+    swShmRing *ring = swServer_get_response_ring(serv, SwooleWG.id, reactor_id);
+    uint32_t chunk_size = ring->size / 4;
+    uint32_t offset = 0;
+    uint32_t n;
+    swDataHead head = *info;
+
+    do
+    {
+        n = length - offset > chunk_size ? chunk_size : length - offset;
+        head.len = n;
+        if (swWorker_ring_push(ring, reactor_id, &head, data + offset, n) < 0)
+        {
+            return SW_ERR;
+        }
+        offset += n;
+    } while (offset < length);
+
+    return swWorker_ring_notify(serv, ring, reactor_id);
+}
+
+/**
+ * the worker exits after the current request, the item must not be used in place,
+ * otherwise the new worker may see it again before it is released
+ */
+static sw_inline int swWorker_is_last_request(swWorker *worker)
+{
+    return !SwooleWG.run_always && worker->request_count + 1 >= SwooleWG.max_request;
+}
+
+/**
+ * [Worker] consume the shared memory rings of all reactor threads,
+ * at most SW_IPC_RING_BATCH_NUM requests, so the timers and the other fds of the worker are not starved
+ */
+static void swWorker_onRingReceive(swServer *serv, swWorker *worker)
+{
+    swFactory *factory = &serv->factory;
+    swShmRing *ring;
+    swEventData *task;
+    uint32_t length;
+    int i, n;
+    int count = 0;
+
+    //the reactor threads have released some space of the response rings
+    if (SwooleWG.ring_buffers)
+    {
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            swWorker_ring_flush(serv, i);
+        }
+    }
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        swServer_get_ipc_ring(serv, i, worker->id)->consumer_wait = 0;
+    }
+
+    while (1)
+    {
+        n = 0;
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            ring = swServer_get_ipc_ring(serv, i, worker->id);
+            while ((task = (swEventData *) swShmRing_peek(ring, &length)))
+            {
+                if (SwooleWG.wait_exit || !SwooleG.main_reactor->running)
+                {
+                    return;
+                }
+                if (swWorker_is_last_request(worker))
+                {
+                    swEventData *copy = (swEventData *) sw_malloc(length);
+                    if (copy == NULL)
+                    {
+                        swWarn("malloc(%d) failed.", length);
+                        return;
+                    }
+                    memcpy(copy, task, length);
+                    swShmRing_release(ring);
+                    swWorker_onTask(factory, copy);
+                    sw_free(copy);
+                }
+                else
+                {
+                    ring->consumer_busy = 1;
+                    swWorker_onTask(factory, task);
+                    swShmRing_release(ring);
+                    ring->consumer_busy = 0;
+                }
+                n++;
+
+                //notify the reactor thread to move the pending requests into the ring
+                if (ring->producer_wait && sw_atomic_cmp_set(&ring->producer_wait, 1, 0))
+                {
+                    swDataHead ev;
+                    bzero(&ev, sizeof(ev));
+                    ev.fd = worker->id;
+                    ev.from_id = i;
+                    ev.from_fd = SW_RESPONSE_RING_RESUME;
+                    swWorker_send2reactor(serv, (swEventData *) &ev, sizeof(ev), 0);
+                }
+                //consumer_wait is still 0, the reactor threads do not notify us, take the rest in the next loop
+                if (++count == SW_IPC_RING_BATCH_NUM)
+                {
+                    if (!SwooleWG.ring_deferred)
+                    {
+                        SwooleWG.ring_deferred = 1;
+                        SwooleG.main_reactor->defer(SwooleG.main_reactor, swWorker_onRingDefer, NULL);
+                    }
+                    return;
+                }
+            }
+        }
+        if (n > 0)
+        {
+            continue;
+        }
+        //no more requests, the reactor threads must wake us up through the pipe
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            swServer_get_ipc_ring(serv, i, worker->id)->consumer_wait = 1;
+        }
+        sw_atomic_memory_barrier();
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            if (!swShmRing_empty(swServer_get_ipc_ring(serv, i, worker->id)))
+            {
+                break;
+            }
+        }
+        if (i == serv->reactor_num)
+        {
+            return;
+        }
+    }
+}
+
+static void swWorker_onRingDefer(void *data)
+{
+    SwooleWG.ring_deferred = 0;
+    swWorker_onRingReceive(SwooleG.serv, SwooleWG.worker);
+}
+
+/**
+ * [Worker] the previous worker died while handling the oldest item, drop it
+ */
+static void swWorker_recover_rings(swServer *serv, swWorker *worker)
+{
+    swShmRing *ring;
+    swDataHead *info;
+    uint32_t length;
+    int i;
+
+    for (i = 0; i < serv->reactor_num; i++)
+    {
+        ring = swServer_get_ipc_ring(serv, i, worker->id);
+        if (ring->consumer_busy && (info = (swDataHead *) swShmRing_peek(ring, &length)))
+        {
+            swWarn("[Worker#%d] discard the request[fd=%d, type=%d, length=%d] of the exited worker.", worker->id,
+                    info->fd, info->type, info->len);
+            swShmRing_release(ring);
+        }
+        ring->consumer_busy = 0;
+    }
+}
+
+/**
+ * [Worker] a pipe message may hold many events coalesced by the reactor thread
+ */
+static int swWorker_onPipeBatchReceive(swServer *serv, int fd)
+{
+    uint64_t buffer[SW_IPC_BATCH_SIZE / sizeof(uint64_t)];
+    swFactory *factory = &serv->factory;
+
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n <= 0)
+    {
+        return SW_ERR;
+    }
+    swEventData *task = (swEventData *) buffer;
+    if (!(task->info.flags & SW_EVENT_DATA_BATCH))
+    {
+        return swWorker_onTask(factory, task);
+    }
+
+    char *ptr = (char *) buffer + SW_IPC_BATCH_HEAD_SIZE;
+    char *end = (char *) buffer + n;
+    uint64_t length;
+
+    while (ptr < end)
+    {
+        memcpy(&length, ptr, sizeof(length));
+        swWorker_onTask(factory, (swEventData *) (ptr + sizeof(length)));
+        ptr += SW_IPC_BATCH_ITEM_SIZE(length);
+    }
+    return SW_OK;
+}
+
 /**
  * receive data from reactor
  */
@@ -760,10 +1551,21 @@ static int swWorker_onPipeReceive(swReactor *reactor, swEvent *event)
     swFactory *factory = &serv->factory;
     int ret;
 
+    if (serv->ipc_batch_size > 0)
+    {
+        return swWorker_onPipeBatchReceive(serv, event->fd);
+    }
+
     read_from_pipe:
 
     if (read(event->fd, &task, sizeof(task)) > 0)
     {
+        //the requests are in the shared memory rings
+        if (task.info.flags & SW_EVENT_DATA_RING)
+        {
+            swWorker_onRingReceive(serv, SwooleWG.worker);
+            return SW_OK;
+        }
         ret = swWorker_onTask(factory, &task);
 #ifndef SW_WORKER_RECV_AGAIN
         /**
@@ -814,6 +1616,11 @@ int swWorker_send2worker(swWorker *dst_worker, void *buf, int n, int flag)
 
         return swMsgQueue_push(dst_worker->pool->queue, (swQueue_data *) &msg, n);
     }
+    //shared memory queue, taken by any idle worker
+    if (dst_worker->pool->use_shm_queue)
+    {
+        return swShmQueue_push(dst_worker->pool->shm_queue, buf, n, 1);
+    }
 
     if ((flag & SW_PIPE_NONBLOCK) && SwooleG.main_reactor)
     {
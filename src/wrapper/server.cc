@@ -177,8 +177,15 @@ static int task_pack(swEventData *task, const DataBuffer &data)
 static DataBuffer task_unpack(swEventData *task_result)
 {
     DataBuffer retval;
-    swString *result = swTaskWorker_large_unpack(task_result);
-    if (result)
+    if (swTask_type(task_result) & SW_TASK_TMPFILE)
+    {
+        swString *result = swTaskWorker_large_unpack(task_result);
+        if (result)
+        {
+            retval.copy(result->str, result->length);
+        }
+    }
+    else
     {
         retval.copy(task_result->data, (size_t) task_result->info.len);
     }
@@ -581,11 +588,11 @@ DataBuffer Server::taskwait(const DataBuffer &data, double timeout, int dst_work
         return retval;
     }
 
-    task_pack(&buf, data);
+    int task_id = task_pack(&buf, data);
 
     uint64_t notify;
-    swEventData *task_result = &(serv.task_result[SwooleWG.id]);
-    bzero(task_result, sizeof(swEventData));
+    swEventData task_result;
+    swTaskWorker_reset_result(&serv, SwooleWG.id);
     swPipe *task_notify_pipe = &serv.task_notify[SwooleWG.id];
     int efd = task_notify_pipe->getFd(task_notify_pipe, 0);
 
@@ -597,15 +604,18 @@ DataBuffer Server::taskwait(const DataBuffer &data, double timeout, int dst_work
     {
         sw_atomic_fetch_add(&serv.stats->tasking_num, 1);
         task_notify_pipe->timeout = timeout;
-        int ret = task_notify_pipe->read(task_notify_pipe, &notify, sizeof(notify));
-        if (ret > 0)
-        {
-            return task_unpack(task_result);
-        }
-        else
+        while (task_notify_pipe->read(task_notify_pipe, &notify, sizeof(notify)) > 0)
         {
-            swWarn("taskwait failed. Error: %s[%d]", strerror(errno), errno);
+            swTaskWorker_take_result(&serv, &task_result);
+            if (task_result.info.type != SW_EVENT_FINISH || task_result.info.fd != task_id)
+            {
+                //the result of a taskwait which timed out
+                swTaskWorker_large_free(&task_result);
+                continue;
+            }
+            return task_unpack(&task_result);
         }
+        swWarn("taskwait failed. Error: %s[%d]", strerror(errno), errno);
     }
     return retval;
 }
@@ -629,8 +639,8 @@ map<int, DataBuffer> Server::taskWaitMulti(const vector<DataBuffer> &tasks, doub
     int list_of_id[1024];
 
     uint64_t notify;
+    swTaskWorker_reset_result(&serv, SwooleWG.id);
     swEventData *task_result = &(serv.task_result[SwooleWG.id]);
-    bzero(task_result, sizeof(swEventData));
     swPipe *task_notify_pipe = &serv.task_notify[SwooleWG.id];
     swWorker *worker = swServer_get_worker(&serv, SwooleWG.id);
 
@@ -693,12 +703,15 @@ map<int, DataBuffer> Server::taskWaitMulti(const vector<DataBuffer> &tasks, doub
         else
         {
             swSysError("taskwait failed.");
-            unlink(_tmpfile);
-            return retval;
+            break;
         }
     }
 
+    worker->lock.lock(&worker->lock);
     swString *content = swoole_file_get_contents(_tmpfile);
+    //a late result cannot be appended to the file once it is read
+    unlink(_tmpfile);
+    worker->lock.unlock(&worker->lock);
     if (content == NULL)
     {
         return retval;
@@ -708,22 +721,22 @@ map<int, DataBuffer> Server::taskWaitMulti(const vector<DataBuffer> &tasks, doub
     DataBuffer zdata;
     int j;
 
-    for (i = 0; i < n_task; i++)
+    //every result is unpacked, the large ones hold a task_shm block or a tmpfile
+    while ((size_t) content->offset < content->length)
     {
         result = (swEventData *) (content->str + content->offset);
         task_id = result->info.fd;
         zdata = task_unpack(result);
-        for (j = 0; j < n_task; j++)
+        for (j = 0; j < i; j++)
         {
             if (list_of_id[j] == task_id)
             {
+                retval[j] = zdata;
                 break;
             }
         }
-        retval[j] = zdata;
         content->offset += sizeof(swDataHead) + result->info.len;
     }
-    unlink(_tmpfile);
     swString_free(content);
     return retval;
 }
@@ -590,6 +590,7 @@ PHP_MINIT_FUNCTION(swoole)
     REGISTER_LONG_CONSTANT("SWOOLE_IPC_UNSOCK", SW_TASK_IPC_UNIXSOCK, CONST_CS | CONST_PERSISTENT);
     REGISTER_LONG_CONSTANT("SWOOLE_IPC_MSGQUEUE", SW_TASK_IPC_MSGQUEUE, CONST_CS | CONST_PERSISTENT);
     REGISTER_LONG_CONSTANT("SWOOLE_IPC_PREEMPTIVE", SW_TASK_IPC_PREEMPTIVE, CONST_CS | CONST_PERSISTENT);
+    REGISTER_LONG_CONSTANT("SWOOLE_IPC_SHM_QUEUE", SW_TASK_IPC_SHM_QUEUE, CONST_CS | CONST_PERSISTENT);
 
     /**
      * socket type
@@ -697,6 +698,7 @@ PHP_MINIT_FUNCTION(swoole)
     SWOOLE_DEFINE(ERROR_DATA_LENGTH_TOO_LARGE);
     SWOOLE_DEFINE(ERROR_TASK_PACKAGE_TOO_BIG);
     SWOOLE_DEFINE(ERROR_TASK_DISPATCH_FAIL);
+    SWOOLE_DEFINE(ERROR_TASK_QUEUE_STALLED);
     SWOOLE_DEFINE(ERROR_HTTP2_STREAM_ID_TOO_BIG);
     SWOOLE_DEFINE(ERROR_HTTP2_STREAM_NO_HEADER);
     SWOOLE_DEFINE(ERROR_HTTP2_STREAM_NOT_FOUND);
@@ -897,6 +899,9 @@ PHP_MINFO_FUNCTION(swoole)
 #ifdef HAVE_EPOLL
     php_info_print_table_row(2, "epoll", "enabled");
 #endif
+#ifdef SW_USE_IOURING
+    php_info_print_table_row(2, "io_uring", "enabled");
+#endif
 #ifdef HAVE_EVENTFD
     php_info_print_table_row(2, "eventfd", "enabled");
 #endif
@@ -614,6 +614,11 @@ static void php_swoole_socket_set_ssl(Socket *cli, zval *zset)
     {
         cli->ssl_option.allow_self_signed = zval_is_true(v);
     }
+    //install the session keys into kernel TLS after the handshake
+    if (php_swoole_array_get_value(vht, "ssl_ktls", v))
+    {
+        cli->ssl_option.ktls = zval_is_true(v);
+    }
     if (php_swoole_array_get_value(vht, "ssl_cafile", v))
     {
         zend::string str_v(v);
@@ -49,6 +49,9 @@
 #define SW_SOCKET_BUFFER_SIZE      8388608
 #endif
 #define SW_SYSTEMD_FDS_START       3
+#define SW_HANDOFF_ENV             "SWOOLE_HANDOFF_SOCKET"
+#define SW_HANDOFF_MAX_FD          253   // SCM_MAX_FD
+#define SW_HANDOFF_TIMEOUT         3.0
 
 #define SW_GLOBAL_MEMORY_PAGESIZE  (2*1024*1024) // global memory page
 // #define SW_USE_HUGEPAGE
@@ -72,11 +75,36 @@
 #define SW_IPC_BUFFER_SIZE         (SW_IPC_MAX_SIZE - sizeof(struct _swDataHead))
 // !!!End.-------------------------------------------------------------------
 
+#define SW_CACHELINE_SIZE          64
+
+#define SW_IPC_RING_SIZE           (1024*1024)   // reactor thread to worker shared memory ring
+#define SW_IPC_RING_MIN_SIZE       65536
+#define SW_IPC_RING_BATCH_NUM      256           // requests taken from the rings by a worker before it goes back to the event loop
+
+#define SW_IPC_BATCH_SIZE          65536         // maximum size of the coalesced pipe message from reactor thread to worker
+
+#define SW_IPC_HIGH_WATERMARK      (64*1024*1024) // stop reading the connections dispatched to the worker with more bytes queued
+#define SW_IPC_RESUME_INTERVAL     10            // msec, check the paused workers at least this often
+
+#define SW_DISPATCH_EWMA_SHIFT     3             // weight 1/8 of the new sample in the average service time
+#define SW_REACTOR_EWMA_SHIFT      2             // weight 1/4 of the last second in the event rate of reactor threads
+
 #define SW_BUFFER_SIZE_STD         8192
 #define SW_BUFFER_SIZE_BIG         65536
 #define SW_BUFFER_SIZE_UDP         65536
+#define SW_BUFFER_RECV_MAX_SIZE    (1024*1024)   // bytes read from one connection in one read event, the reactor polls the others first
 // #define SW_BUFFER_RECV_TIME
 
+#define SW_BUFFER_SLAB_CHUNK_NUM   4096          // maximum number of the recycled chunk headers of each reactor thread
+#define SW_BUFFER_SLAB_STD_NUM     256           // maximum number of the recycled SW_BUFFER_SIZE_STD blocks
+#define SW_BUFFER_SLAB_BIG_NUM     32            // maximum number of the recycled SW_BUFFER_SIZE_BIG blocks
+
+#define SW_UDP_BATCH_NUM           16            // datagrams received by one recvmmsg() or sent by one sendmmsg()
+#define SW_UDP_GSO_MAX_SEGMENTS    64            // the kernel limit of the segments in one UDP_SEGMENT send
+#define SW_UDP_GSO_MAX_SIZE        65507         // maximum payload of one UDP_SEGMENT send
+
+#define SW_ZEROCOPY_MIN_SIZE       16384         // smaller output is copied, pinning the pages costs more than the copy
+
 #define SW_SENDFILE_CHUNK_SIZE     65536
 #define SW_SENDFILE_MAXLEN         4194304
 
@@ -103,9 +131,11 @@
 
 #define SW_WORKER_USE_SIGNALFD           1
 #define SW_WORKER_MAX_WAIT_TIME          30
+#define SW_RELOAD_READY_TIMEOUT          3     // [reload_batch_num] an idle replacement counts as ready after it, seconds
 
 #define SW_REACTOR_MAXEVENTS             4096
-#define SW_SESSION_LIST_SIZE             (1*1024*1024)
+#define SW_REACTOR_IOURING_ENTRIES       4096  // io_uring SQ ring size, the CQ ring is twice as large
+#define SW_SESSION_MAX_NUM               (8*1024*1024)  // max_connection limit, the session table has twice as many slots
 
 #define SW_MSGMAX                        65536
 
@@ -151,6 +181,7 @@
  * max accept times for single time
  */
 #define SW_ACCEPT_MAX_COUNT              64
+#define SW_ACCEPT_RETRY_TIME             1000  //msec, reactor thread listening again after EMFILE
 
 #define SW_TCP_KEEPCOUNT                 5
 #define SW_TCP_KEEPIDLE                  3600 // 1 hour
@@ -160,6 +191,10 @@
 
 #define SW_TASK_TMP_FILE                 "/tmp/swoole.task.XXXXXX"
 #define SW_TASK_TMPDIR_SIZE              128
+#define SW_TASK_SHM_SIZE                 (32 * 1024 * 1024) // shared arena for the large task packages
+#define SW_TASK_SHM_PAGE_SIZE            4096
+#define SW_SHM_QUEUE_SIZE                1024 // slots of the shared memory queue of the process pool
+#define SW_SHM_QUEUE_CHECK_INTERVAL      5    // seconds, the manager reports the task queue stuck at a slot
 
 #define SW_FILE_CHUNK_SIZE               65536
 
@@ -172,6 +207,10 @@
 #define SW_SSL_ECDH_CURVE                "secp384r1"
 #define SW_SSL_NPN_ADVERTISE             "\x08http/1.1"
 #define SW_SSL_HTTP2_NPN_ADVERTISE       "\x02h2"
+#define SW_SSL_SESSION_TIMEOUT           300     // seconds, the default of OpenSSL
+#define SW_SSL_SESSION_MAX_SIZE          4096    // sessions larger than this are not kept in the shared cache
+#define SW_SSL_TICKET_KEY_NUM            3       // the current key and the previous ones still accepted for decryption
+#define SW_SSL_TICKET_KEY_ROTATE         3600    // seconds
 
 #define SW_SPINLOCK_LOOP_N               1024
 
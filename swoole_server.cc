@@ -300,6 +300,7 @@ static PHP_METHOD(swoole_server, taskWaitMulti);
 static PHP_METHOD(swoole_server, taskCo);
 static PHP_METHOD(swoole_server, finish);
 static PHP_METHOD(swoole_server, reload);
+static PHP_METHOD(swoole_server, ready);
 static PHP_METHOD(swoole_server, shutdown);
 static PHP_METHOD(swoole_server, heartbeat);
 static PHP_METHOD(swoole_server, connection_list);
@@ -359,6 +360,7 @@ static zend_function_entry swoole_server_methods[] = {
 #endif
     PHP_ME(swoole_server, finish, arginfo_swoole_server_finish, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_server, reload, arginfo_swoole_server_reload, ZEND_ACC_PUBLIC)
+    PHP_ME(swoole_server, ready, arginfo_swoole_void, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_server, shutdown, arginfo_swoole_void, ZEND_ACC_PUBLIC)
     PHP_ME(swoole_server, stop, arginfo_swoole_server_stop, ZEND_ACC_PUBLIC)
     PHP_FALIAS(getLastError, swoole_last_error, arginfo_swoole_void)
@@ -427,6 +429,7 @@ static void php_swoole_onStart(swServer *);
 static void php_swoole_onShutdown(swServer *);
 static void php_swoole_onWorkerStart(swServer *, int worker_id);
 static void php_swoole_onWorkerStop(swServer *, int worker_id);
+static void php_swoole_onWorkerActivate(void *arg);
 static void php_swoole_onWorkerExit(swServer *serv, int worker_id);
 static void php_swoole_onUserWorkerStart(swServer *serv, swWorker *worker);
 static int php_swoole_onTask(swServer *, swEventData *task);
@@ -528,6 +531,7 @@ void swoole_server_init(int module_number)
     zend_declare_property_long(swoole_server_ce_ptr, ZEND_STRL("manager_pid"), 0, ZEND_ACC_PUBLIC);
     zend_declare_property_long(swoole_server_ce_ptr, ZEND_STRL("worker_id"), -1, ZEND_ACC_PUBLIC);
     zend_declare_property_bool(swoole_server_ce_ptr, ZEND_STRL("taskworker"), 0, ZEND_ACC_PUBLIC);
+    zend_declare_property_bool(swoole_server_ce_ptr, ZEND_STRL("standby"), 0, ZEND_ACC_PUBLIC);
     zend_declare_property_long(swoole_server_ce_ptr, ZEND_STRL("worker_pid"), 0, ZEND_ACC_PUBLIC);
 
     zend_declare_property_null(swoole_server_task_ce_ptr, ZEND_STRL("data"), ZEND_ACC_PUBLIC);
@@ -986,6 +990,15 @@ void php_swoole_server_before_start(swServer *serv, zval *zobject)
     }
 #endif
 
+    if (serv->standby_worker_num > 0)
+    {
+        if (swServer_add_hook(serv, SW_SERVER_HOOK_WORKER_ACTIVATE, php_swoole_onWorkerActivate, 1) < 0)
+        {
+            swoole_php_fatal_error(E_ERROR, "Unable to add server hook.");
+            return;
+        }
+    }
+
     int i;
     zval *retval = NULL;
     zval *zport_object;
@@ -1695,6 +1708,11 @@ static void php_swoole_onWorkerStart(swServer *serv, int worker_id)
      */
     zend_update_property_long(swoole_server_ce_ptr, zserv, ZEND_STRL("worker_pid"), getpid());
 
+    /**
+     * [standby_worker_num] the slot is still used by the worker that this one replaces
+     */
+    zend_update_property_bool(swoole_server_ce_ptr, zserv, ZEND_STRL("standby"), SwooleWG.standby);
+
     /**
      * Have not set the event callback
      */
@@ -1719,6 +1737,12 @@ static void php_swoole_onWorkerStart(swServer *serv, int worker_id)
     }
 }
 
+static void php_swoole_onWorkerActivate(void *arg)
+{
+    swServer *serv = (swServer *) arg;
+    zend_update_property_bool(swoole_server_ce_ptr, (zval *) serv->ptr2, ZEND_STRL("standby"), 0);
+}
+
 static void php_swoole_onWorkerStop(swServer *serv, int worker_id)
 {
     if (SwooleWG.shutdown)
@@ -2330,6 +2354,15 @@ static PHP_METHOD(swoole_server, set)
         }
         serv->pid_file = zend::string::dup(v);
     }
+    //hand over the listening sockets to the next master
+    if (php_swoole_array_get_value(vht, "handoff_socket", v))
+    {
+        if (serv->handoff_socket)
+        {
+            sw_free(serv->handoff_socket);
+        }
+        serv->handoff_socket = zend::string::dup(v);
+    }
     //reactor thread num
     if (php_swoole_array_get_value(vht, "reactor_num", v))
     {
@@ -2378,6 +2411,23 @@ static PHP_METHOD(swoole_server, set)
     {
         serv->dispatch_mode = (uint8_t) zval_get_long(v);
     }
+    //reactor_dispatch_mode
+    if (php_swoole_array_get_value(vht, "reactor_dispatch_mode", v))
+    {
+        long reactor_dispatch_mode = zval_get_long(v);
+        if (reactor_dispatch_mode < SW_REACTOR_DISPATCH_FDMOD || reactor_dispatch_mode > SW_REACTOR_DISPATCH_LEAST_EVENT)
+        {
+            swoole_php_fatal_error(E_WARNING, "invalid reactor_dispatch_mode[%ld].", reactor_dispatch_mode);
+            reactor_dispatch_mode = SW_REACTOR_DISPATCH_FDMOD;
+        }
+        serv->reactor_dispatch_mode = (uint8_t) reactor_dispatch_mode;
+    }
+    //dispatch_hash_num
+    if (php_swoole_array_get_value(vht, "dispatch_hash_num", v))
+    {
+        long dispatch_hash_num = zval_get_long(v);
+        serv->dispatch_hash_num = SW_MAX(0, SW_MIN(dispatch_hash_num, UINT16_MAX));
+    }
     //dispatch function
     if (php_swoole_array_get_value(vht, "dispatch_func", v))
     {
@@ -2498,7 +2548,7 @@ static PHP_METHOD(swoole_server, set)
             serv->request_slowlog_timeout = 1;
         }
     }
-    //task ipc mode, 1,2,3
+    //task ipc mode, 1,2,3,4,5
     if (php_swoole_array_get_value(vht, "task_ipc_mode", v))
     {
         serv->task_ipc_mode = (uint8_t) zval_get_long(v);
@@ -2521,6 +2571,12 @@ static PHP_METHOD(swoole_server, set)
         SwooleG.task_tmpdir = (char*) sw_malloc(str_v.len() + sizeof(SW_TASK_TMP_FILE) + 1);
         SwooleG.task_tmpdir_len = sw_snprintf(SwooleG.task_tmpdir, SW_TASK_TMPDIR_SIZE, "%s/swoole.task.XXXXXX", str_v.val()) + 1;
     }
+    //shared memory for the large task packages, 0 to use tmpfiles only
+    if (php_swoole_array_get_value(vht, "task_shm_size", v))
+    {
+        long size = zval_get_long(v);
+        serv->task_shm_size = size > 0 ? (size_t) size : 0;
+    }
     //task_max_request
     if (php_swoole_array_get_value(vht, "task_max_request", v))
     {
@@ -2561,11 +2617,61 @@ static PHP_METHOD(swoole_server, set)
     {
         serv->reload_async = zval_is_true(v);
     }
+    //pre-forked workers for reload and max_request
+    if (php_swoole_array_get_value(vht, "standby_worker_num", v))
+    {
+        zend_long num = zval_get_long(v);
+        serv->standby_worker_num = num > 0 ? SW_MIN(num, SW_CPU_NUM * SW_MAX_WORKER_NCPU) : 0;
+    }
+    //rolling reload
+    if (php_swoole_array_get_value(vht, "reload_batch_num", v))
+    {
+        zend_long num = zval_get_long(v);
+        serv->reload_batch_num = num > 0 ? SW_MIN(num, SW_CPU_NUM * SW_MAX_WORKER_NCPU) : 0;
+    }
+    if (php_swoole_array_get_value(vht, "reload_batch_ratio", v))
+    {
+        double ratio = zval_get_double(v);
+        serv->reload_batch_ratio = ratio > 0 ? SW_MIN(ratio, 1) : 0;
+    }
+    if (php_swoole_array_get_value(vht, "reload_ready_timeout", v))
+    {
+        serv->reload_ready_timeout = zval_get_double(v);
+    }
     //cpu affinity
     if (php_swoole_array_get_value(vht, "open_cpu_affinity", v))
     {
         serv->open_cpu_affinity = zval_is_true(v);
     }
+    //numa affinity
+    if (php_swoole_array_get_value(vht, "open_numa_affinity", v))
+    {
+        serv->open_numa_affinity = zval_is_true(v);
+    }
+#if defined(HAVE_REUSEPORT) && defined(HAVE_EPOLL)
+    //reuse port, each reactor thread listens and accepts in SWOOLE_PROCESS mode
+    if (php_swoole_array_get_value(vht, "enable_reuse_port", v))
+    {
+        SwooleG.reuse_port = zval_is_true(v) && swoole_version_compare(SwooleG.uname.release, "3.9.0") >= 0;
+    }
+    //steer the connection to the reactor thread of the CPU
+    if (php_swoole_array_get_value(vht, "reuse_port_cbpf", v))
+    {
+        serv->reuse_port_cbpf = zval_is_true(v);
+    }
+#endif
+#ifdef HAVE_RECVMMSG
+    //flush the datagrams of the worker with sendmmsg
+    if (php_swoole_array_get_value(vht, "udp_send_batch", v))
+    {
+        serv->udp_send_batch = zval_is_true(v);
+    }
+    //udp segmentation offload
+    if (php_swoole_array_get_value(vht, "udp_gso", v))
+    {
+        serv->udp_gso = zval_is_true(v);
+    }
+#endif
     //cpu affinity set
     if (php_swoole_array_get_value(vht, "cpu_affinity_ignore", v))
     {
@@ -2689,6 +2795,43 @@ static PHP_METHOD(swoole_server, set)
     {
         serv->buffer_output_size = (uint32_t) zval_get_long(v);
     }
+    /**
+     * shared memory rings between reactor threads and workers
+     */
+    if (php_swoole_array_get_value(vht, "enable_ipc_ring", v))
+    {
+        serv->ipc_ring_size = zval_is_true(v) ? SW_IPC_RING_SIZE : 0;
+    }
+    if (php_swoole_array_get_value(vht, "ipc_ring_size", v))
+    {
+        serv->ipc_ring_size = (uint32_t) zval_get_long(v);
+    }
+    /**
+     * coalesce the events to a worker in one pipe write per reactor loop
+     */
+    if (php_swoole_array_get_value(vht, "ipc_batch_size", v))
+    {
+        serv->ipc_batch_size = Z_TYPE_P(v) == IS_TRUE ? SW_IPC_BATCH_SIZE : (uint32_t) zval_get_long(v);
+    }
+    /**
+     * stop reading from the clients of a worker with too many queued ipc bytes, 0 to disable
+     */
+    if (php_swoole_array_get_value(vht, "ipc_high_watermark", v))
+    {
+        serv->ipc_high_watermark = (uint32_t) zval_get_long(v);
+    }
+    if (php_swoole_array_get_value(vht, "ipc_low_watermark", v))
+    {
+        serv->ipc_low_watermark = (uint32_t) zval_get_long(v);
+    }
+#ifdef SW_USE_OPENSSL
+    //the full TLS handshakes run in these threads instead of the reactor threads
+    if (php_swoole_array_get_value(vht, "ssl_handshake_threads", v))
+    {
+        zend_long num = zval_get_long(v);
+        serv->ssl_handshake_thread_num = num > 0 ? SW_MIN(num, SW_CPU_NUM * SW_MAX_THREAD_NCPU) : 0;
+    }
+#endif
     //message queue key
     if (php_swoole_array_get_value(vht, "message_queue_key", v))
     {
@@ -3063,6 +3206,18 @@ static PHP_METHOD(swoole_server, sendto)
     }
 
     int ret;
+#ifdef HAVE_RECVMMSG
+    if (serv->udp_send_batch && swIsWorker())
+    {
+        swSocketAddress addr;
+        if (swSocket_udp_address(ip, port, ipv6, &addr) < 0)
+        {
+            RETURN_FALSE;
+        }
+        ret = swWorker_dgram_send(serv, server_socket, &addr, data, len);
+        SW_CHECK_RETURN(ret);
+    }
+#endif
     if (ipv6)
     {
         ret = swSocket_udp_sendto6(server_socket, ip, port, data, len);
@@ -3238,6 +3393,91 @@ static PHP_METHOD(swoole_server, stats)
         add_assoc_long_ex(return_value, ZEND_STRL("worker_dispatch_count"), SwooleWG.worker->dispatch_count);
     }
 
+    if (serv->task_shm)
+    {
+        swPagePool *task_shm = (swPagePool *) serv->task_shm->object;
+        add_assoc_long_ex(return_value, ZEND_STRL("task_shm_size"), (long) task_shm->page_num * task_shm->page_size);
+        add_assoc_long_ex(return_value, ZEND_STRL("task_shm_used"), (long) task_shm->page_use * task_shm->page_size);
+    }
+    if (serv->standby_worker_num > 0)
+    {
+        add_assoc_long_ex(return_value, ZEND_STRL("standby_worker_num"), serv->stats->standby_worker_num);
+        add_assoc_long_ex(return_value, ZEND_STRL("standby_activate_count"), serv->stats->standby_activate_count);
+    }
+    add_assoc_long_ex(return_value, ZEND_STRL("reload_count"), serv->stats->reload_count);
+    add_assoc_long_ex(return_value, ZEND_STRL("reloading"), serv->stats->reloading);
+    if (serv->stats->reloading)
+    {
+        add_assoc_long_ex(return_value, ZEND_STRL("reload_worker_num"), serv->stats->reload_worker_num);
+        add_assoc_long_ex(return_value, ZEND_STRL("reload_ready_num"), serv->stats->reload_ready_num);
+    }
+    if (serv->dispatch_mode == SW_DISPATCH_IPHASH || serv->dispatch_mode == SW_DISPATCH_UIDHASH)
+    {
+        add_assoc_long_ex(return_value, ZEND_STRL("dispatch_hash_num"), serv->gs->dispatch_hash_num);
+    }
+    if (serv->dispatch_mode == SW_DISPATCH_LEAST_LOAD)
+    {
+        zval zinflight, zservice_time;
+        array_init(&zinflight);
+        array_init(&zservice_time);
+        for (i = 0; i < serv->worker_num; i++)
+        {
+            swWorker *worker = swServer_get_worker(serv, i);
+            add_next_index_long(&zinflight, SW_MAX(worker->inflight, 0));
+            add_next_index_long(&zservice_time, worker->service_time);
+        }
+        add_assoc_zval_ex(return_value, ZEND_STRL("worker_inflight"), &zinflight);
+        add_assoc_zval_ex(return_value, ZEND_STRL("worker_service_time"), &zservice_time);
+    }
+
+    if (serv->factory_mode == SW_MODE_PROCESS)
+    {
+        zval zconnection_num, zevent_count, zevent_rate, zslab_hit_rate, zslab_retained, zpause_count, zpause_time;
+        uint64_t slab_alloc = 0, slab_hit = 0;
+        array_init(&zconnection_num);
+        array_init(&zevent_count);
+        array_init(&zevent_rate);
+        array_init(&zslab_hit_rate);
+        array_init(&zslab_retained);
+        array_init(&zpause_count);
+        array_init(&zpause_time);
+        for (i = 0; i < serv->reactor_num; i++)
+        {
+            swReactorThread *thread = swServer_get_thread(serv, i);
+            add_next_index_long(&zconnection_num, SW_MAX(thread->connection_num, 0));
+            add_next_index_long(&zevent_count, thread->event_count);
+            add_next_index_long(&zevent_rate, thread->event_rate);
+            add_next_index_double(&zslab_hit_rate, thread->buffer_slab.alloc_count ?
+                    (double) thread->buffer_slab.hit_count / thread->buffer_slab.alloc_count : 0);
+            add_next_index_long(&zslab_retained, thread->buffer_slab.retained_bytes);
+            slab_alloc += thread->buffer_slab.alloc_count;
+            slab_hit += thread->buffer_slab.hit_count;
+            add_next_index_long(&zpause_count, thread->ipc_pause_count);
+            add_next_index_long(&zpause_time, thread->ipc_pause_time);
+        }
+        add_assoc_zval_ex(return_value, ZEND_STRL("reactor_connection_num"), &zconnection_num);
+        add_assoc_zval_ex(return_value, ZEND_STRL("reactor_event_count"), &zevent_count);
+        add_assoc_zval_ex(return_value, ZEND_STRL("reactor_event_rate"), &zevent_rate);
+        add_assoc_zval_ex(return_value, ZEND_STRL("buffer_slab_hit_rate"), &zslab_hit_rate);
+        add_assoc_zval_ex(return_value, ZEND_STRL("buffer_slab_retained_bytes"), &zslab_retained);
+        add_assoc_long_ex(return_value, ZEND_STRL("buffer_slab_alloc_count"), slab_alloc);
+        add_assoc_long_ex(return_value, ZEND_STRL("buffer_slab_hit_count"), slab_hit);
+        add_assoc_zval_ex(return_value, ZEND_STRL("reactor_ipc_pause_count"), &zpause_count);
+        add_assoc_zval_ex(return_value, ZEND_STRL("reactor_ipc_pause_time"), &zpause_time);
+    }
+#ifdef SW_USE_OPENSSL
+    if (serv->ssl_handshake_threads)
+    {
+        zval zhandshake_count;
+        array_init(&zhandshake_count);
+        for (i = 0; i < serv->ssl_handshake_thread_num; i++)
+        {
+            add_next_index_long(&zhandshake_count, serv->ssl_handshake_threads[i].handshake_count);
+        }
+        add_assoc_zval_ex(return_value, ZEND_STRL("ssl_handshake_thread_count"), &zhandshake_count);
+    }
+#endif
+
     if (serv->task_ipc_mode > SW_TASK_IPC_UNIXSOCK && serv->gs->task_workers.queue)
     {
         int queue_num = -1;
@@ -3248,6 +3488,10 @@ static PHP_METHOD(swoole_server, stats)
             add_assoc_long_ex(return_value, ZEND_STRL("task_queue_bytes"), queue_bytes);
         }
     }
+    else if (serv->task_ipc_mode == SW_TASK_IPC_SHM_QUEUE && serv->gs->task_workers.shm_queue)
+    {
+        add_assoc_long_ex(return_value, ZEND_STRL("task_queue_num"), swShmQueue_count(serv->gs->task_workers.shm_queue));
+    }
 
 #ifdef SW_COROUTINE
     add_assoc_long_ex(return_value, ZEND_STRL("coroutine_num"), Coroutine::count());
@@ -3279,6 +3523,26 @@ static PHP_METHOD(swoole_server, reload)
     RETURN_TRUE;
 }
 
+/**
+ * [reload_batch_num] the worker is warmed up, the rolling reload does not wait for its first request
+ */
+static PHP_METHOD(swoole_server, ready)
+{
+    swServer *serv = (swServer *) swoole_get_object(getThis());
+    if (unlikely(!serv->gs->start))
+    {
+        swoole_php_fatal_error(E_WARNING, "server is not running.");
+        RETURN_FALSE;
+    }
+    if (!swIsWorker())
+    {
+        swoole_php_fatal_error(E_WARNING, "ready method can only be used in the worker process.");
+        RETURN_FALSE;
+    }
+    swWorker_ready(serv);
+    RETURN_TRUE;
+}
+
 static PHP_METHOD(swoole_server, heartbeat)
 {
     zend_bool close_connection = 0;
@@ -3375,8 +3639,8 @@ static PHP_METHOD(swoole_server, taskwait)
     int task_id = buf.info.fd;
 
     uint64_t notify;
-    swEventData *task_result = &(serv->task_result[SwooleWG.id]);
-    bzero(task_result, sizeof(swEventData));
+    swEventData task_result;
+    swTaskWorker_reset_result(serv, SwooleWG.id);
     swPipe *task_notify_pipe = &serv->task_notify[SwooleWG.id];
     int efd = task_notify_pipe->getFd(task_notify_pipe, 0);
 
@@ -3392,11 +3656,14 @@ static PHP_METHOD(swoole_server, taskwait)
         {
             if (task_notify_pipe->read(task_notify_pipe, &notify, sizeof(notify)) > 0)
             {
-                if (task_result->info.fd != task_id)
+                swTaskWorker_take_result(serv, &task_result);
+                if (task_result.info.type != SW_EVENT_FINISH || task_result.info.fd != task_id)
                 {
+                    //the result of a taskwait which timed out
+                    swTaskWorker_large_free(&task_result);
                     continue;
                 }
-                zval *task_notify_data = php_swoole_task_unpack(task_result);
+                zval *task_notify_data = php_swoole_task_unpack(&task_result);
                 if (task_notify_data == NULL)
                 {
                     RETURN_FALSE;
@@ -3463,8 +3730,8 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
     int list_of_id[SW_MAX_CONCURRENT_TASK] = {0};
 
     uint64_t notify;
+    swTaskWorker_reset_result(serv, SwooleWG.id);
     swEventData *task_result = &(serv->task_result[SwooleWG.id]);
-    bzero(task_result, sizeof(swEventData));
     swPipe *task_notify_pipe = &serv->task_notify[SwooleWG.id];
     swWorker *worker = swServer_get_worker(serv, SwooleWG.id);
 
@@ -3535,6 +3802,8 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
 
     worker->lock.lock(&worker->lock);
     swString *content = swoole_file_get_contents(_tmpfile);
+    //a late result cannot be appended to the file once it is read
+    unlink(_tmpfile);
     worker->lock.unlock(&worker->lock);
 
     if (content == NULL)
@@ -3569,8 +3838,6 @@ static PHP_METHOD(swoole_server, taskWaitMulti)
     } while (content->offset < 0 || (size_t) content->offset < content->length);
     //free memory
     swString_free(content);
-    //delete tmp file
-    unlink(_tmpfile);
 }
 
 #ifdef SW_COROUTINE
@@ -3928,7 +4195,7 @@ static PHP_METHOD(swoole_server, connection_info)
     {
         array_init(return_value);
 
-        if (conn->uid > 0 || serv->dispatch_mode == SW_DISPATCH_UIDMOD)
+        if (conn->uid > 0 || serv->dispatch_mode == SW_DISPATCH_UIDMOD || serv->dispatch_mode == SW_DISPATCH_UIDHASH)
         {
             add_assoc_long(return_value, "uid", conn->uid);
         }
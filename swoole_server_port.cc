@@ -187,6 +187,18 @@ static PHP_METHOD(swoole_server_port, set)
     {
         port->open_tcp_nodelay = 1;
     }
+    //server: tcp_zerocopy
+    if (php_swoole_array_get_value(vht, "open_tcp_zerocopy", v))
+    {
+        port->open_tcp_zerocopy = zval_is_true(v);
+    }
+#ifdef HAVE_RECVMMSG
+    //udp generic receive offload
+    if (php_swoole_array_get_value(vht, "open_udp_gro", v))
+    {
+        port->open_udp_gro = zval_is_true(v);
+    }
+#endif
     //tcp_defer_accept
     if (php_swoole_array_get_value(vht, "tcp_defer_accept", v))
     {
@@ -419,6 +431,11 @@ static PHP_METHOD(swoole_server_port, set)
         {
             port->ssl_option.allow_self_signed = zval_is_true(v);
         }
+        //install the session keys into kernel TLS after the handshake
+        if (php_swoole_array_get_value(vht, "ssl_ktls", v))
+        {
+            port->ssl_option.ktls = zval_is_true(v);
+        }
         //verify client cert
         if (php_swoole_array_get_value(vht, "ssl_client_cert_file", v))
         {
@@ -442,10 +459,25 @@ static PHP_METHOD(swoole_server_port, set)
         {
             port->ssl_config.prefer_server_ciphers = zval_is_true(v);
         }
-        //    if ((v = zend_hash_str_find(vht, ZEND_STRL("ssl_session_tickets"))))
-        //    {
-        //        port->ssl_config.session_tickets = zval_is_true(v);
-        //    }
+        if (php_swoole_array_get_value(vht, "ssl_session_cache", v))
+        {
+            zend_long size = zval_get_long(v);
+            port->ssl_config.session_cache_size = size > 0 ? size : 0;
+        }
+        if (php_swoole_array_get_value(vht, "ssl_session_timeout", v))
+        {
+            zend_long timeout = zval_get_long(v);
+            port->ssl_config.session_timeout = timeout > 0 ? timeout : SW_SSL_SESSION_TIMEOUT;
+        }
+        if (php_swoole_array_get_value(vht, "ssl_session_tickets", v))
+        {
+            port->ssl_config.session_tickets = zval_is_true(v);
+        }
+        if (php_swoole_array_get_value(vht, "ssl_ticket_key_rotate", v))
+        {
+            zend_long rotate = zval_get_long(v);
+            port->ssl_config.ticket_key_rotate = rotate > 0 ? rotate : SW_SSL_TICKET_KEY_ROTATE;
+        }
         //    if ((v = zend_hash_str_find(vht, ZEND_STRL("ssl_stapling"))))
         //    {
         //        port->ssl_config.stapling = zval_is_true(v);
@@ -100,6 +100,44 @@ function ms_random(float $a, float $b) : float
     return mt_rand($a * 1000, $b * 1000) / 1000;
 }
 
+/**
+ * (a * b + c) mod 2^64 with 16 bit limbs, a PHP integer overflows into float
+ */
+function uint64_mul_add(int $a, int $b, int $c): int
+{
+    $r = [0, 0, 0, 0];
+    for ($i = 0; $i < 4; $i++) {
+        $ai = ($a >> (16 * $i)) & 0xffff;
+        for ($k = 0; $i + $k < 4; $k++) {
+            $r[$i + $k] += $ai * (($b >> (16 * $k)) & 0xffff);
+        }
+    }
+    $r[0] += $c;
+    $carry = 0;
+    $result = 0;
+    for ($i = 0; $i < 4; $i++) {
+        $v = $r[$i] + $carry;
+        $result |= ($v & 0xffff) << (16 * $i);
+        $carry = $v >> 16;
+    }
+    return $result;
+}
+
+/**
+ * the same as swoole_jump_hash() in include/hash.h, the worker of dispatch_mode 9 and 10
+ */
+function jump_hash(int $key, int $num_buckets): int
+{
+    $b = -1;
+    $j = 0;
+    while ($j < $num_buckets) {
+        $b = $j;
+        $key = uint64_mul_add($key, 2862933555777941757, 1);
+        $j = (int)(($b + 1) * ((float)(1 << 31) / (float)((($key >> 33) & 0x7fffffff) + 1)));
+    }
+    return $b;
+}
+
 function string_pop_front(string &$s, int $length): string
 {
     $r = substr($s, 0, $length);
@@ -0,0 +1,69 @@
+--TEST--
+swoole_server: recycle the output buffer chunks through the reactor thread slabs
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+const RESPONSE_SIZE = 8 * 1024 * 1024;
+const ROUND_N = 3;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($pm)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_eof_check' => true, 'package_eof' => "\r\n\r\n"]);
+    $cli->connect('127.0.0.1', $pm->getFreePort(), 1) or die("ERROR");
+    //larger than the socket buffer, the rest is queued in the output buffer of the reactor thread
+    for ($i = 0; $i < ROUND_N; $i++)
+    {
+        $cli->send("big\r\n\r\n") or die("ERROR");
+        assert(strlen($cli->recv()) == RESPONSE_SIZE + 4);
+    }
+    $cli->send("stats\r\n\r\n") or die("ERROR");
+    $stats = json_decode(trim($cli->recv()), true);
+    assert(count($stats['buffer_slab_hit_rate']) == 2);
+    assert(count($stats['buffer_slab_retained_bytes']) == 2);
+    assert($stats['buffer_slab_alloc_count'] > 0);
+    //the chunks of the first round are reused
+    assert($stats['buffer_slab_hit_count'] > 0);
+    assert($stats['buffer_slab_hit_count'] <= $stats['buffer_slab_alloc_count']);
+    echo "DONE\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'reactor_num' => 2,
+        'worker_num' => 1,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n\r\n",
+        'buffer_output_size' => 2 * RESPONSE_SIZE,
+        'socket_buffer_size' => 4 * RESPONSE_SIZE,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        if (trim($data) == 'stats')
+        {
+            $serv->send($fd, json_encode($serv->stats()) . "\r\n\r\n");
+        }
+        else
+        {
+            $serv->send($fd, str_repeat('A', RESPONSE_SIZE) . "\r\n\r\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,76 @@
+--TEST--
+swoole_server: dispatch_mode = 10
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+const REQ_N = 4;
+const WORKER_N = 8;
+const UID_LIST = [1, 2, 3, 100, 1001, 65536, 1234567, 4294967295];
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($pm)
+{
+    $workers = [];
+    foreach (UID_LIST as $uid)
+    {
+        $expect = jump_hash($uid, WORKER_N);
+        //two connections of the same uid go to the same worker
+        for ($c = 0; $c < 2; $c++)
+        {
+            $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+            $cli->set(['package_eof' => "\r\n\r\n", 'open_eof_check' => true]);
+            $cli->connect('127.0.0.1', $pm->getFreePort(), 1) or die("ERROR");
+            $cli->send("bind {$uid}\r\n\r\n") or die("ERROR");
+            assert(trim($cli->recv()) === 'bound');
+            for ($n = 0; $n < REQ_N; $n++)
+            {
+                $cli->send("hello\r\n\r\n") or die("ERROR");
+                assert(intval(trim($cli->recv())) === $expect);
+            }
+            $cli->close();
+        }
+        $workers[$expect] = true;
+    }
+    assert(count($workers) > 1);
+    echo "DONE\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => WORKER_N,
+        'dispatch_mode' => 10,
+        'package_eof' => "\r\n\r\n",
+        'open_eof_split' => true,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (\swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $data = trim($data);
+        //the first package is dispatched by fd, the following ones by uid
+        if (substr($data, 0, 5) === 'bind ')
+        {
+            $serv->bind($fd, intval(substr($data, 5)));
+            $serv->send($fd, "bound\r\n\r\n");
+        }
+        else
+        {
+            $serv->send($fd, $serv->worker_id . "\r\n\r\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
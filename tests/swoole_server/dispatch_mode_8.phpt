@@ -0,0 +1,69 @@
+--TEST--
+swoole_server: dispatch_mode = 8 [least load]
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $counter = [0, 0, 0, 0];
+    for ($i = 0; $i < 4; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        assert($cli->connect('127.0.0.1', $port, 1));
+        for ($j = 0; $j < 50; $j++)
+        {
+            $cli->send("hello\r\n");
+            $counter[intval($cli->recv())]++;
+        }
+        $cli->send("stats\r\n");
+        $stats = json_decode($cli->recv(), true);
+        assert(count($stats['worker_inflight']) === 4);
+        assert(count($stats['worker_service_time']) === 4);
+        $cli->close();
+    }
+    //worker#0 is slow, most requests go to the other workers
+    assert($counter[0] < 40);
+    echo "DONE\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 4,
+        'dispatch_mode' => 8,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        if (trim($data) == 'stats')
+        {
+            $serv->send($fd, json_encode($serv->stats()));
+            return;
+        }
+        if ($serv->worker_id == 0)
+        {
+            usleep(20000);
+        }
+        $serv->send($fd, $serv->worker_id);
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,74 @@
+--TEST--
+swoole_server: dispatch_mode = 9
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+const CLIENT_N = 16;
+const REQ_N = 4;
+const WORKER_N = 8;
+const HASH_N = 6;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($pm)
+{
+    $workers = [];
+    for ($i = 1; $i <= CLIENT_N; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        $cli->set([
+            'package_eof' => "\r\n\r\n",
+            'open_eof_check' => true,
+            'bind_address' => "127.0.0.{$i}",
+        ]);
+        $cli->connect('127.0.0.1', $pm->getFreePort(), 1) or die("ERROR");
+        //the key is sin_addr.s_addr
+        $expect = jump_hash(127 | ($i << 24), HASH_N);
+        for ($n = 0; $n < REQ_N; $n++)
+        {
+            $cli->send("hello\r\n\r\n") or die("ERROR");
+            $res = json_decode(trim($cli->recv()), true);
+            assert($res['worker_id'] === $expect);
+            assert($res['dispatch_hash_num'] === HASH_N);
+        }
+        $workers[$expect] = true;
+        $cli->close();
+    }
+    //only the first dispatch_hash_num workers are used
+    assert(count($workers) > 1);
+    assert(max(array_keys($workers)) < HASH_N);
+    echo "DONE\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => WORKER_N,
+        'dispatch_mode' => 9,
+        'dispatch_hash_num' => HASH_N,
+        'package_eof' => "\r\n\r\n",
+        'open_eof_split' => true,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (\swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->send($fd, json_encode([
+            'worker_id' => $serv->worker_id,
+            'dispatch_hash_num' => $serv->stats()['dispatch_hash_num'],
+        ]) . "\r\n\r\n");
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
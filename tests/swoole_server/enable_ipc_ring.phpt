@@ -0,0 +1,61 @@
+--TEST--
+swoole_server: enable_ipc_ring
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set([
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+    ]);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    foreach ([0, 16, 8192, 65536, 1024 * 1024 + 7] as $size)
+    {
+        $data = random_bytes($size);
+        $cli->send(pack('N', $size) . $data);
+        $resp = $cli->recv();
+        assert(substr($resp, 4) === md5($data));
+    }
+    echo "DONE\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 2,
+        'enable_ipc_ring' => true,
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->send($fd, pack('N', 32) . md5(substr($data, 4)));
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
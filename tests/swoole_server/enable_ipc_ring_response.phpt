@@ -0,0 +1,66 @@
+--TEST--
+swoole_server: enable_ipc_ring with large responses
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set([
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+    ]);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    $sizes = [0, 16, 65536, 300000, 2 * 1024 * 1024 + 3, 100];
+    foreach ($sizes as $size)
+    {
+        $cli->send(pack('N', 4) . pack('N', $size));
+    }
+    foreach ($sizes as $size)
+    {
+        $resp = $cli->recv();
+        assert(strlen($resp) === $size + 4);
+        assert(substr($resp, 4) === str_repeat(chr($size % 256), $size));
+    }
+    echo "DONE\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 1,
+        'ipc_ring_size' => 65536,
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $size = unpack('N', substr($data, 4))[1];
+        $serv->send($fd, pack('N', $size) . str_repeat(chr($size % 256), $size));
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
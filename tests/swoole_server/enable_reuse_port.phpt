@@ -0,0 +1,58 @@
+--TEST--
+swoole_server: enable_reuse_port in process mode
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    //connections are spread over the listening socket of each reactor thread
+    $clients = [];
+    for ($i = 0; $i < 32; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        assert($cli->connect('127.0.0.1', $port, 1));
+        $clients[] = $cli;
+    }
+    foreach ($clients as $i => $cli)
+    {
+        $cli->send("hello $i");
+    }
+    foreach ($clients as $i => $cli)
+    {
+        assert($cli->recv() === "Swoole: hello $i");
+        $cli->close();
+    }
+    echo "DONE\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'reactor_num' => 4,
+        'worker_num' => 2,
+        'enable_reuse_port' => true,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->send($fd, "Swoole: $data");
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,85 @@
+--TEST--
+swoole_server: the pid_file belongs to the new master after the hand over
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+$handoff_socket = '/tmp/swoole_handoff_' . $pm->getFreePort() . '.sock';
+$pid_file = '/tmp/swoole_handoff_' . $pm->getFreePort() . '.pid';
+
+function start_server(ProcessManager $pm, string $handoff_socket, string $pid_file, string $name)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'handoff_socket' => $handoff_socket,
+        'pid_file' => $pid_file,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) use ($name) {
+        $serv->send($fd, "$name\r\n");
+    });
+    $serv->start();
+}
+
+function request(swoole_client $client)
+{
+    $client->send("hello\r\n");
+    return trim($client->recv());
+}
+
+$pm->parentFunc = function ($pid) use ($pm, $handoff_socket, $pid_file) {
+    assert(file_get_contents($pid_file) == $pid);
+
+    $new_master = new swoole_process(function () use ($pm, $handoff_socket, $pid_file) {
+        putenv("SWOOLE_HANDOFF_SOCKET=$handoff_socket");
+        start_server($pm, $handoff_socket, $pid_file, 'new');
+    }, false, false);
+    $new_master->start();
+
+    for ($i = 0; $i < 100; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        $client->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+        assert($client->connect('127.0.0.1', $pm->getFreePort()));
+        $name = request($client);
+        $client->close();
+        if ($name == 'new')
+        {
+            break;
+        }
+        usleep(50 * 1000);
+    }
+    assert($name == 'new');
+
+    //the previous master exits without any connection to drain
+    for ($i = 0; $i < 100 and !($status = swoole_process::wait(false)); $i++)
+    {
+        usleep(50 * 1000);
+    }
+    assert($status['pid'] == $pid);
+    assert(file_get_contents($pid_file) == $new_master->pid);
+
+    swoole_process::kill($new_master->pid, SIGTERM);
+    swoole_process::wait();
+    assert(!file_exists($pid_file));
+    echo "SUCCESS\n";
+};
+
+$pm->childFunc = function () use ($pm, $handoff_socket, $pid_file) {
+    start_server($pm, $handoff_socket, $pid_file, 'old');
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
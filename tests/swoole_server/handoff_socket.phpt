@@ -0,0 +1,82 @@
+--TEST--
+swoole_server: hand over the listening sockets to a new master
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+$handoff_socket = '/tmp/swoole_handoff_' . $pm->getFreePort() . '.sock';
+
+function start_server(ProcessManager $pm, string $handoff_socket, string $name)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 1,
+        'handoff_socket' => $handoff_socket,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) use ($name) {
+        $serv->send($fd, "$name\r\n");
+    });
+    $serv->start();
+}
+
+function request(swoole_client $client)
+{
+    $client->send("hello\r\n");
+    return trim($client->recv());
+}
+
+$pm->parentFunc = function ($pid) use ($pm, $handoff_socket) {
+    $old = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $old->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+    assert($old->connect('127.0.0.1', $pm->getFreePort()));
+    assert(request($old) == 'old');
+
+    $new_master = new swoole_process(function () use ($pm, $handoff_socket) {
+        putenv("SWOOLE_HANDOFF_SOCKET=$handoff_socket");
+        start_server($pm, $handoff_socket, 'new');
+    }, false, false);
+    $new_master->start();
+
+    //no connection is refused while the masters change
+    for ($i = 0; $i < 100; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        $client->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+        assert($client->connect('127.0.0.1', $pm->getFreePort()));
+        $name = request($client);
+        $client->close();
+        if ($name == 'new')
+        {
+            break;
+        }
+        usleep(50 * 1000);
+    }
+    assert($name == 'new');
+    //the previous master serves its connections until they are closed
+    assert(request($old) == 'old');
+    $old->close();
+
+    swoole_process::kill($new_master->pid, SIGTERM);
+    swoole_process::wait();
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm, $handoff_socket) {
+    start_server($pm, $handoff_socket, 'old');
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
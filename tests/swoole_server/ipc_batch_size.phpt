@@ -0,0 +1,68 @@
+--TEST--
+swoole_server: ipc_batch_size
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set([
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+    ]);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    //pipelined requests are coalesced into a few pipe messages
+    $list = [];
+    $buffer = '';
+    for ($i = 0; $i < 1000; $i++)
+    {
+        $data = random_bytes(mt_rand(0, 1) ? mt_rand(1, 64) : mt_rand(8000, 100000));
+        $list[] = md5($data);
+        $buffer .= pack('N', strlen($data)) . $data;
+    }
+    $cli->send($buffer);
+    foreach ($list as $hash)
+    {
+        assert(substr($cli->recv(), 4) === $hash);
+    }
+    echo "DONE\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 2,
+        'ipc_batch_size' => true,
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_length_offset' => 0,
+        'package_body_offset' => 4,
+        'package_max_length' => 4 * 1024 * 1024,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->send($fd, pack('N', 32) . md5(substr($data, 4)));
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+DONE
@@ -0,0 +1,71 @@
+--TEST--
+swoole_server: ipc_high_watermark
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+const N = 200;
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_length_check' => true, 'package_length_type' => 'N', 'package_body_offset' => 4]);
+    assert($cli->connect('127.0.0.1', $port, 5));
+    $data = str_repeat('A', 65536);
+    //the worker is slower than the client, the reactor stops reading until it catches up
+    for ($i = 0; $i < N; $i++)
+    {
+        assert($cli->send(pack('N', strlen($data)) . $data));
+    }
+    for ($i = 0; $i < N; $i++)
+    {
+        assert($cli->recv() === pack('N', 2) . 'OK');
+    }
+    $cli->send(pack('N', 5) . 'stats');
+    $stats = json_decode(substr($cli->recv(), 4), true);
+    assert(array_sum($stats['reactor_ipc_pause_count']) > 0);
+    assert(array_sum($stats['reactor_ipc_pause_time']) > 0);
+    echo "SUCCESS\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 1,
+        'ipc_high_watermark' => 1024 * 1024,
+        'ipc_low_watermark' => 256 * 1024,
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_body_offset' => 4,
+        'package_max_length' => 1024 * 1024,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        if (substr($data, 4) === 'stats')
+        {
+            $stats = json_encode($serv->stats());
+            $serv->send($fd, pack('N', strlen($stats)) . $stats);
+            return;
+        }
+        usleep(5000);
+        $serv->send($fd, pack('N', 2) . 'OK');
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,81 @@
+--TEST--
+swoole_server: pipelined packages of length_check and eof_split
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $sizes = [1, 100, 3000, 9000, 40000, 7, 70000, 5];
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_length_check' => true, 'package_length_type' => 'N', 'package_body_offset' => 4]);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    $data = '';
+    foreach ($sizes as $i => $size)
+    {
+        $data .= pack('N', $size) . str_repeat(chr(65 + $i), $size);
+    }
+    //all packages in one write, the last one in two
+    $cli->send(substr($data, 0, -3));
+    usleep(50000);
+    $cli->send(substr($data, -3));
+    foreach ($sizes as $i => $size)
+    {
+        $pkg = $cli->recv();
+        assert(substr($pkg, 4) === str_repeat(chr(65 + $i), $size));
+    }
+
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_eof_split' => true, 'package_eof' => "\r\n"]);
+    assert($cli->connect('127.0.0.1', $port + 1, 1));
+    $data = '';
+    foreach ($sizes as $i => $size)
+    {
+        $data .= str_repeat(chr(65 + $i), $size) . "\r\n";
+    }
+    $cli->send($data);
+    foreach ($sizes as $i => $size)
+    {
+        assert($cli->recv() === str_repeat(chr(65 + $i), $size) . "\r\n");
+    }
+    echo "SUCCESS\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 1,
+        'open_length_check' => true,
+        'package_length_type' => 'N',
+        'package_body_offset' => 4,
+        'package_max_length' => 1024 * 1024,
+        'log_file' => '/dev/null',
+    ]);
+    $port2 = $serv->listen('127.0.0.1', $port + 1, SWOOLE_SOCK_TCP);
+    $port2->set([
+        'open_length_check' => false,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->send($fd, $data);
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
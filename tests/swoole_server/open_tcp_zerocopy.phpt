@@ -0,0 +1,51 @@
+--TEST--
+swoole_server: open_tcp_zerocopy
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_length_check' => true, 'package_length_type' => 'N', 'package_body_offset' => 4]);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    foreach ([100, 20000, 1024 * 1024, 4 * 1024 * 1024, 300] as $size)
+    {
+        $cli->send(pack('N', $size));
+        $data = $cli->recv();
+        assert(strlen($data) == $size + 4);
+        assert(substr($data, 4) === str_repeat(chr($size % 256), $size));
+    }
+    echo "SUCCESS\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 1,
+        'open_tcp_zerocopy' => true,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $size = unpack('N', $data)[1];
+        $serv->send($fd, pack('N', $size) . str_repeat(chr($size % 256), $size));
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
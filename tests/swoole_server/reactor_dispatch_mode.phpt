@@ -0,0 +1,77 @@
+--TEST--
+swoole_server: reactor_dispatch_mode least connections
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $clients = [];
+    for ($i = 0; $i < 6; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        assert($cli->connect('127.0.0.1', $port, 1));
+        $clients[] = $cli;
+    }
+    //the connections of reactor thread 0 are closed, new ones go to it
+    foreach ($clients as $i => $cli)
+    {
+        $cli->send("id");
+        if ($cli->recv() == 0)
+        {
+            $cli->close();
+            unset($clients[$i]);
+        }
+    }
+    usleep(100000);
+    for ($i = 0; $i < 3; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        assert($cli->connect('127.0.0.1', $port, 1));
+        $cli->send("id");
+        assert($cli->recv() == 0);
+        $clients[] = $cli;
+    }
+    $cli->send("stats");
+    $stats = json_decode($cli->recv(), true);
+    echo json_encode($stats['reactor_connection_num']), "\n";
+    assert(array_sum($stats['reactor_event_count']) >= 10);
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'reactor_num' => 2,
+        'worker_num' => 1,
+        'reactor_dispatch_mode' => 2,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        if ($data == 'stats')
+        {
+            $serv->send($fd, json_encode($serv->stats()));
+        }
+        else
+        {
+            $serv->send($fd, $rid);
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+[3,3]
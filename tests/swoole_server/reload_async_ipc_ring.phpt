@@ -0,0 +1,81 @@
+--TEST--
+swoole_server: reload_async with responses in flight through the ipc rings
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const N = 8;
+const SIZE = 100000;
+
+$pm = new ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    $clients = [];
+    for ($i = 0; $i < N; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        $client->set(["open_eof_check" => true, "package_eof" => "\r\n", 'package_max_length' => 1024 * 1024]);
+        if (!$client->connect('127.0.0.1', $pm->getFreePort(), 5))
+        {
+            exit("connect failed\n");
+        }
+        $client->send("req-{$i}-0\r\n");
+        $clients[] = $client;
+    }
+    //the old workers are still sleeping on the first requests
+    $ctl = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $ctl->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+    assert($ctl->connect('127.0.0.1', $pm->getFreePort(), 5));
+    $ctl->send("reload\r\n");
+    assert(trim($ctl->recv()) == "OK");
+    foreach ($clients as $i => $client)
+    {
+        $client->send("req-{$i}-1\r\n");
+    }
+    foreach ($clients as $i => $client)
+    {
+        for ($j = 0; $j < 2; $j++)
+        {
+            $resp = $client->recv();
+            assert($resp === "req-{$i}-{$j} " . str_repeat('.', SIZE) . "\r\n");
+        }
+    }
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 2,
+        'reload_async' => true,
+        'max_wait_time' => 5,
+        'ipc_ring_size' => 65536,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        $data = trim($data);
+        if ($data == 'reload')
+        {
+            $serv->send($fd, "OK\r\n");
+            $serv->reload();
+            return;
+        }
+        co::sleep(0.3);
+        $serv->send($fd, "{$data} " . str_repeat('.', SIZE) . "\r\n");
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,75 @@
+--TEST--
+swoole_server: rolling reload of warmed up workers which never serve a request
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+
+function get_stats(swoole_client $client)
+{
+    $client->send("stats\r\n");
+    return json_decode(trim($client->recv()), true);
+}
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $client->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+    if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+    {
+        exit("connect failed\n");
+    }
+    $client->send("reload\r\n");
+    assert(trim($client->recv()) == "OK");
+    for ($i = 0; $i < 100; $i++)
+    {
+        $stats = get_stats($client);
+        if (!$stats['reloading'])
+        {
+            break;
+        }
+        usleep(50 * 1000);
+    }
+    //the replacements without a connection are ready without a request
+    assert($stats['reloading'] == 0);
+    assert($stats['reload_count'] == 1);
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 4,
+        'reload_batch_num' => 1,
+        //wait for the request or Server::ready()
+        'reload_ready_timeout' => 0,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm) {
+        assert($serv->ready());
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        if (trim($data) == 'reload')
+        {
+            $serv->send($fd, "OK\r\n");
+            $serv->reload();
+        }
+        else
+        {
+            $serv->send($fd, json_encode($serv->stats()) . "\r\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,67 @@
+--TEST--
+swoole_server: sendfile with SSL and kernel TLS
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    $client = new swoole_client(SWOOLE_SOCK_TCP | SWOOLE_SSL, SWOOLE_SOCK_SYNC);
+    $client->set(['ssl_ktls' => true]);
+    if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+    {
+        exit("connect failed\n");
+    }
+    $client->send("hello world");
+    assert($client->recv() == "Swoole hello world");
+
+    //without the kernel module the records are still encrypted by OpenSSL
+    $client->send("sendfile");
+    $N = filesize(TEST_IMAGE);
+    $data = '';
+    while (strlen($data) < $N)
+    {
+        $r = $client->recv(65536);
+        if (!$r)
+        {
+            break;
+        }
+        $data .= $r;
+    }
+    assert(md5_file(TEST_IMAGE) == md5($data));
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS, SWOOLE_SOCK_TCP | SWOOLE_SSL);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'ssl_ktls' => true,
+        'ssl_cert_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.crt',
+        'ssl_key_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.key',
+    ]);
+    $serv->on("workerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        if ($data == 'sendfile')
+        {
+            $serv->sendfile($fd, TEST_IMAGE);
+        }
+        else
+        {
+            $serv->send($fd, "Swoole $data");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,69 @@
+--TEST--
+swoole_server: session id of a reused slot gets a new generation
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $last = 0;
+    $first = 0;
+    //the session table of max_connection=100 has 1024 slots
+    for ($i = 0; $i < 1500; $i++)
+    {
+        $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        assert($cli->connect('127.0.0.1', $port, 1));
+        $cli->send("hello");
+        $fd = (int) $cli->recv();
+        assert($fd > $last);
+        $last = $fd;
+        if ($i == 0)
+        {
+            $first = $fd;
+        }
+        $cli->close();
+    }
+    assert($last > 1024);
+    //the slot of the first session is used again, the old id is not valid
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    $cli->send("exist $first");
+    echo $cli->recv(), "\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS);
+    $serv->set([
+        'worker_num' => 1,
+        'max_connection' => 100,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        if (substr($data, 0, 6) == 'exist ')
+        {
+            $serv->send($fd, $serv->exist((int) substr($data, 6)) ? 'yes' : 'no');
+        }
+        else
+        {
+            $serv->send($fd, $fd);
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+no
@@ -0,0 +1,67 @@
+--TEST--
+swoole_server: TLS handshakes in dedicated threads
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const N = 8;
+
+$pm = new ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    for ($i = 0; $i < N; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP | SWOOLE_SSL, SWOOLE_SOCK_SYNC);
+        if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+        {
+            exit("connect failed\n");
+        }
+        $client->send("hello world");
+        assert($client->recv() == "Swoole hello world");
+        $client->close();
+    }
+
+    $client = new swoole_client(SWOOLE_SOCK_TCP | SWOOLE_SSL, SWOOLE_SOCK_SYNC);
+    if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+    {
+        exit("connect failed\n");
+    }
+    $client->send("stats");
+    $counts = json_decode($client->recv(), true);
+    assert(count($counts) == 2);
+    assert(array_sum($counts) == N + 1);
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS, SWOOLE_SOCK_TCP | SWOOLE_SSL);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'ssl_handshake_threads' => 2,
+        'ssl_cert_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.crt',
+        'ssl_key_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.key',
+    ]);
+    $serv->on("workerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        if ($data == 'stats')
+        {
+            $serv->send($fd, json_encode($serv->stats()['ssl_handshake_thread_count']));
+        }
+        else
+        {
+            $serv->send($fd, "Swoole $data");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
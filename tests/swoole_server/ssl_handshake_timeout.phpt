@@ -0,0 +1,57 @@
+--TEST--
+swoole_server: a stalled TLS handshake in a handshake thread is closed by the heartbeat
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const CLIENT_HELLO = '160301008501000081030335ebd10210c508f16ab6c11548d8c40cb941cb342c6b44852e2d2adecfac8ee6000006c02f' .
+    '002f00ff01000052000b000403000102000a000c000a001d0017001e00190018002300000016000000170000000d002a0028040305030603' .
+    '080708080809080a080b080408050806040105010601030303010302040205020602';
+
+$pm = new ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    if (!$client->connect('127.0.0.1', $pm->getFreePort(), 10))
+    {
+        exit("connect failed\n");
+    }
+    //a complete ClientHello moves the connection to the handshake thread, the client never answers the server
+    $client->send(hex2bin(CLIENT_HELLO));
+    $start = microtime(true);
+    do
+    {
+        $data = $client->recv();
+    } while ($data !== '' && $data !== false);
+    assert($data === '');
+    $time = microtime(true) - $start;
+    assert($time >= 1 && $time < 5);
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS, SWOOLE_SOCK_TCP | SWOOLE_SSL);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'ssl_handshake_threads' => 1,
+        'heartbeat_check_interval' => 1,
+        'heartbeat_idle_time' => 2,
+        'ssl_cert_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.crt',
+        'ssl_key_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.key',
+    ]);
+    $serv->on("workerStart", function ($serv) use ($pm) {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,55 @@
+--TEST--
+swoole_server: shared SSL session cache and session tickets
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    for ($i = 0; $i < 8; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP | SWOOLE_SSL, SWOOLE_SOCK_SYNC);
+        if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+        {
+            exit("connect failed\n");
+        }
+        $client->send("hello world");
+        assert($client->recv() == "Swoole hello world");
+        $client->close();
+    }
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_BASE, SWOOLE_SOCK_TCP | SWOOLE_SSL);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 4,
+        'ssl_session_cache' => 1024,
+        'ssl_session_timeout' => 60,
+        'ssl_session_tickets' => true,
+        'ssl_ticket_key_rotate' => 1,
+        'ssl_cert_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.crt',
+        'ssl_key_file' => dirname(__DIR__) . '/include/api/swoole_http_server/localhost-ssl/server.key',
+    ]);
+    $serv->on("workerStart", function ($serv, $id) use ($pm) {
+        if ($id == 0)
+        {
+            $pm->wakeup();
+        }
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        $serv->send($fd, "Swoole $data");
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
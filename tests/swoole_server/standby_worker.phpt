@@ -0,0 +1,94 @@
+--TEST--
+swoole_server: reload with standby workers
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+$pm = new ProcessManager;
+$standby = new swoole_atomic(0);
+$activated = new swoole_atomic(0);
+
+function get_stats(swoole_client $client)
+{
+    $client->send("stats\r\n");
+    return json_decode(trim($client->recv()), true);
+}
+
+$pm->parentFunc = function ($pid) use ($pm, $standby, $activated) {
+    $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $client->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+    if (!$client->connect('127.0.0.1', $pm->getFreePort()))
+    {
+        exit("connect failed\n");
+    }
+    for ($i = 0; $i < 50 and get_stats($client)['standby_worker_num'] < 2; $i++)
+    {
+        usleep(100 * 1000);
+    }
+    $stats = get_stats($client);
+    assert($stats['standby_worker_num'] == 2);
+    assert($stats['standby_activate_count'] == 0);
+    //the standby workers have run onWorkerStart, but not their event loop
+    assert($standby->get() == 2);
+    assert($activated->get() == 0);
+
+    $client->send("reload\r\n");
+    assert(trim($client->recv()) == "OK");
+    for ($i = 0; $i < 50 and (get_stats($client)['standby_activate_count'] < 2 or $activated->get() < 2); $i++)
+    {
+        usleep(100 * 1000);
+    }
+    $stats = get_stats($client);
+    assert($stats['standby_activate_count'] == 2);
+    assert($activated->get() == 2);
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm, $standby, $activated) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 2,
+        'standby_worker_num' => 2,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm, $standby, $activated) {
+        //loading the application
+        usleep(200 * 1000);
+        if (!$serv->standby)
+        {
+            $pm->wakeup();
+            return;
+        }
+        $standby->add(1);
+        //the timer runs once the standby worker has taken over its slot
+        swoole_timer_after(1, function () use ($serv, $activated) {
+            if (!$serv->standby)
+            {
+                $activated->add(1);
+            }
+        });
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        if (trim($data) == 'reload')
+        {
+            $serv->send($fd, "OK\r\n");
+            $serv->reload();
+        }
+        else
+        {
+            $serv->send($fd, json_encode($serv->stats()) . "\r\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
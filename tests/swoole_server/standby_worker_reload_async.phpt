@@ -0,0 +1,108 @@
+--TEST--
+swoole_server: standby workers take over with reload_async while responses are in flight
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+
+const N = 8;
+const SIZE = 100000;
+
+$pm = new ProcessManager;
+
+function get_stats(swoole_client $client)
+{
+    $client->send("stats\r\n");
+    return json_decode(trim($client->recv()), true);
+}
+
+$pm->parentFunc = function ($pid) use ($pm) {
+    $ctl = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $ctl->set(["open_eof_check" => true, "package_eof" => "\r\n"]);
+    assert($ctl->connect('127.0.0.1', $pm->getFreePort(), 5));
+    for ($i = 0; $i < 50 and get_stats($ctl)['standby_worker_num'] < 2; $i++)
+    {
+        usleep(100 * 1000);
+    }
+    assert(get_stats($ctl)['standby_worker_num'] == 2);
+
+    $clients = [];
+    for ($i = 0; $i < N; $i++)
+    {
+        $client = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+        $client->set(["open_eof_check" => true, "package_eof" => "\r\n", 'package_max_length' => 1024 * 1024]);
+        if (!$client->connect('127.0.0.1', $pm->getFreePort(), 5))
+        {
+            exit("connect failed\n");
+        }
+        $client->send("req-{$i}-0\r\n");
+        $clients[] = $client;
+    }
+    //the old workers are still sleeping on the first requests when the standby workers take over
+    $ctl->send("reload\r\n");
+    assert(trim($ctl->recv()) == "OK");
+    foreach ($clients as $i => $client)
+    {
+        $client->send("req-{$i}-1\r\n");
+    }
+    foreach ($clients as $i => $client)
+    {
+        for ($j = 0; $j < 2; $j++)
+        {
+            $resp = $client->recv();
+            assert($resp === "req-{$i}-{$j} " . str_repeat('.', SIZE) . "\r\n");
+        }
+    }
+    for ($i = 0; $i < 50 and get_stats($ctl)['standby_activate_count'] < 2; $i++)
+    {
+        usleep(100 * 1000);
+    }
+    assert(get_stats($ctl)['standby_activate_count'] == 2);
+    echo "SUCCESS\n";
+    $pm->kill();
+};
+
+$pm->childFunc = function () use ($pm) {
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort(), SWOOLE_PROCESS);
+    $serv->set([
+        'log_file' => '/dev/null',
+        'worker_num' => 2,
+        'standby_worker_num' => 2,
+        'reload_async' => true,
+        'max_wait_time' => 5,
+        'ipc_ring_size' => 65536,
+        'open_eof_split' => true,
+        'package_eof' => "\r\n",
+    ]);
+    $serv->on("WorkerStart", function ($serv) use ($pm) {
+        if (!$serv->standby)
+        {
+            $pm->wakeup();
+        }
+    });
+    $serv->on('receive', function ($serv, $fd, $from_id, $data) {
+        $data = trim($data);
+        if ($data == 'reload')
+        {
+            $serv->send($fd, "OK\r\n");
+            $serv->reload();
+        }
+        elseif ($data == 'stats')
+        {
+            $serv->send($fd, json_encode($serv->stats()) . "\r\n");
+        }
+        else
+        {
+            co::sleep(0.3);
+            $serv->send($fd, "{$data} " . str_repeat('.', SIZE) . "\r\n");
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
@@ -0,0 +1,70 @@
+--TEST--
+swoole_server: large task data in the shared memory arena
+--SKIPIF--
+<?php require __DIR__ . '/../../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../../include/bootstrap.php';
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($pm)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_TCP, SWOOLE_SOCK_SYNC);
+    $cli->set(['open_eof_check' => true, "package_eof" => "\r\n\r\n"]);
+    $cli->connect('127.0.0.1', $pm->getFreePort(), 0.5) or die("ERROR");
+
+    //the last one is larger than the arena, so it is sent by tmpfile
+    foreach ([128 * 1024, 1024 * 1024, 3 * 1024 * 1024] as $size)
+    {
+        $cli->send("$size\r\n\r\n") or die("ERROR");
+        $res = json_decode(trim($cli->recv()), true);
+        assert($res['size'] == $size);
+        assert($res['md5'] == md5(str_repeat('A', $size)));
+        assert($res['task_shm_size'] == 2 * 1024 * 1024);
+    }
+    echo "SUCCESS\n";
+
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm)
+{
+    $serv = new swoole_server('127.0.0.1', $pm->getFreePort());
+    $serv->set(array(
+        "worker_num" => 1,
+        'task_worker_num' => 1,
+        'task_shm_size' => 2 * 1024 * 1024,
+        'open_eof_check' => true,
+        'package_eof' => "\r\n\r\n",
+        'log_file' => '/dev/null',
+    ));
+    $serv->on("WorkerStart", function (\swoole_server $serv)  use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('receive', function (swoole_server $serv, $fd, $rid, $data)
+    {
+        $serv->task(str_repeat('A', intval($data)), -1, function ($serv, $taskId, $data) use ($fd) {
+            $stats = $serv->stats();
+            $serv->send($fd, json_encode([
+                'size' => strlen($data),
+                'md5' => md5($data),
+                'task_shm_size' => $stats['task_shm_size'],
+            ]) . "\r\n\r\n");
+        });
+    });
+    $serv->on('task', function (swoole_server $serv, $task_id, $worker_id, $data)
+    {
+        return $data;
+    });
+    $serv->on('finish', function (swoole_server $serv, $fd, $rid, $data)
+    {
+
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS
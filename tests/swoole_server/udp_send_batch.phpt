@@ -0,0 +1,54 @@
+--TEST--
+swoole_server: udp_send_batch
+--SKIPIF--
+<?php require __DIR__ . '/../include/skipif.inc'; ?>
+--FILE--
+<?php
+require __DIR__ . '/../include/bootstrap.php';
+$port = get_one_free_port();
+
+$pm = new ProcessManager;
+$pm->parentFunc = function ($pid) use ($port)
+{
+    $cli = new swoole_client(SWOOLE_SOCK_UDP, SWOOLE_SOCK_SYNC);
+    assert($cli->connect('127.0.0.1', $port, 1));
+    $cli->send("8");
+    //the replies of one onPacket are sent with one sendmmsg
+    for ($i = 0; $i < 8; $i++)
+    {
+        $data = $cli->recv();
+        assert($data === str_repeat(chr(ord('a') + $i), $i == 7 ? 100 : 1200));
+    }
+    echo "SUCCESS\n";
+    swoole_process::kill($pid);
+};
+
+$pm->childFunc = function () use ($pm, $port)
+{
+    $serv = new swoole_server('127.0.0.1', $port, SWOOLE_PROCESS, SWOOLE_SOCK_UDP);
+    $serv->set([
+        'worker_num' => 1,
+        'udp_send_batch' => true,
+        'udp_gso' => true,
+        'open_udp_gro' => true,
+        'log_file' => '/dev/null',
+    ]);
+    $serv->on("WorkerStart", function (swoole_server $serv) use ($pm)
+    {
+        $pm->wakeup();
+    });
+    $serv->on('packet', function (swoole_server $serv, $data, $addr)
+    {
+        for ($i = 0; $i < intval($data); $i++)
+        {
+            $serv->sendto($addr['address'], $addr['port'], str_repeat(chr(ord('a') + $i), $i == 7 ? 100 : 1200));
+        }
+    });
+    $serv->start();
+};
+
+$pm->childFirst();
+$pm->run();
+?>
+--EXPECT--
+SUCCESS